@@ -0,0 +1,230 @@
+#include "BenchApp.h"
+#include "SshChannelIo.h"
+#include "CmdLine.h"
+#include "Blinker.h"
+#include <Arduino.h>
+#include <string.h>
+
+// Largest single ssh_channel_write; matches the libssh channel packet size.
+static const size_t BENCH_CHUNK = 2048;
+static const size_t BENCH_MAX_BYTES = 64UL * 1024UL * 1024UL;
+static const int BENCH_MAX_PINGS = 1000;
+static const int BENCH_IO_TIMEOUT_MS = 5000;
+static const unsigned long BENCH_MAX_PARSES = 200000; // ~1 s of busy CPU on the network task
+
+static uint8_t benchBuf[BENCH_CHUNK];
+
+static const char* orNone(const char* s){ return (s && *s) ? s : "none"; }
+
+struct BenchSample {
+    int64_t startUs;
+    uint32_t cpuStart;
+    uint64_t pktsOut, pktsIn, wireOut, wireIn;
+};
+
+static void sampleBegin(BenchSample& b, const SshSessionInfo& info){
+    b.pktsOut = info.socketCounter.out_packets;
+    b.pktsIn = info.socketCounter.in_packets;
+    b.wireOut = info.socketCounter.out_bytes;
+    b.wireIn = info.socketCounter.in_bytes;
+    b.cpuStart = SshServer::taskCpuUs();
+    b.startUs = esp_timer_get_time();
+}
+
+static void printResult(ssh_channel ch, const SshSessionInfo& info, const char* test,
+                        const BenchSample& b, size_t bytes, const char* extra){
+    int64_t elapsedUs = esp_timer_get_time() - b.startUs;
+    if (elapsedUs <= 0) elapsedUs = 1;
+    uint32_t cpuUs = SshServer::taskCpuUs() - b.cpuStart;
+    double mbps = (double)bytes / (double)elapsedUs; // bytes/us == MB/s
+    ssh_session s = info.session;
+    char msg[384];
+    snprintf(msg, sizeof(msg),
+             "RESULT test=%s bytes=%u us=%lld MBps=%.3f pkts_out=%llu pkts_in=%llu wire_out=%llu wire_in=%llu "
+             "cpu_us=%llu cipher_out=%s cipher_in=%s mac_out=%s mac_in=%s kex=%s%s%s",
+             test, (unsigned)bytes, (long long)elapsedUs, mbps,
+             (unsigned long long)(info.socketCounter.out_packets - b.pktsOut),
+             (unsigned long long)(info.socketCounter.in_packets - b.pktsIn),
+             (unsigned long long)(info.socketCounter.out_bytes - b.wireOut),
+             (unsigned long long)(info.socketCounter.in_bytes - b.wireIn),
+             (unsigned long long)cpuUs,
+             orNone(ssh_get_cipher_out(s)), orNone(ssh_get_cipher_in(s)),
+             orNone(ssh_get_hmac_out(s)), orNone(ssh_get_hmac_in(s)),
+             orNone(ssh_get_kex_algo(s)), extra ? " " : "", extra ? extra : "");
+    ssh_write_line(ch, msg);
+}
+
+static void benchInfo(ssh_channel ch, const SshSessionInfo& info){
+    // __DATE__ contains spaces; keep the value a single token for the scraper
+    char build[24];
+    snprintf(build, sizeof(build), "%s_%s", __DATE__, __TIME__);
+    for (char* p = build; *p; p++) if (*p == ' ') *p = '_';
+    char msg[320];
+    snprintf(msg, sizeof(msg),
+             "RESULT test=info chip=%s rev=%u cpu_mhz=%u sdk=%s build=%s handshake_us=%u setup_us=%u accept_us=%u "
+             "prewarmed=%d free_heap=%u compression=%s raw_out=%llu wire_out=%llu",
+             ESP.getChipModel(), (unsigned)ESP.getChipRevision(), (unsigned)ESP.getCpuFreqMHz(),
+             ESP.getSdkVersion(), build, (unsigned)info.handshakeUs, (unsigned)info.setupUs,
+             (unsigned)info.acceptUs, info.prewarmed ? 1 : 0,
+             (unsigned)ESP.getFreeHeap(), info.compressionOffered ? "zlib" : "none",
+             (unsigned long long)info.rawCounter.out_bytes,
+             (unsigned long long)info.socketCounter.out_bytes);
+    ssh_write_line(ch, msg);
+}
+
+// Device -> client: stream `total` bytes of printable filler (64-byte CRLF lines).
+static void benchDown(ssh_channel ch, const SshSessionInfo& info, size_t total){
+    for (size_t i = 0; i < BENCH_CHUNK; i++){
+        benchBuf[i] = (i % 64 == 62) ? '\r' : (i % 64 == 63) ? '\n' : (uint8_t)('a' + (i % 26));
+    }
+    BenchSample b; sampleBegin(b, info);
+    size_t sent = 0;
+    while (sent < total && ssh_channel_is_open(ch) && !ssh_channel_is_eof(ch)){
+        size_t n = total - sent;
+        if (n > BENCH_CHUNK) n = BENCH_CHUNK;
+        int w = ssh_channel_write(ch, benchBuf, n);
+        if (w <= 0) break;
+        sent += (size_t)w;
+    }
+    ssh_write_line(ch, "");
+    printResult(ch, info, "down", b, sent, sent == total ? nullptr : "status=aborted");
+}
+
+// Client -> device: announce READY, then swallow exactly `total` raw bytes.
+static void benchUp(ssh_channel ch, const SshSessionInfo& info, size_t total){
+    ssh_write_line(ch, "READY");
+    BenchSample b; sampleBegin(b, info);
+    size_t got = 0;
+    while (got < total){
+        size_t n = total - got;
+        if (n > BENCH_CHUNK) n = BENCH_CHUNK;
+        int r = ssh_channel_read_timeout(ch, benchBuf, n, 0, BENCH_IO_TIMEOUT_MS);
+        if (r <= 0) break;
+        got += (size_t)r;
+    }
+    printResult(ch, info, "up", b, got, got == total ? nullptr : "status=timeout");
+}
+
+// Ping-pong: send one 'p', wait for any single byte back, repeat.
+static void benchPing(ssh_channel ch, const SshSessionInfo& info, int count){
+    ssh_write_line(ch, "READY");
+    BenchSample b; sampleBegin(b, info);
+    uint32_t minUs = UINT32_MAX, maxUs = 0;
+    uint64_t sumUs = 0;
+    int done = 0;
+    for (; done < count; done++){
+        int64_t t0 = esp_timer_get_time();
+        if (ssh_channel_write(ch, "p", 1) != 1) break;
+        uint8_t c;
+        if (ssh_channel_read_timeout(ch, &c, 1, 0, BENCH_IO_TIMEOUT_MS) != 1) break;
+        uint32_t rtt = (uint32_t)(esp_timer_get_time() - t0);
+        if (rtt < minUs) minUs = rtt;
+        if (rtt > maxUs) maxUs = rtt;
+        sumUs += rtt;
+    }
+    char extra[96];
+    snprintf(extra, sizeof(extra), "pings=%d rtt_min_us=%u rtt_avg_us=%u rtt_max_us=%u",
+             done, done ? (unsigned)minUs : 0u, done ? (unsigned)(sumUs / done) : 0u, (unsigned)maxUs);
+    ssh_write_line(ch, "");
+    printResult(ch, info, "ping", b, (size_t)done, extra);
+}
+
+// Dump and reset the echo latency histogram.
+static void benchLatency(ssh_channel ch){
+    char out[640];
+    size_t len = sshEchoLatency.format(out, sizeof(out));
+    ssh_write_str(ch, "RESULT test=lat ");
+    ssh_write(ch, out, len);
+    sshEchoLatency.reset();
+}
+
+// Tokenize + option-parse a representative command line `count` times.
+static void benchParse(ssh_channel ch, unsigned long count){
+    static const char SAMPLE[] = "blink -f 2.5 --duty=25 --hz \"5\"";
+    char line[sizeof(SAMPLE)];
+    char* argv[CMD_MAX_ARGS];
+    char err[64];
+    unsigned long failures = 0;
+    int64_t t0 = esp_timer_get_time();
+    for (unsigned long i = 0; i < count; i++){
+        memcpy(line, SAMPLE, sizeof(SAMPLE));
+        int argc = cmdTokenize(line, argv, CMD_MAX_ARGS);
+        BlinkArgs args = { 0.0f, 50 };
+        if (argc != 6 || !blinkParseArgs(argc, argv, args, err, sizeof(err)) || args.hz != 5.0f || args.duty != 25) failures++;
+    }
+    int64_t us = esp_timer_get_time() - t0;
+    if (us <= 0) us = 1;
+    char msg[128];
+    snprintf(msg, sizeof(msg), "RESULT test=parse n=%lu us=%lld per_s=%.0f ns_each=%.0f unexpected=%lu",
+             count, (long long)us, count * 1e6 / (double)us, us * 1000.0 / (double)count, failures);
+    ssh_write_line(ch, msg);
+}
+
+// down/up/ping/parse take one count, up to a per-command limit.
+struct BenchCount {
+    unsigned long max;
+    unsigned long n;
+};
+
+static error_t benchCountOption(int key, char* arg, struct argp_state* state){
+    BenchCount* c = (BenchCount*)state->input;
+    switch (key){
+        case ARGP_KEY_ARG:
+            if (state->arg_num > 0) return ARGP_ERR_UNKNOWN;
+            return cmdArgUint(state, arg, 1, c->max, c->n);
+        case ARGP_KEY_END:
+            if (state->arg_num == 0) return cmdFail(state, "%s: needs a count, 1-%lu", state->name, c->max);
+            return 0;
+        default:
+            return ARGP_ERR_UNKNOWN;
+    }
+}
+
+static const struct argp_option BENCH_COUNT_OPTIONS[] = {
+    { 0, 0, 0, 0, 0, 0 },
+};
+
+static const struct argp BENCH_COUNT_ARGP = { BENCH_COUNT_OPTIONS, benchCountOption, "COUNT", nullptr, nullptr, nullptr, nullptr };
+
+void runBenchApp(ssh_channel ch, SshLineReader& reader, const SshSessionInfo& info){
+    ssh_write_line(ch, "Bench app. Commands:");
+    ssh_write_line(ch, "  info          chip, build and negotiated algorithms");
+    ssh_write_line(ch, "  lat           keystroke-to-echo histogram since last 'lat'");
+    ssh_write_line(ch, "  down <bytes>  device -> client transfer");
+    ssh_write_line(ch, "  up <bytes>    client -> device transfer (send after READY)");
+    ssh_write_line(ch, "  ping <count>  round trips: echo one byte per 'p' received");
+    ssh_write_line(ch, "  parse <count> command tokenizer + option parser throughput");
+    ssh_write_line(ch, "  q             return to menu");
+    ssh_write_str(ch, "> ");
+    while (ssh_channel_is_open(ch) && !ssh_channel_is_eof(ch)){
+        if (reader.poll(ch)){
+            char* argv[3] = {};
+            int argc = cmdTokenize(reader.lineBuf(), argv, 3);
+            const char* cmd = argc > 0 ? argv[0] : "";
+            if (!strcmp(cmd, "q")){
+                ssh_write_line(ch, "(leaving bench)");
+                return;
+            }
+            BenchCount count = { 0, 0 };
+            if (!strcmp(cmd, "down") || !strcmp(cmd, "up")) count.max = BENCH_MAX_BYTES;
+            else if (!strcmp(cmd, "ping")) count.max = BENCH_MAX_PINGS;
+            else if (!strcmp(cmd, "parse")) count.max = BENCH_MAX_PARSES;
+            char err[64];
+            if (argc == 1 && !strcmp(cmd, "info")){
+                benchInfo(ch, info);
+            } else if (argc == 1 && !strcmp(cmd, "lat")){
+                benchLatency(ch);
+            } else if (argc > 0 && count.max){
+                if (cmdParse(&BENCH_COUNT_ARGP, argc, argv, &count, err, sizeof(err))) ssh_write_line(ch, err);
+                else if (!strcmp(cmd, "down")) benchDown(ch, info, count.n);
+                else if (!strcmp(cmd, "up")) benchUp(ch, info, count.n);
+                else if (!strcmp(cmd, "ping")) benchPing(ch, info, (int)count.n);
+                else benchParse(ch, count.n);
+            } else if (argc != 0){
+                ssh_write_line(ch, "Usage: info | lat | down <bytes> | up <bytes> | ping <count> | parse <count> | q");
+            }
+            ssh_write_str(ch, "> ");
+        }
+        reader.wait(ch, 1000);
+    }
+}
@@ -0,0 +1,13 @@
+#ifndef BENCH_APP_H
+#define BENCH_APP_H
+
+#include <libssh/libssh.h>
+#include "SshServer.h"
+#include "SshChannelIo.h"
+
+// Throughput / latency benchmark run from the session menu.
+// Every measurement ends with a single "RESULT key=value ..." line so
+// tools/ssh_bench.py can scrape it.
+void runBenchApp(ssh_channel ch, SshLineReader& reader, const SshSessionInfo& info);
+
+#endif // BENCH_APP_H
@@ -0,0 +1,84 @@
+#include "Blinker.h"
+#include "CmdLine.h"
+#include <stdlib.h>
+
+Blinker ledBlinker;
+
+// One-shot re-armed from its own callback so on and off phases can differ.
+void Blinker::onTimer(void* arg){
+    Blinker* b = (Blinker*)arg;
+    b->on = !b->on;
+    digitalWrite(LED_BUILTIN, b->on ? HIGH : LOW);
+    esp_timer_start_once(b->timer, b->on ? b->onUs : b->offUs);
+}
+
+bool Blinker::start(float f, uint8_t d){
+    if (!timer){
+        esp_timer_create_args_t args = {};
+        args.callback = onTimer;
+        args.arg = this;
+        args.name = "blink";
+        if (esp_timer_create(&args, &timer) != ESP_OK){
+            timer = nullptr;
+            return false;
+        }
+        pinMode(LED_BUILTIN, OUTPUT);
+    }
+    if (f < BLINK_MIN_HZ) f = BLINK_MIN_HZ;
+    if (f > BLINK_MAX_HZ) f = BLINK_MAX_HZ;
+    if (d < 1) d = 1;
+    if (d > 99) d = 99;
+    if (running) esp_timer_stop(timer);
+    hz = f;
+    duty = d;
+    uint64_t periodUs = (uint64_t)(1000000.0f / f);
+    onUs = periodUs * d / 100;
+    offUs = periodUs - onUs;
+    running = esp_timer_start_once(timer, on ? onUs : offUs) == ESP_OK;
+    return running;
+}
+
+void Blinker::set(bool led){
+    if (running) esp_timer_stop(timer);
+    running = false;
+    hz = 0.0f;
+    pinMode(LED_BUILTIN, OUTPUT);
+    on = led;
+    digitalWrite(LED_BUILTIN, led ? HIGH : LOW);
+}
+
+static const struct argp_option BLINK_OPTIONS[] = {
+    { "hz", 'f', "HZ", 0, "blink frequency, 0.1-20", 0 },
+    { "duty", 'd', "PCT", 0, "percent of each period the LED is on, 1-99", 0 },
+    { 0, 0, 0, 0, 0, 0 },
+};
+
+static error_t blinkOption(int key, char* arg, struct argp_state* state){
+    BlinkArgs* a = (BlinkArgs*)state->input;
+    char* end = nullptr;
+    switch (key){
+        case 'f':
+        case ARGP_KEY_ARG: {
+            if (key == ARGP_KEY_ARG && state->arg_num > 0) return ARGP_ERR_UNKNOWN;
+            double hz = strtod(arg, &end);
+            if (end == arg || *end || hz < BLINK_MIN_HZ || hz > BLINK_MAX_HZ)
+                return cmdFail(state, "hz must be 0.1-20, got '%s'", arg);
+            a->hz = (float)hz;
+            return 0;
+        }
+        case 'd': {
+            long d = strtol(arg, &end, 10);
+            if (end == arg || *end || d < 1 || d > 99) return cmdFail(state, "duty must be 1-99, got '%s'", arg);
+            a->duty = (uint8_t)d;
+            return 0;
+        }
+        default:
+            return ARGP_ERR_UNKNOWN;
+    }
+}
+
+static const struct argp BLINK_ARGP = { BLINK_OPTIONS, blinkOption, "[HZ]", nullptr, nullptr, nullptr, nullptr };
+
+bool blinkParseArgs(int argc, char** argv, BlinkArgs& args, char* err, size_t errLen){
+    return cmdParse(&BLINK_ARGP, argc, argv, &args, err, errLen) == 0;
+}
@@ -0,0 +1,50 @@
+#ifndef BLINKER_H
+#define BLINKER_H
+
+#include <Arduino.h>
+#include <esp_timer.h>
+
+#ifndef LED_BUILTIN
+#define LED_BUILTIN 2
+#endif
+
+#define BLINK_MIN_HZ 0.1f
+#define BLINK_MAX_HZ 20.0f
+
+// Built-in LED driven from an esp_timer, so it keeps blinking without the
+// session loop waking up for every toggle. Shared by the menu's blink app
+// and the RPC led.* calls.
+class Blinker {
+public:
+    // Blink at `hz` (clamped to BLINK_MIN_HZ..BLINK_MAX_HZ), on for `duty`
+    // percent (1-99) of each period.
+    bool start(float hz, uint8_t duty = 50);
+    // Stop blinking and leave the LED at `on`.
+    void set(bool on);
+    bool blinking() const { return running; }
+    bool ledOn() const { return on; }
+    float frequency() const { return hz; }
+    uint8_t dutyPercent() const { return duty; }
+
+private:
+    esp_timer_handle_t timer = nullptr;
+    volatile bool on = false;
+    bool running = false;
+    float hz = 0.0f;
+    uint8_t duty = 50;
+    uint64_t onUs = 0, offUs = 0;
+    static void onTimer(void* arg);
+};
+
+extern Blinker ledBlinker;
+
+struct BlinkArgs {
+    float hz;
+    uint8_t duty;
+};
+
+// "[--hz HZ | HZ] [--duty PCT]" for the blink app and the script "blink"
+// command; fields not given keep their value in `args`.
+bool blinkParseArgs(int argc, char** argv, BlinkArgs& args, char* err, size_t errLen);
+
+#endif // BLINKER_H
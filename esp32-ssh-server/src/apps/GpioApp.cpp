@@ -0,0 +1,151 @@
+#include "GpioApp.h"
+#include "CmdLine.h"
+#include <Arduino.h>
+#include <esp32/rom/ets_sys.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void printLevels(ssh_channel ch, uint64_t in, uint64_t out){
+    char msg[200];
+    int len = snprintf(msg, sizeof(msg), "high:");
+    for (int p = 0; p < 40 && len < (int)sizeof(msg) - 4; p++){
+        if (in & (1ULL << p)) len += snprintf(msg + len, sizeof(msg) - len, " %d", p);
+    }
+    ssh_write_line(ch, msg);
+    snprintf(msg, sizeof(msg), "RESULT test=gpio in=0x%010llx out=0x%010llx",
+             (unsigned long long)in, (unsigned long long)out);
+    ssh_write_line(ch, msg);
+}
+
+// Step `pins` through `values`, one every `stepUs`; reports how late the
+// worst step landed. Whole ticks of each wait are slept so other tasks run;
+// only the sub-tick rest is spun.
+static void runSequence(ssh_channel ch, TimedGpioDriver& gpio, uint64_t pins, uint32_t stepUs,
+                        const uint64_t* values, int n){
+    const int64_t tickUs = portTICK_PERIOD_MS * 1000;
+    uint32_t maxLateUs = 0;
+    int64_t t0 = esp_timer_get_time();
+    for (int i = 0; i < n; i++){
+        int64_t due = t0 + (int64_t)i * stepUs;
+        int64_t left = due - esp_timer_get_time();
+        // vTaskDelay(k) returns after k tick interrupts, at most k ticks from now.
+        if (left >= tickUs) vTaskDelay((TickType_t)(left / tickUs));
+        left = due - esp_timer_get_time();
+        if (left > 0) ets_delay_us((uint32_t)left);
+        int64_t now = esp_timer_get_time();
+        gpio.write(pins & values[i], pins & ~values[i]);
+        if ((uint32_t)(now - due) > maxLateUs) maxLateUs = (uint32_t)(now - due);
+    }
+    char msg[96];
+    snprintf(msg, sizeof(msg), "RESULT test=gpio_seq steps=%d step_us=%u total_us=%u max_late_us=%u",
+             n, (unsigned)stepUs, (unsigned)(esp_timer_get_time() - t0), (unsigned)maxLateUs);
+    ssh_write_line(ch, msg);
+}
+
+static void printStats(ssh_channel ch, TimedGpioDriver& gpio){
+    static const char* const NAMES[TimedGpioDriver::OP_COUNT] = { "write", "read", "config" };
+    uint32_t mhz = ESP.getCpuFreqMHz();
+    for (int op = 0; op < TimedGpioDriver::OP_COUNT; op++){
+        const TimedGpioDriver::OpStats& s = gpio.stats((TimedGpioDriver::Op)op);
+        char msg[128];
+        snprintf(msg, sizeof(msg), "RESULT test=gpio_%s n=%u avg_ns=%u max_ns=%u last_ns=%u",
+                 NAMES[op], (unsigned)s.count,
+                 s.count ? (unsigned)(s.totalCycles * 1000 / s.count / mhz) : 0,
+                 (unsigned)(s.maxCycles * 1000ULL / mhz), (unsigned)(s.lastCycles * 1000ULL / mhz));
+        ssh_write_line(ch, msg);
+    }
+}
+
+// "in <pins> [--pull-up]"
+struct GpioInArgs {
+    uint64_t pins;
+    bool pullUp;
+};
+
+static const struct argp_option GPIO_IN_OPTIONS[] = {
+    { "pull-up", 'u', 0, 0, "enable the internal pull-up", 0 },
+    { 0, 0, 0, 0, 0, 0 },
+};
+
+static error_t gpioInOption(int key, char* arg, struct argp_state* state){
+    GpioInArgs* a = (GpioInArgs*)state->input;
+    switch (key){
+        case 'u':
+            a->pullUp = true;
+            return 0;
+        case ARGP_KEY_ARG:
+            if (state->arg_num > 0) return ARGP_ERR_UNKNOWN;
+            if (!gpioParsePins(arg, a->pins)) return cmdFail(state, "%s: bad pin set '%s'", state->name, arg);
+            return 0;
+        case ARGP_KEY_END:
+            if (state->arg_num == 0) return cmdFail(state, "%s: needs a pin set", state->name);
+            return 0;
+        default:
+            return ARGP_ERR_UNKNOWN;
+    }
+}
+
+static const struct argp GPIO_IN_ARGP = { GPIO_IN_OPTIONS, gpioInOption, "PINS", nullptr, nullptr, nullptr, nullptr };
+
+void runGpioApp(ssh_channel ch, SshLineReader& reader, TimedGpioDriver& gpio){
+    ssh_write_line(ch, "GPIO app. <pins> is a mask (0x30) or list (4,5,18-19). Commands:");
+    ssh_write_line(ch, "  out <pins>              configure as outputs");
+    ssh_write_line(ch, "  in <pins> [-u|--pull-up] configure as inputs, optional pull-up");
+    ssh_write_line(ch, "  set <pins> | clr <pins> drive high / low");
+    ssh_write_line(ch, "  write <pins> <value>    drive each pin to its bit in value, one batch");
+    ssh_write_line(ch, "  read                    snapshot of all pin levels");
+    ssh_write_line(ch, "  seq <pins> <us> <v>...  apply values one every <us> microseconds");
+    ssh_write_line(ch, "  stats                   driver operation timing");
+    ssh_write_line(ch, "  q                       back to menu");
+    ssh_write_str(ch, "> ");
+    while (ssh_channel_is_open(ch) && !ssh_channel_is_eof(ch)){
+        if (reader.poll(ch)){
+            char* argv[GPIO_SEQ_MAX_STEPS + 3] = {}; // "seq <pins> <us>" + values
+            int argc = cmdTokenize(reader.lineBuf(), argv, GPIO_SEQ_MAX_STEPS + 3);
+            const char* cmd = argc > 0 ? argv[0] : nullptr;
+            const char* arg1 = argc > 1 ? argv[1] : nullptr;
+            const char* arg2 = argc > 2 ? argv[2] : nullptr;
+            uint64_t pins = 0;
+            bool ok = true;
+            if (argc < 0){
+                ok = false;
+            } else if (!cmd){
+            } else if (!strcmp(cmd, "q")){
+                ssh_write_line(ch, "(leaving gpio)");
+                return;
+            } else if (!strcmp(cmd, "read")){
+                printLevels(ch, gpio.read(), gpio.outputs());
+            } else if (!strcmp(cmd, "stats")){
+                printStats(ch, gpio);
+            } else if (!strcmp(cmd, "in")){
+                GpioInArgs in = { 0, false };
+                char err[64];
+                if (cmdParse(&GPIO_IN_ARGP, argc, argv, &in, err, sizeof(err))) ssh_write_line(ch, err);
+                else if (!gpio.configureInputs(in.pins, in.pullUp)) ssh_write_line(ch, "Not an input-capable pin set.");
+            } else if (!gpioParsePins(arg1, pins)){
+                ok = false;
+            } else if (!strcmp(cmd, "out")){
+                if (!gpio.configureOutputs(pins)) ssh_write_line(ch, "Not an output-capable pin set.");
+            } else if (!strcmp(cmd, "set")){
+                gpio.write(pins, 0);
+            } else if (!strcmp(cmd, "clr")){
+                gpio.write(0, pins);
+            } else if (!strcmp(cmd, "write") && arg2){
+                uint64_t v = strtoull(arg2, nullptr, 0);
+                gpio.write(pins & v, pins & ~v);
+            } else if (!strcmp(cmd, "seq") && arg2){
+                uint32_t stepUs = strtoul(arg2, nullptr, 0);
+                uint64_t values[GPIO_SEQ_MAX_STEPS];
+                int n = 0;
+                for (int i = 3; i < argc && n < GPIO_SEQ_MAX_STEPS; i++) values[n++] = strtoull(argv[i], nullptr, 0);
+                if (n == 0 || (uint64_t)stepUs * (n - 1) > GPIO_SEQ_MAX_US) ok = false;
+                else runSequence(ch, gpio, pins, stepUs, values, n);
+            } else {
+                ok = false;
+            }
+            if (!ok) ssh_write_line(ch, "Usage: out|in|set|clr <pins> | write <pins> <value> | read | seq <pins> <us> <v>... | stats | q");
+            ssh_write_str(ch, "> ");
+        }
+        reader.wait(ch, 1000);
+    }
+}
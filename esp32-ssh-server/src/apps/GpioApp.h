@@ -0,0 +1,20 @@
+#ifndef GPIO_APP_H
+#define GPIO_APP_H
+
+#include <libssh/libssh.h>
+#include "SshChannelIo.h"
+#include "GpioDriver.h"
+
+#ifndef GPIO_SEQ_MAX_STEPS
+#define GPIO_SEQ_MAX_STEPS 32
+#endif
+#ifndef GPIO_SEQ_MAX_US
+#define GPIO_SEQ_MAX_US 200000   // a sequence holds its channel until done
+#endif
+
+// Multi-pin GPIO console: configure, drive and sample pin sets given as a
+// mask (0x30) or a list (4,5,18-19); every drive is one batched register
+// write through `gpio`.
+void runGpioApp(ssh_channel ch, SshLineReader& reader, TimedGpioDriver& gpio);
+
+#endif // GPIO_APP_H
@@ -0,0 +1,126 @@
+#include "HistoryApp.h"
+#include "MetricsHistory.h"
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <stdarg.h>
+#include <string.h>
+
+#if METRICS_HISTORY
+
+static char frame[2560];
+
+// Append to the frame buffer at pos, clamped at its end.
+static void put(size_t& pos, const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+static void put(size_t& pos, const char* fmt, ...){
+    if (pos >= sizeof(frame)) return;
+    va_list ap;
+    va_start(ap, fmt);
+    int w = vsnprintf(frame + pos, sizeof(frame) - pos, fmt, ap);
+    va_end(ap);
+    if (w > 0) pos += (size_t)w;
+    if (pos > sizeof(frame)) pos = sizeof(frame);
+}
+
+// U+2581..U+2588, lowest to full block.
+static const char* const BARS[8] = {
+    "\xe2\x96\x81", "\xe2\x96\x82", "\xe2\x96\x83", "\xe2\x96\x84",
+    "\xe2\x96\x85", "\xe2\x96\x86", "\xe2\x96\x87", "\xe2\x96\x88"
+};
+
+static size_t renderTier(MetricTier tier){
+    uint16_t n = MetricsHistory::count(tier);
+    uint16_t first = n > HISTORY_WIDTH ? n - HISTORY_WIDTH : 0;
+    uint32_t periodS = MetricsHistory::periodMs(tier) / 1000;
+    unsigned long up = MetricsHistory::newestS(tier);
+    size_t pos = 0;
+    put(pos, "%s: %u of %u points, one per %lu s, newest at up %lu:%02lu:%02lu\r\n",
+        MetricsHistory::tierName(tier), (unsigned)n, (unsigned)MetricsHistory::capacity(tier),
+        (unsigned long)periodS, up / 3600, (up / 60) % 60, up % 60);
+    for (uint8_t m = 0; m < METRIC_COUNT; m++){
+        MetricId id = (MetricId)m;
+        int32_t lo = METRIC_NONE, hi = METRIC_NONE, last = METRIC_NONE;
+        for (uint16_t i = first; i < n; i++){
+            int32_t v = MetricsHistory::get(tier, i, id);
+            if (v == METRIC_NONE) continue;
+            if (lo == METRIC_NONE || v < lo) lo = v;
+            if (hi == METRIC_NONE || v > hi) hi = v;
+            last = v;
+        }
+        put(pos, "%-12s ", MetricsHistory::name(id));
+        for (uint16_t i = first; i < n; i++){
+            int32_t v = MetricsHistory::get(tier, i, id);
+            if (v == METRIC_NONE){ put(pos, " "); continue; }
+            int level = hi > lo ? (int)((int64_t)(v - lo) * 7 / (hi - lo)) : 3;
+            put(pos, "%s", BARS[level]);
+        }
+        for (uint16_t i = n - first; i < HISTORY_WIDTH; i++) put(pos, " ");
+        if (last == METRIC_NONE) put(pos, "  no data\r\n");
+        else put(pos, "  %ld..%ld last %ld %s\r\n", (long)lo, (long)hi, (long)last, MetricsHistory::unit(id));
+    }
+    return pos < sizeof(frame) ? pos : sizeof(frame) - 1;
+}
+
+static void printStatus(ssh_channel ch){
+    MetricsHistory::Stats s = MetricsHistory::stats();
+    char msg[200];
+    snprintf(msg, sizeof(msg),
+             "RESULT test=history samples=%u period_ms=%u points=%u/%u/%u bytes=%u sample_us_avg=%u sample_us_max=%u",
+             (unsigned)s.samples, (unsigned)METRICS_SAMPLE_MS, (unsigned)MetricsHistory::count(TIER_SECONDS),
+             (unsigned)MetricsHistory::count(TIER_MINUTES), (unsigned)MetricsHistory::count(TIER_HOURS),
+             (unsigned)s.bytes, (unsigned)s.sampleUsAvg, (unsigned)s.sampleUsMax);
+    ssh_write_line(ch, msg);
+}
+
+void runHistoryApp(ssh_channel ch, SshLineReader& reader){
+    ssh_write_line(ch, "Metrics history. s | m | h: seconds / minutes / hours tier, Enter: redraw, status, q: back to menu");
+    MetricTier tier = TIER_SECONDS;
+    bool redraw = true;
+    while (ssh_channel_is_open(ch) && !ssh_channel_is_eof(ch)){
+        if (redraw){
+            int64_t t0 = esp_timer_get_time();
+            size_t len = renderTier(tier);
+            uint32_t renderUs = (uint32_t)(esp_timer_get_time() - t0);
+            ssh_write(ch, frame, len);
+            char msg[48];
+            snprintf(msg, sizeof(msg), "(rendered in %u us)", (unsigned)renderUs);
+            ssh_write_line(ch, msg);
+            ssh_write_str(ch, "> ");
+            redraw = false;
+        }
+        if (reader.poll(ch)){
+            const char* line = reader.line();
+            if (!strcmp(line, "q")){
+                ssh_write_line(ch, "(leaving history)");
+                return;
+            } else if (!strcmp(line, "")){
+                redraw = true;
+            } else if (!strcmp(line, "s")){
+                tier = TIER_SECONDS;
+                redraw = true;
+            } else if (!strcmp(line, "m")){
+                tier = TIER_MINUTES;
+                redraw = true;
+            } else if (!strcmp(line, "h")){
+                tier = TIER_HOURS;
+                redraw = true;
+            } else if (!strcmp(line, "status")){
+                printStatus(ch);
+                ssh_write_str(ch, "> ");
+            } else {
+                ssh_write_line(ch, "Usage: s | m | h | status | q");
+                ssh_write_str(ch, "> ");
+            }
+            continue;
+        }
+        reader.wait(ch, 1000);
+    }
+}
+
+#else
+
+void runHistoryApp(ssh_channel ch, SshLineReader& reader){
+    (void)reader;
+    ssh_write_line(ch, "Metrics history compiled out (METRICS_HISTORY=0).");
+}
+
+#endif // METRICS_HISTORY
@@ -0,0 +1,16 @@
+#ifndef HISTORY_APP_H
+#define HISTORY_APP_H
+
+#include <libssh/libssh.h>
+#include "SshChannelIo.h"
+
+// Sparklines shown per metric, newest on the right.
+#ifndef HISTORY_WIDTH
+#define HISTORY_WIDTH 60
+#endif
+
+// Sparklines of the metrics history (src/metrics/MetricsHistory), one tier
+// at a time, with each metric's range over the points shown.
+void runHistoryApp(ssh_channel ch, SshLineReader& reader);
+
+#endif // HISTORY_APP_H
@@ -0,0 +1,23 @@
+#include "LogsApp.h"
+#include "SshChannelIo.h"
+#include "Logger.h"
+#include <Arduino.h>
+#include <string.h>
+
+void runLogsApp(ssh_channel ch, SshLineReader& reader){
+    char line[LOG_LINE_MAX + 16];
+    snprintf(line, sizeof(line), "Log tail (%u written, %u dropped). 'q' then Enter to return.",
+             (unsigned)Logger::written(), (unsigned)Logger::dropped());
+    ssh_write_line(ch, line);
+    uint32_t cursor = 0;
+    while (ssh_channel_is_open(ch) && !ssh_channel_is_eof(ch)){
+        while (Logger::readHistory(cursor, line, sizeof(line))){
+            ssh_write_line(ch, line);
+        }
+        if (reader.poll(ch) && !strcmp(reader.line(), "q")){
+            ssh_write_line(ch, "(leaving logs)");
+            return;
+        }
+        reader.wait(ch, 50);
+    }
+}
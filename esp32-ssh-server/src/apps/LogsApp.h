@@ -0,0 +1,10 @@
+#ifndef LOGS_APP_H
+#define LOGS_APP_H
+
+#include <libssh/libssh.h>
+#include "SshChannelIo.h"
+
+// Replays the logger's recent lines, then follows new ones until 'q'.
+void runLogsApp(ssh_channel ch, SshLineReader& reader);
+
+#endif // LOGS_APP_H
@@ -0,0 +1,197 @@
+#include "RecorderApp.h"
+#include "SessionRecorder.h"
+#include "Tracer.h"
+#include "CmdLine.h"
+#include <Arduino.h>
+#include <stdlib.h>
+#include <string.h>
+
+static void printStatus(ssh_channel ch){
+    SessionRecorder::Stats s = SessionRecorder::stats();
+    uint32_t mhz = ESP.getCpuFreqMHz();
+    char msg[200];
+    snprintf(msg, sizeof(msg),
+             "RESULT test=recorder on=%d capacity=%u used=%u events=%u bytes=%u overwritten=%u ns_per_byte=%.1f",
+             SessionRecorder::enabled() ? 1 : 0, (unsigned)s.capacity, (unsigned)s.used, (unsigned)s.events,
+             (unsigned)s.bytes, (unsigned)s.overwritten,
+             s.bytes ? (double)s.cycles * 1000.0 / mhz / s.bytes : 0.0);
+    ssh_write_line(ch, msg);
+}
+
+// JSON string body for `n` bytes; returns bytes written to `out`
+// (needs up to 6 per input byte).
+static size_t jsonEscape(const uint8_t* in, size_t n, char* out){
+    static const char HEX[] = "0123456789abcdef";
+    size_t w = 0;
+    for (size_t i = 0; i < n; i++){
+        uint8_t c = in[i];
+        if (c == '"' || c == '\\'){
+            out[w++] = '\\';
+            out[w++] = (char)c;
+        } else if (c < 0x20 || c >= 0x7f){
+            memcpy(out + w, "\\u00", 4);
+            out[w + 4] = HEX[c >> 4];
+            out[w + 5] = HEX[c & 15];
+            w += 6;
+        } else {
+            out[w++] = (char)c;
+        }
+    }
+    return w;
+}
+
+static void dumpCast(ssh_channel ch){
+    static uint8_t chunk[96];
+    static char line[sizeof(chunk) * 6 + 48];
+    SessionRecorder::setPaused(ch, true);
+    ssh_write_line(ch, RECORDER_CAST_BEGIN);
+    ssh_write_line(ch, "{\"version\": 2, \"width\": 80, \"height\": 24}");
+    uint32_t cursor = 0;
+    SessionRecorder::Event ev;
+    bool first = true;
+    uint32_t t0 = 0;
+    while (SessionRecorder::next(cursor, ev) && ssh_channel_is_open(ch)){
+        if (first){ t0 = ev.ms; first = false; }
+        uint32_t rel = ev.ms - t0;
+        // Long events go out as several cast events with the same timestamp.
+        for (uint16_t off = 0; off < ev.len || (off == 0 && ev.len == 0); off += sizeof(chunk)){
+            uint16_t n = (size_t)(ev.len - off) < sizeof(chunk) ? ev.len - off : sizeof(chunk);
+            SessionRecorder::read(ev, off, chunk, n);
+            size_t w = snprintf(line, sizeof(line), "[%u.%03u, \"%c\", \"", (unsigned)(rel / 1000), (unsigned)(rel % 1000), ev.type);
+            w += jsonEscape(chunk, n, line + w);
+            memcpy(line + w, "\"]\r\n", 4);
+            ssh_write(ch, line, w + 4);
+            if (ev.len == 0) break;
+        }
+    }
+    ssh_write_line(ch, RECORDER_CAST_END);
+    SessionRecorder::setPaused(ch, false);
+}
+
+#if SSH_TRACE
+static void printTraceStatus(ssh_channel ch){
+    Tracer::Stats s = Tracer::stats();
+    char msg[160];
+    snprintf(msg, sizeof(msg), "RESULT test=trace on=%d capacity=%u recorded=%u overwritten=%u tasks=%u",
+             Tracer::isPaused() ? 0 : 1, (unsigned)SSH_TRACE_EVENTS, (unsigned)s.recorded,
+             (unsigned)s.overwritten, (unsigned)s.tasks);
+    ssh_write_line(ch, msg);
+}
+
+// Chrome trace JSON (object form), one event per line; timestamps are
+// microseconds from the oldest event still in the ring.
+static void dumpTrace(ssh_channel ch){
+    char line[160];
+    bool wasPaused = Tracer::isPaused();
+    Tracer::setPaused(true);
+    SessionRecorder::setPaused(ch, true);
+    ssh_write_line(ch, RECORDER_TRACE_BEGIN);
+    ssh_write_line(ch, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [");
+    Tracer::Stats st = Tracer::stats();
+    for (uint8_t t = 0; t <= st.tasks; t++){
+        uint8_t tid = t < st.tasks ? t : SSH_TRACE_TASKS;
+        snprintf(line, sizeof(line), "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %u, \"args\": {\"name\": \"%s\"}},",
+                 (unsigned)tid, Tracer::taskName(tid));
+        ssh_write_line(ch, line);
+    }
+    uint32_t cursor = 0;
+    Tracer::Event ev;
+    bool first = true;
+    uint32_t t0 = 0;
+    while (Tracer::next(cursor, ev) && ssh_channel_is_open(ch)){
+        if (first){ t0 = ev.us; first = false; }
+        int n = snprintf(line, sizeof(line), "{\"name\": \"%s\", \"ph\": \"%c\", \"ts\": %u, \"pid\": 1, \"tid\": %u",
+                         ev.name, ev.phase, (unsigned)(ev.us - t0), (unsigned)ev.task);
+        if (ev.phase == 'i' && n > 0 && n < (int)sizeof(line))
+            snprintf(line + n, sizeof(line) - n, ", \"s\": \"t\", \"args\": {\"v\": %u}},", (unsigned)ev.arg);
+        else if (n > 0 && n < (int)sizeof(line))
+            snprintf(line + n, sizeof(line) - n, "},");
+        ssh_write_line(ch, line);
+    }
+    // Closes the array after the trailing comma of the last event.
+    snprintf(line, sizeof(line), "{\"name\": \"dump\", \"ph\": \"i\", \"s\": \"g\", \"ts\": %u, \"pid\": 1, \"tid\": 0, \"args\": {\"overwritten\": %u}}]}",
+             first ? 0 : (unsigned)(micros() - t0), (unsigned)st.overwritten);
+    ssh_write_line(ch, line);
+    ssh_write_line(ch, RECORDER_TRACE_END);
+    SessionRecorder::setPaused(ch, false);
+    Tracer::setPaused(wasPaused);
+}
+#endif
+
+static void traceCommand(ssh_channel ch, int argc, char** argv){
+#if SSH_TRACE
+    const char* sub = argc > 1 ? argv[1] : "status";
+    if (!strcmp(sub, "dump")) dumpTrace(ch);
+    else if (!strcmp(sub, "on")) Tracer::setPaused(false);
+    else if (!strcmp(sub, "off")) Tracer::setPaused(true);
+    else if (!strcmp(sub, "clear")) Tracer::clear();
+    else if (strcmp(sub, "status")) ssh_write_line(ch, "Usage: trace [on | off | status | dump | clear]");
+    if (strcmp(sub, "dump")) printTraceStatus(ch);
+#else
+    (void)argc; (void)argv;
+    ssh_write_line(ch, "Tracing compiled out (SSH_TRACE=0).");
+#endif
+}
+
+// "on [bytes]": the ring size, from the smallest enable() takes to more
+// than the heap ever has in one block.
+static const unsigned long RECORD_MIN_BYTES = 1024;
+static const unsigned long RECORD_MAX_BYTES = 256UL * 1024UL;
+
+static error_t recordOnOption(int key, char* arg, struct argp_state* state){
+    unsigned long* bytes = (unsigned long*)state->input;
+    if (key != ARGP_KEY_ARG || state->arg_num > 0) return ARGP_ERR_UNKNOWN;
+    return cmdArgUint(state, arg, RECORD_MIN_BYTES, RECORD_MAX_BYTES, *bytes);
+}
+
+static const struct argp_option RECORD_ON_OPTIONS[] = {
+    { 0, 0, 0, 0, 0, 0 },
+};
+
+static const struct argp RECORD_ON_ARGP = { RECORD_ON_OPTIONS, recordOnOption, "[BYTES]", nullptr, nullptr, nullptr, nullptr };
+
+void runRecorderApp(ssh_channel ch, SshLineReader& reader){
+    ssh_write_line(ch, "Session recorder. Commands:");
+    ssh_write_line(ch, "  on [bytes] | off   start (allocating the ring) / stop and free it");
+    ssh_write_line(ch, "  status             ring usage and tee cost per byte");
+    ssh_write_line(ch, "  dump               replay the ring as an asciinema v2 cast");
+    ssh_write_line(ch, "  clear | q          drop recorded events / back to menu");
+    ssh_write_line(ch, "  trace [on|off|dump|clear]  timeline events, dumped as Chrome trace JSON");
+    printStatus(ch);
+    ssh_write_str(ch, "> ");
+    while (ssh_channel_is_open(ch) && !ssh_channel_is_eof(ch)){
+        if (reader.poll(ch)){
+            char* argv[3] = {};
+            int argc = cmdTokenize(reader.lineBuf(), argv, 3);
+            const char* cmd = argc > 0 ? argv[0] : "";
+            if (!strcmp(cmd, "q")){
+                ssh_write_line(ch, "(leaving recorder)");
+                return;
+            } else if (!strcmp(cmd, "on")){
+                unsigned long bytes = SSH_RECORD_BYTES;
+                char err[64];
+                if (cmdParse(&RECORD_ON_ARGP, argc, argv, &bytes, err, sizeof(err))) ssh_write_line(ch, err);
+                else if (SessionRecorder::enabled()) ssh_write_line(ch, "Already recording.");
+                else if (!SessionRecorder::enable(bytes)) ssh_write_line(ch, "Not enough heap for the ring.");
+                else SessionRecorder::marker("recording started");
+                printStatus(ch);
+            } else if (!strcmp(cmd, "off")){
+                SessionRecorder::disable();
+                printStatus(ch);
+            } else if (!strcmp(cmd, "status")){
+                printStatus(ch);
+            } else if (!strcmp(cmd, "dump")){
+                dumpCast(ch);
+            } else if (!strcmp(cmd, "clear")){
+                SessionRecorder::clear();
+                printStatus(ch);
+            } else if (!strcmp(cmd, "trace")){
+                traceCommand(ch, argc, argv);
+            } else if (argc != 0){
+                ssh_write_line(ch, "Usage: on [bytes] | off | status | dump | clear | trace ... | q");
+            }
+            ssh_write_str(ch, "> ");
+        }
+        reader.wait(ch, 1000);
+    }
+}
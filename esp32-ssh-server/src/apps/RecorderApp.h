@@ -0,0 +1,18 @@
+#ifndef RECORDER_APP_H
+#define RECORDER_APP_H
+
+#include <libssh/libssh.h>
+#include "SshChannelIo.h"
+
+#define RECORDER_CAST_BEGIN "--- BEGIN CAST ---"
+#define RECORDER_CAST_END "--- END CAST ---"
+#define RECORDER_TRACE_BEGIN "--- BEGIN TRACE ---"
+#define RECORDER_TRACE_END "--- END TRACE ---"
+
+// Switch session recording on/off, show its cost, and replay the ring as an
+// asciinema v2 cast between RECORDER_CAST_BEGIN/END lines (see
+// tools/ssh_rec_dump.py to save it to a file). "trace dump" does the same
+// for the timeline tracer in Chrome trace JSON (tools/ssh_trace_dump.py).
+void runRecorderApp(ssh_channel ch, SshLineReader& reader);
+
+#endif // RECORDER_APP_H
@@ -0,0 +1,148 @@
+#include "ScriptApp.h"
+#include "ScriptRunner.h"
+#include "CmdLine.h"
+#include <Arduino.h>
+#include <Preferences.h>
+#include <stdlib.h>
+#include <string.h>
+
+static char source[SCRIPT_MAX_SOURCE];
+static ScriptProgram program;
+static bool compiled = false;
+
+static void compileSource(ssh_channel ch){
+    char err[80];
+    compiled = program.compile(source, err, sizeof(err));
+    if (compiled){
+        char msg[48];
+        snprintf(msg, sizeof(msg), "Compiled %u instructions.", (unsigned)program.size());
+        ssh_write_line(ch, msg);
+    } else {
+        ssh_write_line(ch, err);
+    }
+}
+
+// Read script lines until a lone "."; false if the channel went away.
+static bool enterSource(ssh_channel ch, SshLineReader& reader){
+    size_t len = 0;
+    source[0] = '\0';
+    ssh_write_line(ch, "Enter script, '.' on its own line to finish.");
+    ssh_write_str(ch, "... ");
+    while (ssh_channel_is_open(ch) && !ssh_channel_is_eof(ch)){
+        if (reader.poll(ch)){
+            if (!strcmp(reader.line(), ".")) return true;
+            if (len + reader.length() + 2 > sizeof(source)){
+                ssh_write_line(ch, "Script too long; line dropped.");
+            } else {
+                memcpy(source + len, reader.line(), reader.length());
+                len += reader.length();
+                source[len++] = '\n';
+                source[len] = '\0';
+            }
+            ssh_write_str(ch, "... ");
+        }
+        reader.wait(ch, 1000);
+    }
+    return false;
+}
+
+static void showSource(ssh_channel ch){
+    const char* p = source;
+    while (*p){
+        const char* eol = strchr(p, '\n');
+        size_t n = eol ? (size_t)(eol - p) : strlen(p);
+        ssh_write(ch, p, n);
+        ssh_write(ch, "\r\n", 2);
+        p += n + (eol ? 1 : 0);
+    }
+}
+
+// "save|load|del <name>": one NVS key.
+static error_t scriptNameOption(int key, char* arg, struct argp_state* state){
+    const char** name = (const char**)state->input;
+    switch (key){
+        case ARGP_KEY_ARG:
+            if (state->arg_num > 0) return ARGP_ERR_UNKNOWN;
+            if (strlen(arg) >= 16) return cmdFail(state, "%s: names are at most 15 characters", state->name); // NVS key limit
+            *name = arg;
+            return 0;
+        case ARGP_KEY_END:
+            if (state->arg_num == 0) return cmdFail(state, "%s: needs a script name", state->name);
+            return 0;
+        default:
+            return ARGP_ERR_UNKNOWN;
+    }
+}
+
+static const struct argp_option SCRIPT_NAME_OPTIONS[] = {
+    { 0, 0, 0, 0, 0, 0 },
+};
+
+static const struct argp SCRIPT_NAME_ARGP = { SCRIPT_NAME_OPTIONS, scriptNameOption, "NAME", nullptr, nullptr, nullptr, nullptr };
+
+void runScriptApp(ssh_channel ch, SshLineReader& reader){
+    ssh_write_line(ch, "Script app. Commands:");
+    ssh_write_line(ch, "  new              type a script (led, blink, sleep, gpio, echo, repeat/end)");
+    ssh_write_line(ch, "  show | run       print / execute the current script ('stop' aborts a run)");
+    ssh_write_line(ch, "  save <name> | load <name> | del <name>   stored scripts (NVS)");
+    ssh_write_line(ch, "  q                back to menu");
+    ssh_write_str(ch, "> ");
+    Preferences prefs;
+    while (ssh_channel_is_open(ch) && !ssh_channel_is_eof(ch)){
+        if (reader.poll(ch)){
+            char* argv[3] = {};
+            int argc = cmdTokenize(reader.lineBuf(), argv, 3);
+            const char* cmd = argc > 0 ? argv[0] : nullptr;
+            bool takesName = cmd && (!strcmp(cmd, "save") || !strcmp(cmd, "load") || !strcmp(cmd, "del"));
+            const char* name = nullptr;
+            char err[64];
+            if (argc < 0){
+                ssh_write_line(ch, "Unbalanced quotes or too many words.");
+            } else if (argc == 0){
+            } else if (!strcmp(cmd, "q")){
+                ssh_write_line(ch, "(leaving script)");
+                return;
+            } else if (!strcmp(cmd, "new")){
+                if (!enterSource(ch, reader)) return;
+                compileSource(ch);
+            } else if (!strcmp(cmd, "show")){
+                showSource(ch);
+            } else if (!strcmp(cmd, "run")){
+                if (compiled) program.run(ch, reader);
+                else ssh_write_line(ch, "No compiled script.");
+            } else if (takesName && cmdParse(&SCRIPT_NAME_ARGP, argc, argv, &name, err, sizeof(err))){
+                ssh_write_line(ch, err);
+            } else if (!strcmp(cmd, "save")){
+                prefs.begin(SCRIPT_NVS_NAMESPACE, false);
+                bool ok = prefs.putString(name, source) > 0;
+                prefs.end();
+                ssh_write_line(ch, ok ? "Saved." : "Save failed.");
+            } else if (!strcmp(cmd, "load")){
+                // Read into a scratch buffer so a failed load keeps the current script.
+                char* loaded = (char*)malloc(sizeof(source));
+                size_t n = 0;
+                if (loaded){
+                    prefs.begin(SCRIPT_NVS_NAMESPACE, true);
+                    n = prefs.isKey(name) ? prefs.getString(name, loaded, sizeof(source)) : 0;
+                    prefs.end();
+                }
+                if (n){
+                    memcpy(source, loaded, sizeof(source));
+                    source[sizeof(source) - 1] = '\0';
+                    compileSource(ch);
+                } else {
+                    ssh_write_line(ch, loaded ? "No such script." : "Not enough memory.");
+                }
+                free(loaded);
+            } else if (!strcmp(cmd, "del")){
+                prefs.begin(SCRIPT_NVS_NAMESPACE, false);
+                ssh_write_line(ch, prefs.remove(name) ? "Deleted." : "No such script.");
+                prefs.end();
+            } else {
+                ssh_write_line(ch, "Usage: new | show | run | save <name> | load <name> | del <name> | q");
+            }
+            ssh_write_str(ch, "> ");
+        }
+        reader.wait(ch, 1000);
+    }
+}
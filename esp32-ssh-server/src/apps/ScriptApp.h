@@ -0,0 +1,13 @@
+#ifndef SCRIPT_APP_H
+#define SCRIPT_APP_H
+
+#include <libssh/libssh.h>
+#include "SshChannelIo.h"
+
+#define SCRIPT_NVS_NAMESPACE "scripts"
+
+// Enter, store and run ScriptRunner programs on the device; one upload, then
+// every step runs with on-device timing instead of a round trip per command.
+void runScriptApp(ssh_channel ch, SshLineReader& reader);
+
+#endif // SCRIPT_APP_H
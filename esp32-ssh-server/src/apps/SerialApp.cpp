@@ -0,0 +1,165 @@
+#include "SerialApp.h"
+#include "Logger.h"
+#include "MemoryBudget.h"
+#include <Arduino.h>
+#include <driver/uart.h>
+#include <esp_vfs_dev.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string.h>
+
+static const uart_port_t BRIDGE_PORT = (uart_port_t)SERIAL_BRIDGE_UART;
+
+struct SerialBridgeStats {
+    uint32_t rxBytes;       // UART -> SSH
+    uint32_t txBytes;       // SSH -> UART
+    uint32_t fifoOverflows; // hardware FIFO overran before the ISR drained it
+    uint32_t bufferFull;    // driver RX ring full; the ISR stops draining the FIFO
+    uint32_t lineErrors;    // framing / parity errors
+};
+
+// Sheds the large rings first when the heap is short: the bridge still
+// runs, with less slack. Returns the RX ring size in `rxBuf`.
+static bool bridgeOpen(uint32_t baud, QueueHandle_t* events, int& rxBuf){
+    uart_config_t cfg = {};
+    cfg.baud_rate = (int)baud;
+    cfg.data_bits = UART_DATA_8_BITS;
+    cfg.parity = UART_PARITY_DISABLE;
+    cfg.stop_bits = UART_STOP_BITS_1;
+    cfg.flow_ctrl = UART_HW_FLOWCTRL_DISABLE;
+    cfg.source_clk = UART_SCLK_APB;
+    bool roomy = MemoryBudget::canAfford(SERIAL_BRIDGE_RX_BUF + SERIAL_BRIDGE_TX_BUF);
+    if (!roomy) MemoryBudget::noteShed();
+    rxBuf = roomy ? SERIAL_BRIDGE_RX_BUF : SERIAL_BRIDGE_RX_BUF_LOW;
+    int txBuf = roomy ? SERIAL_BRIDGE_TX_BUF : SERIAL_BRIDGE_TX_BUF_LOW;
+    if (uart_driver_install(BRIDGE_PORT, rxBuf, txBuf, 16, events, 0) != ESP_OK) return false;
+    if (uart_param_config(BRIDGE_PORT, &cfg) != ESP_OK ||
+        uart_set_pin(BRIDGE_PORT, SERIAL_BRIDGE_TX_PIN, SERIAL_BRIDGE_RX_PIN, UART_PIN_NO_CHANGE, UART_PIN_NO_CHANGE) != ESP_OK){
+        uart_driver_delete(BRIDGE_PORT);
+        return false;
+    }
+    // Interrupt at half FIFO rather than near-full so ISR latency (flash
+    // writes, Wi-Fi) does not overrun the 128-byte FIFO at high baud rates.
+    uart_set_rx_full_threshold(BRIDGE_PORT, 64);
+    return true;
+}
+
+// select()-able view of the driver's RX ring, or -1 (the loop then polls).
+static int bridgeFd(){
+    char path[16];
+    snprintf(path, sizeof(path), "/dev/uart/%d", (int)BRIDGE_PORT);
+    esp_vfs_dev_uart_use_driver(BRIDGE_PORT);
+    return open(path, O_RDONLY | O_NONBLOCK);
+}
+
+static void drainEvents(QueueHandle_t events, SerialBridgeStats& st){
+    uart_event_t ev;
+    while (xQueueReceive(events, &ev, 0) == pdTRUE){
+        switch (ev.type){
+            case UART_FIFO_OVF: st.fifoOverflows++; break;
+            case UART_BUFFER_FULL: st.bufferFull++; break;
+            case UART_FRAME_ERR:
+            case UART_PARITY_ERR: st.lineErrors++; break;
+            default: break;
+        }
+    }
+}
+
+void runSerialApp(ssh_channel ch, SshLineReader& reader){
+    char msg[192];
+    snprintf(msg, sizeof(msg), "UART%d bridge (RX GPIO%d, TX GPIO%d). Baud rate [%u]: ",
+             SERIAL_BRIDGE_UART, SERIAL_BRIDGE_RX_PIN, SERIAL_BRIDGE_TX_PIN, (unsigned)SERIAL_BRIDGE_BAUD);
+    ssh_write_str(ch, msg);
+    while (!reader.poll(ch)){
+        if (!ssh_channel_is_open(ch) || ssh_channel_is_eof(ch)) return;
+        reader.wait(ch, 1000);
+    }
+    long baud = reader.line()[0] ? atol(reader.line()) : SERIAL_BRIDGE_BAUD;
+    if (baud < 300 || baud > 5000000){
+        ssh_write_line(ch, "Invalid baud rate.");
+        return;
+    }
+    QueueHandle_t events = nullptr;
+    int rxBuf = 0;
+    if (!bridgeOpen((uint32_t)baud, &events, rxBuf)){
+        ssh_write_line(ch, "UART driver unavailable.");
+        return;
+    }
+    int uartFd = bridgeFd();
+    snprintf(msg, sizeof(msg), "Connected at %ld baud. Ctrl-] to return.", baud);
+    ssh_write_line(ch, msg);
+    if (rxBuf < SERIAL_BRIDGE_RX_BUF){
+        snprintf(msg, sizeof(msg), "Heap low: UART buffers cut to %d/%d bytes, fast input may overrun.",
+                 rxBuf, SERIAL_BRIDGE_TX_BUF_LOW);
+        ssh_write_line(ch, msg);
+    }
+    LOGI("SERIAL", "Bridge open on UART%d at %ld baud, %d B RX ring", SERIAL_BRIDGE_UART, baud, rxBuf);
+
+    SerialBridgeStats st = {};
+    static uint8_t buf[1024];
+    unsigned long started = millis();
+    bool quit = false;
+
+    // Anything typed after the menu choice is already serial data.
+    size_t n = reader.takePending(buf, sizeof(buf));
+    const uint8_t* esc = (const uint8_t*)memchr(buf, SERIAL_BRIDGE_ESCAPE, n);
+    if (esc){ n = esc - buf; quit = true; }
+    // The TX ring is empty and holds at least sizeof(buf), so this write
+    // cannot block.
+    if (n){ uart_write_bytes(BRIDGE_PORT, (const char*)buf, n); st.txBytes += n; }
+
+    while (!quit && ssh_channel_is_open(ch) && !ssh_channel_is_eof(ch)){
+        bool idle = true;
+        drainEvents(events, st);
+
+        size_t avail = 0;
+        uart_get_buffered_data_len(BRIDGE_PORT, &avail);
+        if (avail){
+            int r = uart_read_bytes(BRIDGE_PORT, buf, avail < sizeof(buf) ? avail : sizeof(buf), 0);
+            if (r > 0){
+                ssh_write(ch, buf, r);
+                st.rxBytes += r;
+                idle = false;
+            }
+        }
+
+        // Take from the channel only what the TX ring has room for; the rest
+        // stays unread there, which back-pressures the SSH window instead of
+        // blocking this loop (and UART RX) in uart_write_bytes().
+        size_t room = 0;
+        uart_get_tx_buffer_free_size(BRIDGE_PORT, &room);
+        int r = room ? ssh_read_nonblocking(ch, buf, room < sizeof(buf) ? (int)room : (int)sizeof(buf)) : 0;
+        if (r < 0) break;
+        if (r > 0){
+            esc = (const uint8_t*)memchr(buf, SERIAL_BRIDGE_ESCAPE, r);
+            size_t len = esc ? (size_t)(esc - buf) : (size_t)r;
+            if (len) uart_write_bytes(BRIDGE_PORT, (const char*)buf, len);
+            st.txBytes += len;
+            quit = esc != nullptr;
+            idle = false;
+        }
+
+        if (idle){
+            // A full TX ring drains on its own; channel input is already
+            // waiting, so a channel wait would return at once.
+            if (!room) vTaskDelay(1);
+            else if (uartFd >= 0) ssh_channel_wait_fds(ch, 1000, &uartFd, 1);
+            else ssh_channel_wait(ch, 2);
+        }
+    }
+    drainEvents(events, st);
+    if (uartFd >= 0){
+        close(uartFd);
+        esp_vfs_dev_uart_use_nonblocking(BRIDGE_PORT);
+    }
+    uart_driver_delete(BRIDGE_PORT);
+
+    unsigned long ms = millis() - started;
+    snprintf(msg, sizeof(msg), "\r\nRESULT test=serial baud=%ld rx_bytes=%u tx_bytes=%u fifo_ovf=%u buf_full=%u line_err=%u ms=%lu",
+             baud, (unsigned)st.rxBytes, (unsigned)st.txBytes, (unsigned)st.fifoOverflows,
+             (unsigned)st.bufferFull, (unsigned)st.lineErrors, ms);
+    ssh_write_line(ch, msg);
+    LOGI("SERIAL", "Bridge closed: rx %u tx %u fifo_ovf %u buf_full %u line_err %u",
+         (unsigned)st.rxBytes, (unsigned)st.txBytes, (unsigned)st.fifoOverflows,
+         (unsigned)st.bufferFull, (unsigned)st.lineErrors);
+}
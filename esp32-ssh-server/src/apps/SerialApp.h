@@ -0,0 +1,46 @@
+#ifndef SERIAL_APP_H
+#define SERIAL_APP_H
+
+#include <libssh/libssh.h>
+#include "SshChannelIo.h"
+
+// UART used for the bridge and its pins (Serial2's defaults on esp32dev).
+#ifndef SERIAL_BRIDGE_UART
+#define SERIAL_BRIDGE_UART 2
+#endif
+#ifndef SERIAL_BRIDGE_RX_PIN
+#define SERIAL_BRIDGE_RX_PIN 16
+#endif
+#ifndef SERIAL_BRIDGE_TX_PIN
+#define SERIAL_BRIDGE_TX_PIN 17
+#endif
+#ifndef SERIAL_BRIDGE_BAUD
+#define SERIAL_BRIDGE_BAUD 921600
+#endif
+// Driver ring buffers, allocated only while the bridge runs. 16 KB of RX is
+// ~175 ms of slack at 921600 baud if the SSH side stalls.
+#ifndef SERIAL_BRIDGE_RX_BUF
+#define SERIAL_BRIDGE_RX_BUF 16384
+#endif
+#ifndef SERIAL_BRIDGE_TX_BUF
+#define SERIAL_BRIDGE_TX_BUF 8192
+#endif
+// Rings used instead when the heap cannot spare the large ones above the
+// memory budget's reserve. TX stays at least the 1 KB the bridge moves at
+// once.
+#ifndef SERIAL_BRIDGE_RX_BUF_LOW
+#define SERIAL_BRIDGE_RX_BUF_LOW 2048
+#endif
+#ifndef SERIAL_BRIDGE_TX_BUF_LOW
+#define SERIAL_BRIDGE_TX_BUF_LOW 1024
+#endif
+#ifndef SERIAL_BRIDGE_ESCAPE
+#define SERIAL_BRIDGE_ESCAPE 0x1d // Ctrl-]
+#endif
+
+// Raw byte bridge between the channel and a UART: no line discipline or
+// echo, Ctrl-] returns to the menu. Ends with a RESULT line of byte counts
+// and overrun/line-error counters.
+void runSerialApp(ssh_channel ch, SshLineReader& reader);
+
+#endif // SERIAL_APP_H
@@ -0,0 +1,114 @@
+#include "TopApp.h"
+#include <Arduino.h>
+#include <stdarg.h>
+#include <string.h>
+
+// Frames are large; keep them and the snapshots off the ssh task stack.
+static SystemSnapshot snapA, snapB;
+static char frame[2048];
+
+struct TopRow {
+    const TaskSample* task;
+    uint32_t permille; // share of all cores' time since the previous frame
+};
+
+// Append to the frame buffer at pos, clamped at its end.
+static void put(size_t& pos, const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+static void put(size_t& pos, const char* fmt, ...){
+    if (pos >= sizeof(frame)) return;
+    va_list ap;
+    va_start(ap, fmt);
+    int w = vsnprintf(frame + pos, sizeof(frame) - pos, fmt, ap);
+    va_end(ap);
+    if (w > 0) pos += (size_t)w;
+    if (pos > sizeof(frame)) pos = sizeof(frame);
+}
+
+static uint32_t runtimeDelta(const SystemSnapshot& prev, const TaskSample& t){
+    for (uint8_t i = 0; i < prev.nTasks; i++){
+        if (prev.tasks[i].id == t.id) return t.runtime - prev.tasks[i].runtime;
+    }
+    return t.runtime; // task started since the previous frame
+}
+
+// Render `cur` against `prev` into frame[]; returns the byte count.
+static size_t renderFrame(const SystemSnapshot& prev, const SystemSnapshot& cur,
+                          uint32_t refreshMs, uint32_t lastSampleUs, uint32_t lastRenderUs, size_t lastBytes){
+    TopRow rows[STATS_MAX_TASKS];
+    uint64_t capacity = (uint64_t)(cur.totalRuntime - prev.totalRuntime) * (cur.nCores ? cur.nCores : 1);
+    for (uint8_t i = 0; i < cur.nTasks; i++){
+        rows[i].task = &cur.tasks[i];
+        rows[i].permille = capacity ? (uint32_t)(runtimeDelta(prev, cur.tasks[i]) * 1000ULL / capacity) : 0;
+    }
+    // insertion sort, busiest first
+    for (uint8_t i = 1; i < cur.nTasks; i++){
+        TopRow r = rows[i];
+        int j = i - 1;
+        while (j >= 0 && rows[j].permille < r.permille){ rows[j + 1] = rows[j]; j--; }
+        rows[j + 1] = r;
+    }
+
+    size_t pos = 0;
+    unsigned long up = millis() / 1000;
+    // Cursor home; every line ends with erase-to-EOL so nothing flickers.
+    put(pos, "\x1b[H");
+    put(pos, "top - up %lu:%02lu:%02lu  tasks %u  refresh %u ms  ('q' Enter quits)\x1b[K\r\n",
+        up / 3600, (up / 60) % 60, up % 60, (unsigned)cur.nTasks, (unsigned)refreshMs);
+    put(pos, "heap free %u  min %u  largest %u\x1b[K\r\n",
+        (unsigned)cur.freeHeap, (unsigned)cur.minFreeHeap, (unsigned)cur.largestBlock);
+    put(pos, "\x1b[K\r\n%-16s %6s %4s %4s %2s %10s\x1b[K\r\n", "NAME", "CPU%", "PRIO", "CORE", "ST", "STACK_FREE");
+    for (uint8_t i = 0; i < cur.nTasks; i++){
+        const TaskSample& t = *rows[i].task;
+        char core[5];
+        if (t.core < 0) strcpy(core, "*"); else snprintf(core, sizeof(core), "%d", t.core);
+        put(pos, "%-16s %4u.%u %4u %4s %2c %10u\x1b[K\r\n", t.name,
+            (unsigned)(rows[i].permille / 10), (unsigned)(rows[i].permille % 10),
+            (unsigned)t.priority, core, t.state, (unsigned)t.stackFreeMin);
+    }
+    put(pos, "\x1b[K\r\nlast frame: sample %u us, render %u us, %u bytes\x1b[K\r\n\x1b[J",
+        (unsigned)lastSampleUs, (unsigned)lastRenderUs, (unsigned)lastBytes);
+    return pos < sizeof(frame) ? pos : sizeof(frame) - 1;
+}
+
+void runTopApp(ssh_channel ch, SshLineReader& reader, SystemStatsProvider& stats){
+    SystemSnapshot* prev = &snapA;
+    SystemSnapshot* cur = &snapB;
+    if (!stats.sample(*prev)){
+        ssh_write_line(ch, "top: too many tasks, raise STATS_MAX_TASKS");
+        return;
+    }
+    ssh_write_str(ch, "\x1b[2J");
+    uint32_t sampleUs = 0, renderUs = 0;
+    size_t bytes = 0;
+    unsigned long nextFrame = millis() + TOP_REFRESH_MS;
+    while (ssh_channel_is_open(ch) && !ssh_channel_is_eof(ch)){
+        if (reader.poll(ch) && !strcmp(reader.line(), "q")){
+            ssh_write_line(ch, "(leaving top)");
+            return;
+        }
+        long wait = (long)(nextFrame - millis());
+        if (wait > 0){
+            reader.wait(ch, (int)wait);
+            continue;
+        }
+        nextFrame += TOP_REFRESH_MS;
+        int64_t t0 = esp_timer_get_time();
+        if (!stats.sample(*cur)){
+            // Keep the last frame, say why it stopped updating and retry less often.
+            char row[96];
+            snprintf(row, sizeof(row), "\x1b[Htop: too many tasks, raise STATS_MAX_TASKS (%u); retry in %u s\x1b[K",
+                     (unsigned)STATS_MAX_TASKS, (unsigned)(TOP_RETRY_MS / 1000));
+            ssh_write_str(ch, row);
+            nextFrame = millis() + TOP_RETRY_MS;
+            continue;
+        }
+        int64_t t1 = esp_timer_get_time();
+        size_t len = renderFrame(*prev, *cur, TOP_REFRESH_MS, sampleUs, renderUs, bytes);
+        int64_t t2 = esp_timer_get_time();
+        ssh_write(ch, frame, len);
+        sampleUs = (uint32_t)(t1 - t0);
+        renderUs = (uint32_t)(t2 - t1);
+        bytes = len;
+        SystemSnapshot* t = prev; prev = cur; cur = t;
+    }
+}
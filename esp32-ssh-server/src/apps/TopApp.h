@@ -0,0 +1,20 @@
+#ifndef TOP_APP_H
+#define TOP_APP_H
+
+#include <libssh/libssh.h>
+#include "SshChannelIo.h"
+#include "SystemStats.h"
+
+#ifndef TOP_REFRESH_MS
+#define TOP_REFRESH_MS 1000
+#endif
+// Retry interval after a failed sample (more tasks than STATS_MAX_TASKS).
+#ifndef TOP_RETRY_MS
+#define TOP_RETRY_MS 5000
+#endif
+
+// Live per-task CPU share, stack headroom and heap view, redrawn in place
+// with one channel write per frame until 'q'.
+void runTopApp(ssh_channel ch, SshLineReader& reader, SystemStatsProvider& stats);
+
+#endif // TOP_APP_H
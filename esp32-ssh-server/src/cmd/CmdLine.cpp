@@ -0,0 +1,194 @@
+#include "CmdLine.h"
+#include <errno.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int cmdTokenize(char* line, char** argv, int maxArgs){
+    int argc = 0;
+    char* r = line;
+    char* w = line;
+    for (;;){
+        while (*r == ' ' || *r == '\t' || *r == '\r' || *r == '\n') r++;
+        if (!*r) break;
+        if (argc >= maxArgs) return CMD_ERR_TOO_MANY;
+        argv[argc++] = w;
+        // Copy one word down to `w`; w never passes r, so this is safe in place.
+        char quote = 0;
+        while (*r){
+            char c = *r;
+            if (quote == '\''){
+                r++;
+                if (c == '\'') quote = 0;
+                else *w++ = c;
+            } else if (c == '\\' && r[1] && (quote == 0 || r[1] == '"' || r[1] == '\\')){
+                *w++ = r[1];
+                r += 2;
+            } else if (quote == '"'){
+                r++;
+                if (c == '"') quote = 0;
+                else *w++ = c;
+            } else if (c == '\'' || c == '"'){
+                quote = c;
+                r++;
+            } else if (c == ' ' || c == '\t' || c == '\r' || c == '\n'){
+                break;
+            } else {
+                *w++ = c;
+                r++;
+            }
+        }
+        if (quote) return CMD_ERR_QUOTE;
+        // Terminate; when w == r this overwrites the separator we stopped on.
+        bool more = *r != '\0';
+        *w++ = '\0';
+        if (more) r++;
+        if (!more) break;
+    }
+    return argc;
+}
+
+struct CmdParseCtx {
+    char* err;
+    size_t errLen;
+};
+
+error_t cmdFail(struct argp_state* state, const char* fmt, ...){
+    CmdParseCtx* ctx = (CmdParseCtx*)state->pstate;
+    if (ctx && ctx->errLen){
+        va_list ap;
+        va_start(ap, fmt);
+        vsnprintf(ctx->err, ctx->errLen, fmt, ap);
+        va_end(ap);
+    }
+    return EINVAL;
+}
+
+error_t cmdArgUint(struct argp_state* state, const char* arg, unsigned long min, unsigned long max, unsigned long& out){
+    char* end = nullptr;
+    errno = 0;
+    unsigned long v = arg && *arg != '-' ? strtoul(arg, &end, 0) : 0;
+    if (!end || end == arg || *end || errno || v < min || v > max)
+        return cmdFail(state, "%s: expected %lu-%lu, got '%s'", state->name, min, max, arg ? arg : "");
+    out = v;
+    return 0;
+}
+
+static bool optionIsEnd(const struct argp_option* o){
+    return !o->key && !o->name && !o->doc && !o->group;
+}
+
+// The entry an option (or its OPTION_ALIAS) resolves to: key, arg and flags
+// come from the closest preceding non-alias entry.
+static const struct argp_option* findOption(const struct argp_option* opts, const char* name, size_t nameLen, int shortKey){
+    const struct argp_option* real = nullptr;
+    for (const struct argp_option* o = opts; o && !optionIsEnd(o); o++){
+        if (!(o->flags & OPTION_ALIAS)) real = o;
+        if (!real || (o->flags & OPTION_DOC)) continue;
+        if (shortKey && o->key == shortKey && shortKey < 128) return real;
+        if (name && o->name && strlen(o->name) == nameLen && !strncmp(o->name, name, nameLen)) return real;
+    }
+    return nullptr;
+}
+
+error_t cmdParse(const struct argp* argp, int argc, char** argv, void* input, char* err, size_t errLen){
+    CmdParseCtx ctx = { err, errLen };
+    if (errLen) err[0] = '\0';
+    struct argp_state state = {};
+    state.root_argp = argp;
+    state.argc = argc;
+    state.argv = argv;
+    state.next = 1;
+    state.flags = ARGP_SILENT;
+    state.input = input;
+    state.name = argc > 0 ? argv[0] : (char*)"";
+    state.pstate = &ctx;
+
+    auto call = [&](int key, char* arg) -> error_t {
+        error_t e = argp->parser(key, arg, &state);
+        if (e && e != ARGP_ERR_UNKNOWN && errLen && !err[0]) snprintf(err, errLen, "%s: invalid arguments", state.name);
+        return e;
+    };
+    error_t e = call(ARGP_KEY_INIT, nullptr);
+    if (e && e != ARGP_ERR_UNKNOWN) return e;
+
+    while (state.next < argc){
+        char* a = argv[state.next++];
+        bool option = !state.quoted && a[0] == '-' && a[1] && !(a[1] >= '0' && a[1] <= '9') && a[1] != '.';
+        if (option && !strcmp(a, "--")){
+            state.quoted = state.next;
+            continue;
+        }
+        if (!option){
+            e = call(ARGP_KEY_ARG, a);
+            if (e == ARGP_ERR_UNKNOWN) return cmdFail(&state, "%s: unexpected argument '%s'", state.name, a);
+            if (e) return e;
+            state.arg_num++;
+            continue;
+        }
+        if (a[1] == '-'){
+            const char* name = a + 2;
+            char* eq = strchr(a, '=');
+            size_t nameLen = eq ? (size_t)(eq - name) : strlen(name);
+            const struct argp_option* o = findOption(argp->options, name, nameLen, 0);
+            if (!o) return cmdFail(&state, "%s: unknown option '%s'", state.name, a);
+            char* value = eq ? eq + 1 : nullptr;
+            if (o->arg && !value && !(o->flags & OPTION_ARG_OPTIONAL)){
+                if (state.next >= argc) return cmdFail(&state, "%s: --%s needs %s", state.name, o->name, o->arg);
+                value = argv[state.next++];
+            } else if (!o->arg && value){
+                return cmdFail(&state, "%s: --%s takes no value", state.name, o->name);
+            }
+            e = call(o->key, value);
+        } else {
+            // Short options, possibly clustered: -ab, -f5, -f 5.
+            for (char* p = a + 1; *p; p++){
+                const struct argp_option* o = findOption(argp->options, nullptr, 0, (unsigned char)*p);
+                if (!o) return cmdFail(&state, "%s: unknown option '-%c'", state.name, *p);
+                if (!o->arg){
+                    e = call(o->key, nullptr);
+                    if (e) break;
+                    continue;
+                }
+                char* value = p[1] ? p + 1 : nullptr;
+                if (!value && !(o->flags & OPTION_ARG_OPTIONAL)){
+                    if (state.next >= argc) return cmdFail(&state, "%s: -%c needs %s", state.name, *p, o->arg);
+                    value = argv[state.next++];
+                }
+                e = call(o->key, value);
+                break;
+            }
+        }
+        if (e == ARGP_ERR_UNKNOWN) return cmdFail(&state, "%s: option '%s' not handled", state.name, a);
+        if (e) return e;
+    }
+    e = call(ARGP_KEY_END, nullptr);
+    return e == ARGP_ERR_UNKNOWN ? 0 : e;
+}
+
+// snprintf at out + pos, leaving pos on the terminating NUL.
+static void appendf(char* out, size_t len, size_t& pos, const char* fmt, ...) __attribute__((format(printf, 4, 5)));
+static void appendf(char* out, size_t len, size_t& pos, const char* fmt, ...){
+    if (pos >= len) return;
+    va_list ap;
+    va_start(ap, fmt);
+    int w = vsnprintf(out + pos, len - pos, fmt, ap);
+    va_end(ap);
+    if (w > 0) pos = pos + (size_t)w < len ? pos + (size_t)w : len - 1;
+}
+
+size_t cmdFormatHelp(const struct argp* argp, const char* cmd, char* out, size_t len){
+    size_t pos = 0;
+    appendf(out, len, pos, "Usage: %s [OPTION...]%s%s\r\n", cmd, argp->args_doc ? " " : "", argp->args_doc ? argp->args_doc : "");
+    for (const struct argp_option* o = argp->options; o && !optionIsEnd(o); o++){
+        if (o->flags & (OPTION_HIDDEN | OPTION_ALIAS)) continue;
+        char name[40];
+        int n = 0;
+        if (o->key > 0 && o->key < 128) n = snprintf(name, sizeof(name), "-%c%s", o->key, o->name ? ", " : "");
+        else n = snprintf(name, sizeof(name), "    ");
+        if (o->name) snprintf(name + n, sizeof(name) - n, "--%s%s%s", o->name, o->arg ? "=" : "", o->arg ? o->arg : "");
+        appendf(out, len, pos, "  %-22s %s\r\n", name, o->doc ? o->doc : "");
+    }
+    return pos;
+}
@@ -0,0 +1,38 @@
+#ifndef CMD_LINE_H
+#define CMD_LINE_H
+
+#include <stddef.h>
+#include "argp.h"
+
+#ifndef CMD_MAX_ARGS
+#define CMD_MAX_ARGS 16
+#endif
+
+#define CMD_ERR_QUOTE   (-1)   // unterminated quote
+#define CMD_ERR_TOO_MANY (-2)  // more than maxArgs words
+
+// Split `line` into words in place: whitespace separates, '...' is literal,
+// "..." and bare words take backslash escapes, adjacent pieces join
+// ("a"'b'c -> abc). argv[] points into `line`; nothing is allocated.
+// Returns the word count or a CMD_ERR_* code.
+int cmdTokenize(char* line, char** argv, int maxArgs);
+
+// argp_parse() for a tokenized command: argv[0] is the command name, options
+// (--name, --name=value, -k value, -kvalue, clustered -ab, "--" to stop) are
+// matched against argp->options and handed to argp->parser together with
+// ARGP_KEY_INIT / ARGP_KEY_ARG / ARGP_KEY_END, in one pass with no
+// allocation. A word like "-5" is a positional argument, not an option.
+// Returns 0, or an error with a message in `err`.
+error_t cmdParse(const struct argp* argp, int argc, char** argv, void* input, char* err, size_t errLen);
+
+// For parser callbacks: record a message for cmdParse() to return.
+error_t cmdFail(struct argp_state* state, const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+
+// For parser callbacks: `arg` as a number (decimal, or hex with 0x) in
+// [min, max], or a cmdFail() message saying what was expected.
+error_t cmdArgUint(struct argp_state* state, const char* arg, unsigned long min, unsigned long max, unsigned long& out);
+
+// "Usage: <cmd> [OPTION...] <args_doc>" followed by one line per option.
+size_t cmdFormatHelp(const struct argp* argp, const char* cmd, char* out, size_t len);
+
+#endif // CMD_LINE_H
@@ -0,0 +1,115 @@
+#include "GpioDriver.h"
+#include <driver/gpio.h>
+#include <soc/gpio_reg.h>
+#include <stdlib.h>
+#include <string.h>
+
+static Esp32GpioDriver esp32Gpio;
+TimedGpioDriver gpioDriver(esp32Gpio);
+
+static portMUX_TYPE gpioMux = portMUX_INITIALIZER_UNLOCKED;
+
+static bool configure(uint64_t mask, gpio_mode_t mode, bool pullUp){
+    if (!mask) return true;
+    gpio_config_t cfg = {};
+    cfg.pin_bit_mask = mask;
+    cfg.mode = mode;
+    cfg.pull_up_en = pullUp ? GPIO_PULLUP_ENABLE : GPIO_PULLUP_DISABLE;
+    cfg.pull_down_en = GPIO_PULLDOWN_DISABLE;
+    cfg.intr_type = GPIO_INTR_DISABLE;
+    return gpio_config(&cfg) == ESP_OK;
+}
+
+bool Esp32GpioDriver::configureOutputs(uint64_t mask){
+    if (mask & ~(uint64_t)GPIO_APP_OUTPUT_MASK) return false;
+    // Input stays enabled so read() reports what the pin is actually at.
+    return configure(mask, GPIO_MODE_INPUT_OUTPUT, false);
+}
+
+bool Esp32GpioDriver::configureInputs(uint64_t mask, bool pullUp){
+    if (mask & ~(uint64_t)GPIO_APP_INPUT_MASK) return false;
+    return configure(mask, GPIO_MODE_INPUT, pullUp);
+}
+
+void Esp32GpioDriver::write(uint64_t setMask, uint64_t clearMask){
+    setMask &= GPIO_APP_OUTPUT_MASK;
+    clearMask &= GPIO_APP_OUTPUT_MASK & ~setMask;
+    uint32_t set0 = (uint32_t)setMask, clr0 = (uint32_t)clearMask;
+    uint32_t set1 = (uint32_t)(setMask >> 32), clr1 = (uint32_t)(clearMask >> 32);
+    portENTER_CRITICAL(&gpioMux);
+    if (set0) REG_WRITE(GPIO_OUT_W1TS_REG, set0);
+    if (set1) REG_WRITE(GPIO_OUT1_W1TS_REG, set1);
+    if (clr0) REG_WRITE(GPIO_OUT_W1TC_REG, clr0);
+    if (clr1) REG_WRITE(GPIO_OUT1_W1TC_REG, clr1);
+    portEXIT_CRITICAL(&gpioMux);
+}
+
+uint64_t Esp32GpioDriver::read(){
+    return ((uint64_t)(REG_READ(GPIO_IN1_REG) & 0xFF) << 32) | REG_READ(GPIO_IN_REG);
+}
+
+uint64_t Esp32GpioDriver::outputs(){
+    return ((uint64_t)(REG_READ(GPIO_OUT1_REG) & 0xFF) << 32) | REG_READ(GPIO_OUT_REG);
+}
+
+void TimedGpioDriver::record(Op op, uint32_t cycles){
+    OpStats& s = ops[op];
+    s.count++;
+    s.lastCycles = cycles;
+    if (cycles > s.maxCycles) s.maxCycles = cycles;
+    s.totalCycles += cycles;
+}
+
+bool TimedGpioDriver::configureOutputs(uint64_t mask){
+    uint32_t t0 = ESP.getCycleCount();
+    bool ok = inner.configureOutputs(mask);
+    record(OP_CONFIG, ESP.getCycleCount() - t0);
+    return ok;
+}
+
+bool TimedGpioDriver::configureInputs(uint64_t mask, bool pullUp){
+    uint32_t t0 = ESP.getCycleCount();
+    bool ok = inner.configureInputs(mask, pullUp);
+    record(OP_CONFIG, ESP.getCycleCount() - t0);
+    return ok;
+}
+
+void TimedGpioDriver::write(uint64_t setMask, uint64_t clearMask){
+    uint32_t t0 = ESP.getCycleCount();
+    inner.write(setMask, clearMask);
+    record(OP_WRITE, ESP.getCycleCount() - t0);
+}
+
+uint64_t TimedGpioDriver::read(){
+    uint32_t t0 = ESP.getCycleCount();
+    uint64_t v = inner.read();
+    record(OP_READ, ESP.getCycleCount() - t0);
+    return v;
+}
+
+bool gpioParsePins(const char* s, uint64_t& mask){
+    mask = 0;
+    if (!s || !*s) return false;
+    if (!strchr(s, ',') && !strchr(s, '-') && !strncmp(s, "0x", 2)){
+        char* end = nullptr;
+        mask = strtoull(s, &end, 16);
+        return end && *end == '\0' && mask;
+    }
+    while (*s){
+        char* end = nullptr;
+        unsigned long lo = strtoul(s, &end, 10);
+        if (end == s) return false;
+        unsigned long hi = lo;
+        if (*end == '-'){
+            s = end + 1;
+            hi = strtoul(s, &end, 10);
+            if (end == s) return false;
+        }
+        if (lo > hi || hi > 39) return false;
+        for (unsigned long p = lo; p <= hi; p++) mask |= 1ULL << p;
+        if (*end == ',') end++;
+        else if (*end) return false;
+        s = end;
+    }
+    return mask != 0;
+}
@@ -0,0 +1,73 @@
+#ifndef GPIO_DRIVER_H
+#define GPIO_DRIVER_H
+
+#include <Arduino.h>
+
+// Pins the gpio app and RPC calls may touch: everything except the SPI flash
+// pins (6-11), the console UART (1, 3) and the serial bridge (16, 17).
+// GPIO34-39 are input-only.
+#ifndef GPIO_APP_OUTPUT_MASK
+#define GPIO_APP_OUTPUT_MASK 0x30EECF035ULL
+#endif
+#ifndef GPIO_APP_INPUT_MASK
+#define GPIO_APP_INPUT_MASK (GPIO_APP_OUTPUT_MASK | 0xFC00000000ULL)
+#endif
+
+// Multi-pin GPIO access: every call covers a 64-bit pin mask so a batch of
+// pins is configured, driven or sampled in one operation.
+class GpioDriver {
+public:
+    virtual ~GpioDriver() {}
+    virtual bool configureOutputs(uint64_t mask) = 0;
+    virtual bool configureInputs(uint64_t mask, bool pullUp) = 0;
+    // Drive `setMask` high and `clearMask` low together.
+    virtual void write(uint64_t setMask, uint64_t clearMask) = 0;
+    // Input levels of all pins.
+    virtual uint64_t read() = 0;
+    // Levels currently driven on output pins.
+    virtual uint64_t outputs() = 0;
+};
+
+// Register-level driver: write() is one W1TS and one W1TC store per bank
+// inside a critical section, both W1TS before either W1TC. Within a bank
+// all rising pins switch on the same cycle, all falling pins on one later
+// store; no pin falls before every rising pin has risen.
+class Esp32GpioDriver : public GpioDriver {
+public:
+    bool configureOutputs(uint64_t mask) override;
+    bool configureInputs(uint64_t mask, bool pullUp) override;
+    void write(uint64_t setMask, uint64_t clearMask) override;
+    uint64_t read() override;
+    uint64_t outputs() override;
+};
+
+// Wraps another driver and records per-operation CPU cycles, so the cost of
+// the batched path can be compared against per-pin digitalWrite().
+class TimedGpioDriver : public GpioDriver {
+public:
+    struct OpStats { uint32_t count; uint32_t lastCycles; uint32_t maxCycles; uint64_t totalCycles; };
+    enum Op { OP_WRITE, OP_READ, OP_CONFIG, OP_COUNT };
+
+    explicit TimedGpioDriver(GpioDriver& inner) : inner(inner) {}
+    bool configureOutputs(uint64_t mask) override;
+    bool configureInputs(uint64_t mask, bool pullUp) override;
+    void write(uint64_t setMask, uint64_t clearMask) override;
+    uint64_t read() override;
+    uint64_t outputs() override { return inner.outputs(); }
+
+    const OpStats& stats(Op op) const { return ops[op]; }
+    void reset() { memset(ops, 0, sizeof(ops)); }
+
+private:
+    GpioDriver& inner;
+    OpStats ops[OP_COUNT] = {};
+    void record(Op op, uint32_t cycles);
+};
+
+// Pin set as a hex mask ("0x30") or a list with ranges ("4,5,18-19").
+bool gpioParsePins(const char* s, uint64_t& mask);
+
+// Shared instance used by the gpio app and the RPC gpio_* calls.
+extern TimedGpioDriver gpioDriver;
+
+#endif // GPIO_DRIVER_H
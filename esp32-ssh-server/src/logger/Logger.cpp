@@ -0,0 +1,272 @@
+#include "Logger.h"
+#include <atomic>
+#include <string.h>
+
+namespace {
+
+struct LogSlot {
+    std::atomic<uint32_t> seq;
+    uint32_t timeMs;
+    const char* tag;
+    const char* fmt;
+    LogLevel level;
+    uint8_t nargs;
+    uint64_t args[LOG_MAX_ARGS];
+    char strs[LOG_STR_BYTES];
+};
+
+static_assert((LOG_RING_SLOTS & (LOG_RING_SLOTS - 1)) == 0, "LOG_RING_SLOTS must be a power of two");
+
+LogSlot ring[LOG_RING_SLOTS];
+std::atomic<uint32_t> enqueuePos{0};
+uint32_t dequeuePos = 0;                 // drain task only
+std::atomic<uint32_t> nWritten{0};
+std::atomic<uint32_t> nDropped{0};
+bool ringReady = false;
+TaskHandle_t drainHandle = nullptr;
+
+char history[LOG_HISTORY_LINES][LOG_LINE_MAX];
+uint32_t historySeq = 0;
+portMUX_TYPE historyMux = portMUX_INITIALIZER_UNLOCKED;
+
+const char LEVEL_CHARS[] = { 'E', 'W', 'I', 'D' };
+
+void initRing() {
+    for (uint32_t i = 0; i < LOG_RING_SLOTS; i++) ring[i].seq.store(i, std::memory_order_relaxed);
+    ringReady = true;
+}
+
+// One printf conversion: where it starts/ends in the format and how its
+// argument was passed.
+enum ArgKind : uint8_t { ARG_NONE, ARG_INT, ARG_LONG, ARG_LLONG, ARG_SIZE, ARG_DOUBLE, ARG_PTR, ARG_STR };
+
+struct Spec {
+    const char* start;   // the '%'
+    const char* end;     // one past the conversion char
+    uint8_t stars;       // '*' width/precision arguments preceding the value
+    ArgKind kind;
+};
+
+// Parse the conversion at p (pointing at '%'). Returns false at end of string.
+bool parseSpec(const char* p, Spec& s) {
+    s.start = p++;
+    s.stars = 0;
+    s.kind = ARG_NONE;
+    if (*p == '%') { s.end = p + 1; return true; }
+    while (*p && strchr("-+ #0", *p)) p++;
+    if (*p == '*') { s.stars++; p++; } else while (*p >= '0' && *p <= '9') p++;
+    if (*p == '.') {
+        p++;
+        if (*p == '*') { s.stars++; p++; } else while (*p >= '0' && *p <= '9') p++;
+    }
+    int longs = 0; bool isSize = false;
+    while (*p && strchr("hlLzjt", *p)) {
+        if (*p == 'l') longs++;
+        if (*p == 'z' || *p == 'j' || *p == 't') isSize = true;
+        p++;
+    }
+    if (!*p) return false;
+    switch (*p) {
+        case 'd': case 'i': case 'u': case 'x': case 'X': case 'o': case 'c':
+            s.kind = longs >= 2 ? ARG_LLONG : longs == 1 ? ARG_LONG : isSize ? ARG_SIZE : ARG_INT;
+            break;
+        case 'f': case 'F': case 'e': case 'E': case 'g': case 'G': case 'a': case 'A':
+            s.kind = ARG_DOUBLE; break;
+        case 'p': s.kind = ARG_PTR; break;
+        case 's': s.kind = ARG_STR; break;
+        default:  s.kind = ARG_INT; break;
+    }
+    s.end = p + 1;
+    return true;
+}
+
+// Pull every argument out of `ap` by the type its conversion implies.
+// Strings are copied into the slot; their arg word holds the offset.
+void captureArgs(LogSlot& slot, va_list ap) {
+    size_t strUsed = 0;
+    uint8_t n = 0;
+    slot.strs[sizeof(slot.strs) - 1] = '\0';
+    for (const char* p = strchr(slot.fmt, '%'); p; p = strchr(p, '%')) {
+        Spec s;
+        if (!parseSpec(p, s)) break;
+        p = s.end;
+        for (uint8_t i = 0; i < s.stars; i++) {
+            int w = va_arg(ap, int);
+            if (n < LOG_MAX_ARGS) slot.args[n++] = (uint64_t)(int64_t)w;
+        }
+        uint64_t v = 0;
+        switch (s.kind) {
+            case ARG_NONE: continue;
+            case ARG_INT:   v = va_arg(ap, unsigned int); break;
+            case ARG_LONG:  v = va_arg(ap, unsigned long); break;
+            case ARG_LLONG: v = va_arg(ap, unsigned long long); break;
+            case ARG_SIZE:  v = va_arg(ap, size_t); break;
+            case ARG_PTR:   v = (uintptr_t)va_arg(ap, void*); break;
+            case ARG_DOUBLE: { double d = va_arg(ap, double); memcpy(&v, &d, sizeof(d)); break; }
+            case ARG_STR: {
+                const char* str = va_arg(ap, const char*);
+                if (!str) str = "(null)";
+                size_t room = sizeof(slot.strs) - strUsed;
+                size_t len = room ? strnlen(str, room - 1) : 0;
+                if (room) {
+                    memcpy(slot.strs + strUsed, str, len);
+                    slot.strs[strUsed + len] = '\0';
+                }
+                v = room ? strUsed : sizeof(slot.strs) - 1; // last byte is always '\0'
+                strUsed += room ? len + 1 : 0;
+                break;
+            }
+        }
+        if (n < LOG_MAX_ARGS) slot.args[n++] = v;
+    }
+    slot.nargs = n;
+}
+
+// Deferred half of printf: expand one conversion at a time from the stored words.
+size_t formatSlot(const LogSlot& slot, char* out, size_t outLen) {
+    int len = snprintf(out, outLen, "%lu.%03lu %c [%s] ",
+                       (unsigned long)(slot.timeMs / 1000), (unsigned long)(slot.timeMs % 1000),
+                       LEVEL_CHARS[slot.level & 3], slot.tag);
+    size_t pos = len > 0 ? (size_t)len : 0;
+    uint8_t ai = 0;
+    const char* p = slot.fmt;
+    while (*p && pos + 1 < outLen) {
+        if (*p != '%') { out[pos++] = *p++; continue; }
+        Spec s;
+        if (!parseSpec(p, s)) break;
+        p = s.end;
+        if (s.kind == ARG_NONE) { out[pos++] = '%'; continue; }
+        char spec[16];
+        size_t specLen = (size_t)(s.end - s.start);
+        if (specLen >= sizeof(spec) || ai + s.stars >= slot.nargs) {
+            out[pos++] = '?';
+            ai += s.stars + 1;
+            continue;
+        }
+        memcpy(spec, s.start, specLen);
+        spec[specLen] = '\0';
+        int w1 = s.stars > 0 ? (int)slot.args[ai] : 0;
+        int w2 = s.stars > 1 ? (int)slot.args[ai + 1] : 0;
+        ai += s.stars;
+        uint64_t v = slot.args[ai++];
+        char* dst = out + pos;
+        size_t room = outLen - pos;
+        int w = 0;
+#define LOG_EMIT(val) \
+        (s.stars == 0 ? snprintf(dst, room, spec, val) : \
+         s.stars == 1 ? snprintf(dst, room, spec, w1, val) : snprintf(dst, room, spec, w1, w2, val))
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+#pragma GCC diagnostic ignored "-Wformat-security"
+        switch (s.kind) {
+            case ARG_INT:   w = LOG_EMIT((unsigned int)v); break;
+            case ARG_LONG:  w = LOG_EMIT((unsigned long)v); break;
+            case ARG_LLONG: w = LOG_EMIT((unsigned long long)v); break;
+            case ARG_SIZE:  w = LOG_EMIT((size_t)v); break;
+            case ARG_PTR:   w = LOG_EMIT((void*)(uintptr_t)v); break;
+            case ARG_DOUBLE: { double d; memcpy(&d, &v, sizeof(d)); w = LOG_EMIT(d); break; }
+            case ARG_STR:   w = LOG_EMIT(slot.strs + (v < sizeof(slot.strs) ? v : sizeof(slot.strs) - 1)); break;
+            default: break;
+        }
+#pragma GCC diagnostic pop
+#undef LOG_EMIT
+        if (w > 0) pos += (size_t)w < room ? (size_t)w : room - 1;
+    }
+    // drop trailing newlines from Serial.println-era messages; we add our own
+    while (pos > 0 && (out[pos - 1] == '\n' || out[pos - 1] == '\r')) pos--;
+    out[pos] = '\0';
+    return pos;
+}
+
+void emitLine(const char* line, size_t len) {
+    Serial.write((const uint8_t*)line, len);
+    Serial.write((const uint8_t*)"\r\n", 2);
+    portENTER_CRITICAL(&historyMux);
+    char* dst = history[historySeq % LOG_HISTORY_LINES];
+    memcpy(dst, line, len + 1);
+    historySeq++;
+    portEXIT_CRITICAL(&historyMux);
+}
+
+} // namespace
+
+volatile LogLevel Logger::minLevel = LOG_DEFAULT_LEVEL;
+
+void Logger::begin(UBaseType_t priority, BaseType_t core) {
+    if (!ringReady) initRing();
+    if (!drainHandle) {
+        xTaskCreatePinnedToCore(drainTask, "log", 3072, nullptr, priority, &drainHandle, core);
+    }
+}
+
+void Logger::write(LogLevel level, const char* tag, const char* fmt, ...) {
+    if (level > minLevel) return;
+    if (!ringReady) initRing();
+    // Vyukov bounded queue: claim a slot whose sequence equals our position.
+    uint32_t pos = enqueuePos.load(std::memory_order_relaxed);
+    LogSlot* slot;
+    for (;;) {
+        slot = &ring[pos & (LOG_RING_SLOTS - 1)];
+        uint32_t seq = slot->seq.load(std::memory_order_acquire);
+        int32_t diff = (int32_t)(seq - pos);
+        if (diff == 0) {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) break;
+        } else if (diff < 0) {
+            nDropped.fetch_add(1, std::memory_order_relaxed);
+            return;
+        } else {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+    slot->timeMs = millis();
+    slot->tag = tag;
+    slot->fmt = fmt;
+    slot->level = level;
+    va_list ap;
+    va_start(ap, fmt);
+    captureArgs(*slot, ap);
+    va_end(ap);
+    slot->seq.store(pos + 1, std::memory_order_release);
+    nWritten.fetch_add(1, std::memory_order_relaxed);
+    if (drainHandle) xTaskNotifyGive(drainHandle);
+}
+
+uint32_t Logger::written() { return nWritten.load(std::memory_order_relaxed); }
+uint32_t Logger::dropped() { return nDropped.load(std::memory_order_relaxed); }
+
+bool Logger::readHistory(uint32_t& cursor, char* out, size_t outLen) {
+    bool ok = false;
+    portENTER_CRITICAL(&historyMux);
+    if (historySeq - cursor > LOG_HISTORY_LINES) cursor = historySeq - LOG_HISTORY_LINES;
+    if (cursor != historySeq && outLen > 0) {
+        strncpy(out, history[cursor % LOG_HISTORY_LINES], outLen - 1);
+        out[outLen - 1] = '\0';
+        cursor++;
+        ok = true;
+    }
+    portEXIT_CRITICAL(&historyMux);
+    return ok;
+}
+
+void Logger::drainTask(void*) {
+    char line[LOG_LINE_MAX];
+    uint32_t reportedDrops = 0;
+    for (;;) {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        for (;;) {
+            LogSlot& slot = ring[dequeuePos & (LOG_RING_SLOTS - 1)];
+            if (slot.seq.load(std::memory_order_acquire) != dequeuePos + 1) break;
+            size_t len = formatSlot(slot, line, sizeof(line));
+            slot.seq.store(dequeuePos + LOG_RING_SLOTS, std::memory_order_release);
+            dequeuePos++;
+            emitLine(line, len);
+        }
+        uint32_t drops = dropped();
+        if (drops != reportedDrops) {
+            int len = snprintf(line, sizeof(line), "%lu.%03lu W [LOG] %u messages dropped",
+                               millis() / 1000, millis() % 1000, (unsigned)(drops - reportedDrops));
+            reportedDrops = drops;
+            emitLine(line, (size_t)len);
+        }
+    }
+}
@@ -0,0 +1,70 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <Arduino.h>
+#include <stdint.h>
+
+// Ring sizing; each slot is ~140 bytes.
+#ifndef LOG_RING_SLOTS
+#define LOG_RING_SLOTS 32          // must be a power of two
+#endif
+#ifndef LOG_MAX_ARGS
+#define LOG_MAX_ARGS 6
+#endif
+#ifndef LOG_STR_BYTES
+#define LOG_STR_BYTES 64           // room for copied %s arguments per message
+#endif
+#ifndef LOG_HISTORY_LINES
+#define LOG_HISTORY_LINES 16       // formatted lines kept for the "logs" app
+#endif
+#ifndef LOG_LINE_MAX
+#define LOG_LINE_MAX 128
+#endif
+#ifndef LOG_DEFAULT_LEVEL
+#define LOG_DEFAULT_LEVEL LOG_INFO
+#endif
+
+enum LogLevel : uint8_t { LOG_ERROR = 0, LOG_WARN, LOG_INFO, LOG_DEBUG };
+
+// Asynchronous logger. write() only captures the format pointer and the raw
+// argument words (copying %s strings) into a lock-free multi-producer ring;
+// a low-priority drain task formats and prints to the UART. When the ring is
+// full the message is dropped and counted, never blocking the caller.
+//
+// `fmt` and `tag` must be string literals (or otherwise outlive the drain).
+class Logger {
+public:
+    static void begin(UBaseType_t priority = 1, BaseType_t core = 0);
+    static void write(LogLevel level, const char* tag, const char* fmt, ...)
+        __attribute__((format(printf, 3, 4)));
+
+    static void setLevel(LogLevel level) { minLevel = level; }
+    static uint32_t written();
+    static uint32_t dropped();
+
+    // Copy the next drained line after `cursor` into `out`; advances cursor.
+    // Returns false when nothing newer is available.
+    static bool readHistory(uint32_t& cursor, char* out, size_t outLen);
+
+private:
+    static void drainTask(void* param);
+    static volatile LogLevel minLevel;
+};
+
+// Arguments after the format, up to 16; '*' widths count as arguments too.
+#define LOG_NARGS(...) LOG_NARGS_(0, ##__VA_ARGS__, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0)
+#define LOG_NARGS_(_0, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, n, ...) n
+
+// A message with more arguments than a slot holds would print '?' for the
+// rest, so it fails to build instead; split it into two messages.
+#define LOG_WRITE(level, tag, fmt, ...) do { \
+        static_assert(LOG_NARGS(__VA_ARGS__) <= LOG_MAX_ARGS, "log message has more than LOG_MAX_ARGS arguments"); \
+        Logger::write(level, tag, fmt, ##__VA_ARGS__); \
+    } while (0)
+
+#define LOGE(tag, fmt, ...) LOG_WRITE(LOG_ERROR, tag, fmt, ##__VA_ARGS__)
+#define LOGW(tag, fmt, ...) LOG_WRITE(LOG_WARN, tag, fmt, ##__VA_ARGS__)
+#define LOGI(tag, fmt, ...) LOG_WRITE(LOG_INFO, tag, fmt, ##__VA_ARGS__)
+#define LOGD(tag, fmt, ...) LOG_WRITE(LOG_DEBUG, tag, fmt, ##__VA_ARGS__)
+
+#endif // LOGGER_H
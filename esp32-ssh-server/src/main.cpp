@@ -1,5 +1,11 @@
-#include "wifi_manager/WifiManager.h"
+#include "wifi_manager/ArduinoWifiDriver.h"
 #include "ssh_server/SshServer.h"
+#include "logger/Logger.h"
+#include "reactor/Reactor.h"
+#include "metrics/AllocTracker.h"
+#include "metrics/MetricsHistory.h"
+#include "power/PowerManager.h"
+#include "trace/Tracer.h"
 
 // Set local WiFi credentials below.
 const char *configSTASSID = "SUPERONLINE_Wi-Fi_A662";
@@ -12,6 +18,8 @@ const unsigned int configSTACK = 10240;
 
 // Include Arduino core first for basic definitions
 #include <Arduino.h>
+#include <WiFi.h>
+#include <stdarg.h>
 
 #ifndef LED_BUILTIN
 #define LED_BUILTIN 2 // Default LED pin for ESP32
@@ -19,6 +27,7 @@ const unsigned int configSTACK = 10240;
 
 // Then include lower-level network headers
 #include <arpa/inet.h>
+#include <lwip/sockets.h>
 #include "esp_netif.h"
 
 // We use our own minimal SshServer wrapper (no filesystem keys)
@@ -27,7 +36,6 @@ volatile bool wifiPhyConnected;
 
 // Timing and timeout configuration.
 #define WIFI_TIMEOUT_S 10
-#define NET_WAIT_MS 100
 
 // Networking state of this esp32 device.
 typedef enum
@@ -47,50 +55,229 @@ static volatile bool gotIpAddr, gotIp6Addr;
 
 // No SPIFFS needed for SSH
 
-WifiManager wifiManager;
-// Diagnostic plain TCP server to verify inbound connectivity independent of libssh
-#include <WiFi.h>
-WiFiServer diagServer(8080);
-static TaskHandle_t diagTaskHandle = nullptr;
+ArduinoWifiDriver wifiDriver;
+WifiManager wifiManager(wifiDriver);
 
-// NEW: SSH server task
-static TaskHandle_t sshTaskHandle = nullptr;
+// One network task runs a Reactor that accepts on both the SSH listener and
+// the plain TCP diagnostic port (used to verify inbound connectivity
+// independent of libssh), replacing the separate polling diag task.
+#define DIAG_PORT 8080
+static TaskHandle_t netTaskHandle = nullptr;
+static TaskHandle_t controlTaskHandle = nullptr;
+static Reactor reactor;
 static SshServer sshServer("/id_ed25519");
+static int diagFd = -1;
+static uint32_t diagLastWakeups = 0;
+static uint32_t diagLastCpuWakeups = 0;
+static unsigned long diagLastMs = 0;
+
+static unsigned avgUs(uint64_t total, uint32_t n) {
+  return n ? (unsigned)(total / n) : 0;
+}
+
+// Appends to the diag reply. len stops at the last byte however much a section
+// asked for, so the next one always has room for its terminator.
+static void diagPut(char* msg, size_t size, size_t& len, const char* fmt, ...) __attribute__((format(printf, 4, 5)));
+static void diagPut(char* msg, size_t size, size_t& len, const char* fmt, ...) {
+  if (len >= size) len = size - 1;
+  va_list ap;
+  va_start(ap, fmt);
+  int w = vsnprintf(msg + len, size - len, fmt, ap);
+  va_end(ap);
+  if (w > 0) len += (size_t)w;
+  if (len >= size) len = size - 1;
+}
+
+static void onDiagAccept(int fd, void*) {
+  int c = accept(fd, nullptr, nullptr);
+  if (c < 0) return;
+  unsigned long now = millis();
+  uint32_t wakeups = reactor.wakeups();
+  uint32_t cpuWakeups = PowerManager::wakeups();
+  unsigned long spanMs = now - diagLastMs;
+  const SshServerStats& st = sshServer.getStats();
+  char msg[1280];
+  size_t len = 0;
+  diagPut(msg, sizeof(msg), len,
+    "ESP32 TCP diag OK (port %d)\r\nuptime_ms=%lu net_wakeups=%u net_wakeups_per_s=%.2f "
+    "cpu_wakeups=%u cpu_wakeups_per_s=%.2f light_sleep=%d free_heap=%u min_free_heap=%u largest_block=%u\r\n"
+    "ssh_accepted=%u ssh_accept_failed=%u ssh_kex_failed=%u ssh_auth_failed=%u ssh_dropped=%u ssh_completed=%u\r\n"
+    "ssh_prewarmed=%u ssh_setup_avg_us=%u ssh_accept_avg_us=%u ssh_kex_avg_us=%u\r\n",
+    DIAG_PORT, now, (unsigned)wakeups,
+    spanMs ? (wakeups - diagLastWakeups) * 1000.0 / spanMs : 0.0, (unsigned)cpuWakeups,
+    spanMs ? (cpuWakeups - diagLastCpuWakeups) * 1000.0 / spanMs : 0.0,
+    PowerManager::lightSleepEnabled() ? 1 : 0, (unsigned)ESP.getFreeHeap(),
+    (unsigned)ESP.getMinFreeHeap(), (unsigned)ESP.getMaxAllocHeap(),
+    (unsigned)st.accepted, (unsigned)st.acceptFailed, (unsigned)st.kexFailed,
+    (unsigned)st.authFailed, (unsigned)st.dropped, (unsigned)st.completed, (unsigned)st.prewarmed,
+    avgUs(st.setupUsTotal, st.handshakes), avgUs(st.acceptUsTotal, st.handshakes),
+    avgUs(st.kexUsTotal, st.handshakes));
+  len += wifiManager.format(msg + len, sizeof(msg) - len);
+  diagPut(msg, sizeof(msg), len, "\r\n");
+  len += MemoryBudget::format(msg + len, sizeof(msg) - len);
+  diagPut(msg, sizeof(msg), len, "\r\n");
+  len += AllocTracker::format(msg + len, sizeof(msg) - len);
+  diagPut(msg, sizeof(msg), len, "\r\n");
+  diagLastWakeups = wakeups;
+  diagLastCpuWakeups = cpuWakeups;
+  diagLastMs = now;
+  send(c, msg, len, 0);
+  closesocket(c);
+}
+
+static int diagListen(uint16_t port) {
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  if (fd < 0) return -1;
+  int one = 1;
+  setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+  struct sockaddr_in addr = {};
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(port);
+  addr.sin_addr.s_addr = htonl(INADDR_ANY);
+  if (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0 || listen(fd, 2) < 0) {
+    closesocket(fd);
+    return -1;
+  }
+  fcntl(fd, F_SETFL, O_NONBLOCK);
+  return fd;
+}
+
+#if METRICS_HISTORY
+// History export: connect and read CSV, e.g. nc 192.168.1.7 8081 > history.csv
+#define HISTORY_PORT 8081
+static int historyFd = -1;
+
+// Feeds the metrics history from the heap, the SSH server and Wi-Fi.
+class DeviceMetrics : public MetricsSource {
+public:
+  void read(MetricSample& out) override {
+    out.v[METRIC_HEAP_FREE] = (int32_t)ESP.getFreeHeap();
+    out.v[METRIC_HEAP_LARGEST] = (int32_t)ESP.getMaxAllocHeap();
+    out.v[METRIC_SESSIONS] = sshServer.openChannels();
+    uint64_t in, out64;
+    sshServer.wireBytes(in, out64);
+    out.v[METRIC_BYTES_IN] = (int32_t)((in - lastIn) * 1000 / METRICS_SAMPLE_MS);
+    out.v[METRIC_BYTES_OUT] = (int32_t)((out64 - lastOut) * 1000 / METRICS_SAMPLE_MS);
+    lastIn = in;
+    lastOut = out64;
+    if (WiFi.status() == WL_CONNECTED) out.v[METRIC_RSSI] = WiFi.RSSI();
+    const SshServerStats& st = sshServer.getStats();
+    if (st.handshakes != lastHandshakes) {
+      out.v[METRIC_HANDSHAKE_MS] = (int32_t)((st.kexUsTotal - lastKexUs) / (st.handshakes - lastHandshakes) / 1000);
+      lastHandshakes = st.handshakes;
+      lastKexUs = st.kexUsTotal;
+    }
+  }
+private:
+  uint64_t lastIn = 0, lastOut = 0;
+  uint32_t lastHandshakes = 0;
+  uint64_t lastKexUs = 0;
+};
+static DeviceMetrics deviceMetrics;
+
+static void onMetricsTimer(void*) {
+  MetricsHistory::sample(deviceMetrics);
+}
 
-void diagServerTask(void *param) {
-  for (;;) {
-    WiFiClient c = diagServer.available();
-    if (c) {
-      c.println("ESP32 TCP diag OK (port 8080)\r");
-      c.stop();
+// One row per point, oldest first within each tier; empty cells have no data.
+static void onHistoryAccept(int fd, void*) {
+  int c = accept(fd, nullptr, nullptr);
+  if (c < 0) return;
+  struct timeval tv = { 2, 0 };
+  setsockopt(c, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+  char buf[512];
+  int len = snprintf(buf, sizeof(buf), "tier,uptime_s");
+  for (uint8_t m = 0; m < METRIC_COUNT; m++) {
+    len += snprintf(buf + len, sizeof(buf) - len, ",%s", MetricsHistory::name((MetricId)m));
+  }
+  len += snprintf(buf + len, sizeof(buf) - len, "\r\n");
+  for (uint8_t t = 0; t < TIER_COUNT; t++) {
+    MetricTier tier = (MetricTier)t;
+    uint16_t n = MetricsHistory::count(tier);
+    uint32_t periodS = MetricsHistory::periodMs(tier) / 1000;
+    for (uint16_t i = 0; i < n; i++) {
+      if (len > (int)sizeof(buf) - 128) {
+        if (send(c, buf, len, 0) < 0) { closesocket(c); return; }
+        len = 0;
+      }
+      len += snprintf(buf + len, sizeof(buf) - len, "%s,%lu", MetricsHistory::tierName(tier),
+                      (unsigned long)(MetricsHistory::newestS(tier) - (uint32_t)(n - 1 - i) * periodS));
+      for (uint8_t m = 0; m < METRIC_COUNT; m++) {
+        int32_t v = MetricsHistory::get(tier, i, (MetricId)m);
+        if (v == METRIC_NONE) len += snprintf(buf + len, sizeof(buf) - len, ",");
+        else len += snprintf(buf + len, sizeof(buf) - len, ",%ld", (long)v);
+      }
+      len += snprintf(buf + len, sizeof(buf) - len, "\r\n");
     }
-    vTaskDelay(50 / portTICK_PERIOD_MS);
   }
+  send(c, buf, len, 0);
+  closesocket(c);
+}
+#endif
+
+// The SSH server handles one session at a time; keep its listener out of the
+// select set while that session runs (the session pumps the reactor itself).
+static void onSshAccept(int fd, void*) {
+  reactor.setPaused(fd, true);
+  sshServer.handleClient();
+  reactor.setPaused(fd, false);
+}
+
+static void netTask(void*) {
+  diagFd = diagListen(DIAG_PORT);
+  if (diagFd >= 0) {
+    reactor.addListener(diagFd, onDiagAccept, nullptr);
+    LOGI("NET", "Diagnostic TCP server listening on port %d", DIAG_PORT);
+  } else {
+    LOGE("NET", "Diagnostic listener failed on port %d", DIAG_PORT);
+  }
+  #if METRICS_HISTORY
+  historyFd = diagListen(HISTORY_PORT);
+  if (historyFd < 0 || !reactor.addListener(historyFd, onHistoryAccept, nullptr)) {
+    LOGE("NET", "History export unavailable on port %d", HISTORY_PORT);
+  }
+  reactor.addTimer(METRICS_SAMPLE_MS, onMetricsTimer, nullptr);
+  #endif
+  sshServer.begin();
+  if (!reactor.addListener(sshServer.listenFd(), onSshAccept, nullptr)) {
+    LOGE("NET", "SSH listener unavailable");
+  }
+  diagLastMs = millis();
+  reactor.run();
 }
 
-#define newDevState(s) (devState = s)
+// controlTask sleeps until one of these events changes what it waits for.
+#define newDevState(s) do { devState = s; TRACE_INSTANT(#s, 0); } while (0)
+#define wakeControlTask() do { if (controlTaskHandle) xTaskNotifyGive(controlTaskHandle); } while (0)
 
 void event_cb(void *args, esp_event_base_t base, int32_t id, void* event_data)
 {
+  TRACE_INSTANT(base == WIFI_EVENT ? "wifi_event" : "ip_event", id);
   switch(id)
   {
     case WIFI_EVENT_STA_START:
-      Serial.print("% WiFi enabled with SSID=");
-      Serial.println(configSTASSID);
+      LOGI("NET", "WiFi enabled with SSID=%s", configSTASSID);
       break;
     case WIFI_EVENT_STA_CONNECTED:
-      Serial.println("% WiFi connected");
+      {
+        wifi_event_sta_connected_t* event = (wifi_event_sta_connected_t*) event_data;
+        LOGI("NET", "WiFi connected");
+        wifiManager.onConnected(event->bssid, event->channel);
+      }
       wifiPhyConnected = true;
       if (devState < STATE_PHY_CONNECTED) newDevState(STATE_PHY_CONNECTED);
+      wakeControlTask();
       break;
     case WIFI_EVENT_STA_DISCONNECTED:
       if (devState < STATE_WAIT_IPADDR) newDevState(STATE_NEW);
       if (wifiPhyConnected)
       {
-        Serial.println("% WiFi disconnected");
+        LOGW("NET", "WiFi disconnected");
         wifiPhyConnected = false;
       }
+      wifiManager.onDisconnected(((wifi_event_sta_disconnected_t*) event_data)->reason);
       wifiManager.connect(configSTASSID, configSTAPSK);
+      wakeControlTask();
       break;
     case IP_EVENT_GOT_IP6:
       {
@@ -98,12 +285,12 @@ void event_cb(void *args, esp_event_base_t base, int32_t id, void* event_data)
         if (event->ip6_info.ip.addr[0] != htons(0xFE80) && !gotIp6Addr)
         {
           gotIp6Addr = true;
+          wakeControlTask();
         }
-        Serial.print("% IPv6 Address: ");
         #if ESP_IDF_VERSION_MAJOR >= 5
-        Serial.println(IPAddress((const uint8_t*)&event->ip6_info.ip.addr));
+        LOGI("NET", "IPv6 Address: %s", IPAddress((const uint8_t*)&event->ip6_info.ip.addr).toString().c_str());
         #else
-        Serial.println(IPv6Address(event->ip6_info.ip.addr));
+        LOGI("NET", "IPv6 Address: %s", IPv6Address(event->ip6_info.ip.addr).toString().c_str());
         #endif
       }
       break;
@@ -116,26 +303,13 @@ void event_cb(void *args, esp_event_base_t base, int32_t id, void* event_data)
         #endif
         gotIpAddr = true;
         ip_event_got_ip_t* event = (ip_event_got_ip_t*) event_data;
-        Serial.print("% IPv4 Address: ");
-        Serial.println(IPAddress(event->ip_info.ip.addr));
-        // Start diagnostic server once
-        if (!diagTaskHandle) {
-          diagServer.begin();
-          xTaskCreatePinnedToCore(diagServerTask, "diag", 4096, nullptr, 1, &diagTaskHandle, 0);
-          Serial.println("% Diagnostic TCP server listening on port 8080");
-        }
-
-        // Start SSH server once
-        if (!sshTaskHandle) {
-          auto sshTask = [](void*){
-            sshServer.begin();
-            for(;;){
-              sshServer.handleClient();
-              vTaskDelay(1);
-            }
-          };
-          xTaskCreatePinnedToCore(sshTask, "ssh", 12288, nullptr, 2, &sshTaskHandle, 0);
+        LOGI("NET", "IPv4 Address: " IPSTR, IP2STR(&event->ip_info.ip));
+        wifiManager.onGotIp(event->ip_info.ip.addr, event->ip_info.gw.addr, event->ip_info.netmask.addr);
+        // Start the network task (SSH + diag listeners) once
+        if (!netTaskHandle) {
+          xTaskCreatePinnedToCore(netTask, "net", 12288, nullptr, 2, &netTaskHandle, 0);
         }
+        wakeControlTask();
       }
       break;
     case IP_EVENT_STA_LOST_IP:
@@ -154,6 +328,7 @@ void controlTask(void *pvParameter)
   wifiPhyConnected = false;
   WiFi.disconnect(true);
   WiFi.mode(WIFI_MODE_STA);
+  PowerManager::begin();
   gotIpAddr = false; gotIp6Addr = false;
   wifiManager.connect(configSTASSID, configSTAPSK);
 
@@ -167,7 +342,8 @@ void controlTask(void *pvParameter)
     switch (devState)
     {
       case STATE_NEW :
-        vTaskDelay(NET_WAIT_MS / portTICK_PERIOD_MS);
+        // Reconnects are driven by event_cb; nothing to do until it reports.
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
         break;
       case STATE_PHY_CONNECTED :
         newDevState(STATE_WAIT_IPADDR);
@@ -175,22 +351,25 @@ void controlTask(void *pvParameter)
         xStartTime = xTaskGetTickCount();
         break;
       case STATE_WAIT_IPADDR :
-        if (gotIpAddr && gotIp6Addr)
+        // SSH listens on IPv4 as soon as it is up; IPv6 SLAAC completes in
+        // the background and is not waited for.
+        if (gotIpAddr)
           newDevState(STATE_GOT_IPADDR);
         else
         {
           // Check the timeout.
-          if (xTaskGetTickCount() >= xStartTime + xTicksTimeout)
+          TickType_t waited = xTaskGetTickCount() - xStartTime;
+          if (waited >= xTicksTimeout)
           {
-            printf("%% Timeout waiting for all IP addresses\n");
-            if (gotIpAddr || gotIp6Addr)
+            LOGW("NET", "Timeout waiting for an IPv4 address");
+            if (gotIp6Addr)
               newDevState(STATE_GOT_IPADDR);
             else
               newDevState(STATE_NEW);
           }
           else
           {
-            vTaskDelay(NET_WAIT_MS / portTICK_PERIOD_MS);
+            ulTaskNotifyTake(pdTRUE, xTicksTimeout - waited);
           }
         }
         break;
@@ -207,8 +386,8 @@ void controlTask(void *pvParameter)
         newDevState(STATE_LISTENING);
         break;
       case STATE_LISTENING :
-        // Idle state; nothing to do
-        vTaskDelay(NET_WAIT_MS / portTICK_PERIOD_MS);
+        // Idle state; the net task serves connections
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
         break;
       case STATE_TCP_DISCONNECTED :
         // This would be the place to free net resources, if needed,
@@ -225,6 +404,7 @@ void setup()
   devState = STATE_NEW;
 
   Serial.begin(115200);
+  Logger::begin();
 
   esp_netif_init();
   esp_event_loop_create_default();
@@ -233,11 +413,12 @@ void setup()
 
   // Stack size needs to be larger, so continue in a new task.
   xTaskCreatePinnedToCore(controlTask, "ctl", configSTACK, NULL,
-    (tskIDLE_PRIORITY + 3), NULL, portNUM_PROCESSORS - 1);
+    (tskIDLE_PRIORITY + 3), &controlTaskHandle, portNUM_PROCESSORS - 1);
 }
 
 void loop()
 {
-  // Nothing to do here since controlTask has taken over.
-  vTaskDelay(60000 / portTICK_PERIOD_MS);
+  // Nothing to do here since controlTask has taken over; end the Arduino
+  // loop task rather than waking it periodically.
+  vTaskDelete(NULL);
 }
\ No newline at end of file
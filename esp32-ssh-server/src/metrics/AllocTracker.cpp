@@ -0,0 +1,151 @@
+#include "AllocTracker.h"
+#include <esp_heap_caps.h>
+#include <string.h>
+
+static const char* const TAG_NAMES[ALLOC_TAG_COUNT] = { "other", "ssh", "app", "lwip", "wifi" };
+
+const char* AllocTracker::tagName(uint8_t tag) {
+    return tag < ALLOC_TAG_COUNT ? TAG_NAMES[tag] : "?";
+}
+
+#if ALLOC_TRACKING
+
+static const uint8_t TAG_NONE = 0xFF;
+static const uint8_t TRAILER_MAGIC = 0xA5;
+static const size_t TRAILER_BYTES = 2; // magic, tag at the very end of the block
+
+static AllocTagStats tagStats[ALLOC_TAG_COUNT];
+static portMUX_TYPE statsMux = portMUX_INITIALIZER_UNLOCKED;
+static __thread uint8_t scopeTag = TAG_NONE;
+
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t n, size_t size);
+void* __real_realloc(void* p, size_t size);
+void __real_free(void* p);
+}
+
+AllocScope::AllocScope(AllocTag tag) : outer(scopeTag) { scopeTag = tag; }
+AllocScope::~AllocScope() { scopeTag = outer; }
+
+static uint8_t currentTag() {
+    if (scopeTag != TAG_NONE) return scopeTag;
+    if (xTaskGetSchedulerState() == taskSCHEDULER_NOT_STARTED) return ALLOC_OTHER;
+    const char* task = pcTaskGetName(nullptr);
+    if (!strcmp(task, "tiT")) return ALLOC_LWIP;
+    if (!strncmp(task, "wifi", 4) || !strcmp(task, "sys_evt")) return ALLOC_WIFI;
+    return ALLOC_OTHER;
+}
+
+static void account(uint8_t tag, int32_t bytes) {
+    AllocTagStats& s = tagStats[tag];
+    portENTER_CRITICAL(&statsMux);
+    if (bytes >= 0) {
+        s.allocs++;
+        s.curBytes += bytes;
+        if (s.curBytes > s.peakBytes) s.peakBytes = s.curBytes;
+    } else {
+        s.frees++;
+        // Blocks freed here but not allocated through the wrappers can make
+        // the books slightly off; never underflow.
+        s.curBytes = s.curBytes > (uint32_t)-bytes ? s.curBytes + bytes : 0;
+    }
+    portEXIT_CRITICAL(&statsMux);
+}
+
+static void stamp(void* p, uint8_t tag) {
+    size_t block = heap_caps_get_allocated_size(p);
+    uint8_t* trailer = (uint8_t*)p + block - TRAILER_BYTES;
+    trailer[0] = TRAILER_MAGIC;
+    trailer[1] = tag;
+    account(tag, (int32_t)block);
+}
+
+// Returns the tag of a tracked block (and un-charges it), TAG_NONE otherwise.
+static uint8_t unstamp(void* p) {
+    size_t block = heap_caps_get_allocated_size(p);
+    if (block < TRAILER_BYTES) return TAG_NONE;
+    uint8_t* trailer = (uint8_t*)p + block - TRAILER_BYTES;
+    if (trailer[0] != TRAILER_MAGIC || trailer[1] >= ALLOC_TAG_COUNT) return TAG_NONE;
+    uint8_t tag = trailer[1];
+    trailer[0] = 0;
+    account(tag, -(int32_t)block);
+    return tag;
+}
+
+extern "C" void* __wrap_malloc(size_t size) {
+    void* p = __real_malloc(size + TRAILER_BYTES);
+    if (p) stamp(p, currentTag());
+    return p;
+}
+
+extern "C" void* __wrap_calloc(size_t n, size_t size) {
+    if (size && n > (SIZE_MAX - TRAILER_BYTES) / size) return nullptr;
+    void* p = __real_calloc(1, n * size + TRAILER_BYTES);
+    if (p) stamp(p, currentTag());
+    return p;
+}
+
+extern "C" void __wrap_free(void* p) {
+    if (!p) return;
+    unstamp(p);
+    __real_free(p);
+}
+
+extern "C" void* __wrap_realloc(void* p, size_t size) {
+    if (!p) return __wrap_malloc(size);
+    if (size == 0) {
+        __wrap_free(p);
+        return nullptr;
+    }
+    // The block keeps its original owner across resizes.
+    uint8_t tag = unstamp(p);
+    void* q = __real_realloc(p, size + TRAILER_BYTES);
+    if (!q) {
+        if (tag != TAG_NONE) stamp(p, tag); // old block is still live
+        return nullptr;
+    }
+    stamp(q, tag != TAG_NONE ? tag : currentTag());
+    return q;
+}
+
+void AllocTracker::snapshot(AllocTagStats out[ALLOC_TAG_COUNT]) {
+    portENTER_CRITICAL(&statsMux);
+    memcpy(out, tagStats, sizeof(tagStats));
+    portEXIT_CRITICAL(&statsMux);
+}
+
+void AllocTracker::resetPeaks() {
+    portENTER_CRITICAL(&statsMux);
+    for (uint8_t i = 0; i < ALLOC_TAG_COUNT; i++) tagStats[i].peakBytes = tagStats[i].curBytes;
+    portEXIT_CRITICAL(&statsMux);
+}
+
+size_t AllocTracker::format(char* out, size_t len) {
+    AllocTagStats s[ALLOC_TAG_COUNT];
+    snapshot(s);
+    size_t pos = 0;
+    for (uint8_t i = 0; i < ALLOC_TAG_COUNT && pos < len; i++) {
+        int w = snprintf(out + pos, len - pos, "%salloc_%s_cur=%u alloc_%s_peak=%u alloc_%s_n=%u",
+                         i ? " " : "", TAG_NAMES[i], (unsigned)s[i].curBytes, TAG_NAMES[i],
+                         (unsigned)s[i].peakBytes, TAG_NAMES[i], (unsigned)s[i].allocs);
+        if (w < 0) break;
+        pos += (size_t)w;
+    }
+    return pos < len ? pos : (len ? len - 1 : 0);
+}
+
+#else
+
+void AllocTracker::snapshot(AllocTagStats out[ALLOC_TAG_COUNT]) {
+    memset(out, 0, sizeof(AllocTagStats) * ALLOC_TAG_COUNT);
+}
+
+void AllocTracker::resetPeaks() {}
+
+size_t AllocTracker::format(char* out, size_t len) {
+    int w = snprintf(out, len, "alloc_tracking=off");
+    return w < 0 ? 0 : ((size_t)w < len ? (size_t)w : (len ? len - 1 : 0));
+}
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef ALLOC_TRACKER_H
+#define ALLOC_TRACKER_H
+
+#include <Arduino.h>
+
+// Build with the esp32dev-alloc environment (ALLOC_TRACKING=1 plus
+// -Wl,--wrap=malloc,...) to enable; otherwise everything here is a no-op.
+#ifndef ALLOC_TRACKING
+#define ALLOC_TRACKING 0
+#endif
+
+enum AllocTag : uint8_t {
+    ALLOC_OTHER = 0,
+    ALLOC_SSH,      // libssh session setup: key exchange, auth, channel open
+    ALLOC_APP,      // shell menu and apps, including their channel I/O
+    ALLOC_LWIP,     // anything allocated on the tcpip task
+    ALLOC_WIFI,     // Wi-Fi / event tasks
+    ALLOC_TAG_COUNT
+};
+
+struct AllocTagStats {
+    uint32_t curBytes;   // live heap blocks, in allocated (not requested) bytes
+    uint32_t peakBytes;  // high-water mark of curBytes since resetPeaks()
+    uint32_t allocs;     // malloc/calloc/realloc calls since boot
+    uint32_t frees;
+};
+
+// Per-subsystem heap accounting via linker-wrapped malloc/calloc/realloc/free.
+// An allocation is charged to the innermost AllocScope on the calling task,
+// else to a tag derived from the task name. Blocks obtained straight from
+// heap_caps_* (Wi-Fi driver, newlib internals) are not seen.
+class AllocTracker {
+public:
+    static bool enabled() { return ALLOC_TRACKING; }
+    static void snapshot(AllocTagStats out[ALLOC_TAG_COUNT]);
+    static void resetPeaks();
+    static const char* tagName(uint8_t tag);
+    // "alloc_<tag>_cur=.. alloc_<tag>_peak=.. alloc_<tag>_n=.." for every tag.
+    static size_t format(char* out, size_t len);
+};
+
+// Charge allocations made on this task to `tag` until the scope ends.
+class AllocScope {
+public:
+#if ALLOC_TRACKING
+    explicit AllocScope(AllocTag tag);
+    ~AllocScope();
+private:
+    uint8_t outer;
+#else
+    explicit AllocScope(AllocTag) {}
+#endif
+};
+
+#endif // ALLOC_TRACKER_H
@@ -0,0 +1,41 @@
+#include "LatencyHistogram.h"
+#include <stdio.h>
+#include <string.h>
+
+void LatencyHistogram::add(uint32_t us) {
+    int b = us ? 32 - __builtin_clz(us) : 0;
+    if (b >= BUCKETS) b = BUCKETS - 1;
+    counts[b]++;
+    n++;
+    sumUs += us;
+    if (us > maxUs) maxUs = us;
+}
+
+void LatencyHistogram::reset() {
+    memset(this, 0, sizeof(*this));
+}
+
+uint32_t LatencyHistogram::percentileUs(unsigned pct) const {
+    if (!n) return 0;
+    uint64_t target = ((uint64_t)n * pct + 99) / 100;
+    uint64_t seen = 0;
+    for (int b = 0; b < BUCKETS; b++) {
+        seen += counts[b];
+        if (seen >= target) return b == BUCKETS - 1 ? maxUs : (1UL << b);
+    }
+    return maxUs;
+}
+
+size_t LatencyHistogram::format(char* out, size_t outLen) const {
+    if (!outLen) return 0;
+    int w = snprintf(out, outLen, "n=%u avg_us=%u p50_us<=%u p90_us<=%u p99_us<=%u max_us=%u\r\n",
+                     (unsigned)n, n ? (unsigned)(sumUs / n) : 0u, (unsigned)percentileUs(50),
+                     (unsigned)percentileUs(90), (unsigned)percentileUs(99), (unsigned)maxUs);
+    size_t pos = w > 0 ? (size_t)w : 0;
+    for (int b = 0; b < BUCKETS && pos < outLen; b++) {
+        if (!counts[b]) continue;
+        w = snprintf(out + pos, outLen - pos, "  <%luus %u\r\n", 1UL << b, (unsigned)counts[b]);
+        if (w > 0) pos += (size_t)w;
+    }
+    return pos < outLen ? pos : outLen - 1;
+}
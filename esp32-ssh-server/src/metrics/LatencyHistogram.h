@@ -0,0 +1,25 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Log2-bucketed latency histogram: bucket i counts samples in [2^(i-1), 2^i) us,
+// bucket 0 counts sub-microsecond samples, the last bucket everything above.
+struct LatencyHistogram {
+    static const int BUCKETS = 24; // up to ~8 s
+    uint32_t counts[BUCKETS];
+    uint32_t n;
+    uint32_t maxUs;
+    uint64_t sumUs;
+
+    void add(uint32_t us);
+    void reset();
+    // Approximate percentile (upper bound of the bucket holding it), in us.
+    uint32_t percentileUs(unsigned pct) const;
+    // One summary line followed by one "<Nus count" line per non-empty bucket,
+    // CRLF separated. Returns the length written (truncated to outLen).
+    size_t format(char* out, size_t outLen) const;
+};
+
+#endif // LATENCY_HISTOGRAM_H
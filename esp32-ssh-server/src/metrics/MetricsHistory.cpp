@@ -0,0 +1,143 @@
+#include "MetricsHistory.h"
+#include <esp_timer.h>
+
+#if METRICS_HISTORY
+
+static_assert(60000 % METRICS_SAMPLE_MS == 0, "METRICS_SAMPLE_MS must divide one minute");
+
+static const uint16_t SAMPLES_PER_MINUTE = 60000 / METRICS_SAMPLE_MS;
+static const uint16_t MINUTES_PER_HOUR = 60;
+
+static MetricSample secondRing[METRICS_SECONDS];
+static MetricSample minuteRing[METRICS_MINUTES];
+static MetricSample hourRing[METRICS_HOURS];
+static MetricSample* const rings[TIER_COUNT] = { secondRing, minuteRing, hourRing };
+static const uint16_t capacities[TIER_COUNT] = { METRICS_SECONDS, METRICS_MINUTES, METRICS_HOURS };
+static uint32_t heads[TIER_COUNT];      // points ever pushed
+static uint32_t newest[TIER_COUNT];     // uptime s at the end of the newest point
+
+static uint32_t nSamples = 0;
+static uint64_t sampleUsTotal = 0;
+static uint32_t sampleUsMax = 0;
+
+const MetricsHistory::Fold MetricsHistory::folds[METRIC_COUNT] = {
+    FOLD_MIN, FOLD_MIN, FOLD_MAX, FOLD_AVG, FOLD_AVG, FOLD_AVG, FOLD_AVG
+};
+
+MetricsHistory::Accumulator MetricsHistory::minuteAcc;
+MetricsHistory::Accumulator MetricsHistory::hourAcc;
+
+void MetricsHistory::sample(MetricsSource& src){
+    // Wall time rather than cycles: the CPU clock scales while idle.
+    int64_t t0 = esp_timer_get_time();
+    MetricSample s;
+    for (uint8_t m = 0; m < METRIC_COUNT; m++) s.v[m] = METRIC_NONE;
+    src.read(s);
+    push(TIER_SECONDS, s);
+    accumulate(minuteAcc, s);
+    if (minuteAcc.points == SAMPLES_PER_MINUTE){
+        MetricSample minute;
+        fold(minuteAcc, minute);
+        push(TIER_MINUTES, minute);
+        accumulate(hourAcc, minute);
+        if (hourAcc.points == MINUTES_PER_HOUR){
+            MetricSample hour;
+            fold(hourAcc, hour);
+            push(TIER_HOURS, hour);
+        }
+    }
+    uint32_t us = (uint32_t)(esp_timer_get_time() - t0);
+    nSamples++;
+    sampleUsTotal += us;
+    if (us > sampleUsMax) sampleUsMax = us;
+}
+
+void MetricsHistory::push(MetricTier tier, const MetricSample& s){
+    rings[tier][heads[tier] % capacities[tier]] = s;
+    heads[tier]++;
+    newest[tier] = millis() / 1000;
+}
+
+void MetricsHistory::accumulate(Accumulator& acc, const MetricSample& s){
+    if (acc.points == 0){
+        for (uint8_t m = 0; m < METRIC_COUNT; m++){
+            acc.sum[m] = 0;
+            acc.n[m] = 0;
+        }
+    }
+    for (uint8_t m = 0; m < METRIC_COUNT; m++){
+        int32_t v = s.v[m];
+        if (v == METRIC_NONE) continue;
+        if (acc.n[m] == 0 || v < acc.min[m]) acc.min[m] = v;
+        if (acc.n[m] == 0 || v > acc.max[m]) acc.max[m] = v;
+        acc.sum[m] += v;
+        acc.n[m]++;
+    }
+    acc.points++;
+}
+
+void MetricsHistory::fold(Accumulator& acc, MetricSample& out){
+    for (uint8_t m = 0; m < METRIC_COUNT; m++){
+        if (acc.n[m] == 0){
+            out.v[m] = METRIC_NONE;
+            continue;
+        }
+        switch (folds[m]){
+            case FOLD_MIN: out.v[m] = acc.min[m]; break;
+            case FOLD_MAX: out.v[m] = acc.max[m]; break;
+            default: out.v[m] = (int32_t)(acc.sum[m] / acc.n[m]); break;
+        }
+    }
+    acc.points = 0;
+}
+
+uint16_t MetricsHistory::count(MetricTier tier){
+    return heads[tier] < capacities[tier] ? (uint16_t)heads[tier] : capacities[tier];
+}
+
+uint16_t MetricsHistory::capacity(MetricTier tier){
+    return capacities[tier];
+}
+
+uint32_t MetricsHistory::periodMs(MetricTier tier){
+    static const uint32_t periods[TIER_COUNT] = { METRICS_SAMPLE_MS, 60000UL, 3600000UL };
+    return periods[tier];
+}
+
+int32_t MetricsHistory::get(MetricTier tier, uint16_t i, MetricId m){
+    uint16_t n = count(tier);
+    if (i >= n) return METRIC_NONE;
+    return rings[tier][(heads[tier] - n + i) % capacities[tier]].v[m];
+}
+
+uint32_t MetricsHistory::newestS(MetricTier tier){
+    return newest[tier];
+}
+
+const char* MetricsHistory::name(MetricId m){
+    static const char* const names[METRIC_COUNT] = {
+        "heap_free", "heap_largest", "sessions", "bytes_in", "bytes_out", "rssi", "handshake_ms"
+    };
+    return m < METRIC_COUNT ? names[m] : "?";
+}
+
+const char* MetricsHistory::unit(MetricId m){
+    static const char* const units[METRIC_COUNT] = { "B", "B", "", "B/s", "B/s", "dBm", "ms" };
+    return m < METRIC_COUNT ? units[m] : "";
+}
+
+const char* MetricsHistory::tierName(MetricTier tier){
+    static const char* const names[TIER_COUNT] = { "seconds", "minutes", "hours" };
+    return tier < TIER_COUNT ? names[tier] : "?";
+}
+
+MetricsHistory::Stats MetricsHistory::stats(){
+    Stats s;
+    s.samples = nSamples;
+    s.sampleUsAvg = nSamples ? (uint32_t)(sampleUsTotal / nSamples) : 0;
+    s.sampleUsMax = sampleUsMax;
+    s.bytes = sizeof(secondRing) + sizeof(minuteRing) + sizeof(hourRing) + sizeof(minuteAcc) + sizeof(hourAcc);
+    return s;
+}
+
+#endif // METRICS_HISTORY
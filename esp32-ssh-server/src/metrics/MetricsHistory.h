@@ -0,0 +1,100 @@
+#ifndef METRICS_HISTORY_H
+#define METRICS_HISTORY_H
+
+#include <Arduino.h>
+
+// Time series of key metrics, so an operator who connects after the fact
+// can see what happened. 0 compiles the store and its sampler out.
+#ifndef METRICS_HISTORY
+#define METRICS_HISTORY 1
+#endif
+// Base sampling period; a divisor of one minute. Each sample wakes the
+// network task, so an idle board no longer sleeps undisturbed.
+#ifndef METRICS_SAMPLE_MS
+#define METRICS_SAMPLE_MS 1000
+#endif
+// Points kept per tier: base samples, then minutes and hours.
+#ifndef METRICS_SECONDS
+#define METRICS_SECONDS 60
+#endif
+#ifndef METRICS_MINUTES
+#define METRICS_MINUTES 120
+#endif
+#ifndef METRICS_HOURS
+#define METRICS_HOURS 48
+#endif
+
+enum MetricId : uint8_t {
+    METRIC_HEAP_FREE,       // bytes, lowest in the interval
+    METRIC_HEAP_LARGEST,    // bytes, lowest in the interval
+    METRIC_SESSIONS,        // open session channels, highest in the interval
+    METRIC_BYTES_IN,        // SSH wire bytes/s received, average
+    METRIC_BYTES_OUT,       // SSH wire bytes/s sent, average
+    METRIC_RSSI,            // dBm, average; none while disconnected
+    METRIC_HANDSHAKE_MS,    // key exchange time, average; none without handshakes
+    METRIC_COUNT
+};
+
+enum MetricTier : uint8_t { TIER_SECONDS, TIER_MINUTES, TIER_HOURS, TIER_COUNT };
+
+// Marks "no data" for a metric in a sample or point.
+#define METRIC_NONE INT32_MIN
+
+struct MetricSample {
+    int32_t v[METRIC_COUNT];
+};
+
+// Fills one base sample. Split out so the store can be fed without the
+// SSH server and Wi-Fi stack.
+class MetricsSource {
+public:
+    virtual ~MetricsSource() {}
+    virtual void read(MetricSample& out) = 0;
+};
+
+// Fixed-size rings, one per tier, sized at build time. Every full minute of
+// base samples is folded into one minute point and every 60 minute points
+// into one hour point, each metric by its own rule (lowest, highest or
+// average). The network task samples from a reactor timer; the history app
+// reads on whichever task runs its channel. No locking: ChannelScheduler
+// parks the network task while a channel task runs, and the reverse.
+class MetricsHistory {
+public:
+    struct Stats {
+        uint32_t samples;
+        uint32_t sampleUsAvg, sampleUsMax;  // read() plus folding, per sample
+        size_t bytes;                       // static footprint of the store
+    };
+
+    // Take one base sample from `src` and fold it into the upper tiers.
+    static void sample(MetricsSource& src);
+
+    static uint16_t count(MetricTier tier);
+    static uint16_t capacity(MetricTier tier);
+    static uint32_t periodMs(MetricTier tier);
+    // Point `i` of `tier`, 0 = oldest; METRIC_NONE when it has no data.
+    static int32_t get(MetricTier tier, uint16_t i, MetricId m);
+    // Uptime in seconds at the end of the newest point of `tier`.
+    static uint32_t newestS(MetricTier tier);
+
+    static const char* name(MetricId m);
+    static const char* unit(MetricId m);
+    static const char* tierName(MetricTier tier);
+    static Stats stats();
+
+private:
+    enum Fold : uint8_t { FOLD_MIN, FOLD_MAX, FOLD_AVG };
+    struct Accumulator {
+        int64_t sum[METRIC_COUNT];
+        int32_t min[METRIC_COUNT], max[METRIC_COUNT];
+        uint16_t n[METRIC_COUNT];
+        uint16_t points;
+    };
+    static const Fold folds[METRIC_COUNT];
+    static Accumulator minuteAcc, hourAcc;
+    static void push(MetricTier tier, const MetricSample& s);
+    static void accumulate(Accumulator& acc, const MetricSample& s);
+    static void fold(Accumulator& acc, MetricSample& out);
+};
+
+#endif // METRICS_HISTORY_H
@@ -0,0 +1,39 @@
+#include "SystemStats.h"
+#include <esp_heap_caps.h>
+#include <string.h>
+
+bool FreeRtosStatsProvider::sample(SystemSnapshot& out) {
+    out.nTasks = 0;
+    out.nCores = portNUM_PROCESSORS;
+    out.totalRuntime = 0;
+    out.freeHeap = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    out.minFreeHeap = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+    out.largestBlock = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+#if configUSE_TRACE_FACILITY
+    static TaskStatus_t raw[STATS_MAX_TASKS];
+    uint32_t total = 0;
+    UBaseType_t n = uxTaskGetSystemState(raw, STATS_MAX_TASKS, &total);
+    if (n == 0) return false; // more tasks than STATS_MAX_TASKS
+    out.totalRuntime = total;
+    static const char STATE_CHARS[] = { 'R', 'r', 'B', 'S', 'D', '?' };
+    for (UBaseType_t i = 0; i < n; i++) {
+        TaskSample& t = out.tasks[i];
+        strncpy(t.name, raw[i].pcTaskName, sizeof(t.name) - 1);
+        t.name[sizeof(t.name) - 1] = '\0';
+        t.id = raw[i].xTaskNumber;
+        t.runtime = raw[i].ulRunTimeCounter;
+        t.stackFreeMin = raw[i].usStackHighWaterMark;
+        t.priority = (uint8_t)raw[i].uxCurrentPriority;
+#if configTASKLIST_INCLUDE_COREID
+        t.core = raw[i].xCoreID == tskNO_AFFINITY ? -1 : (int8_t)raw[i].xCoreID;
+#else
+        t.core = -1;
+#endif
+        t.state = STATE_CHARS[raw[i].eCurrentState <= eDeleted ? raw[i].eCurrentState : 5];
+    }
+    out.nTasks = (uint8_t)n;
+    return true;
+#else
+    return true;
+#endif
+}
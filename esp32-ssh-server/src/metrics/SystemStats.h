@@ -0,0 +1,45 @@
+#ifndef SYSTEM_STATS_H
+#define SYSTEM_STATS_H
+
+#include <Arduino.h>
+
+#ifndef STATS_MAX_TASKS
+#define STATS_MAX_TASKS 24
+#endif
+
+struct TaskSample {
+    char name[16];
+    uint32_t id;            // FreeRTOS task number, stable for the task's lifetime
+    uint32_t runtime;       // run-time counter ticks since boot
+    uint32_t stackFreeMin;  // stack high-water mark (bytes never used)
+    uint8_t priority;
+    int8_t core;            // -1 = no affinity
+    char state;             // R(unning) r(eady) B(locked) S(uspended) D(eleted)
+};
+
+struct SystemSnapshot {
+    TaskSample tasks[STATS_MAX_TASKS];
+    uint8_t nTasks;
+    uint8_t nCores;
+    uint32_t totalRuntime;  // run-time counter ticks since boot, per core
+    uint32_t freeHeap;
+    uint32_t minFreeHeap;
+    uint32_t largestBlock;
+};
+
+// Source of per-task and heap statistics for the "top" app. Split out so a
+// stand-in can feed the renderer without FreeRTOS.
+class SystemStatsProvider {
+public:
+    virtual ~SystemStatsProvider() {}
+    virtual bool sample(SystemSnapshot& out) = 0;
+};
+
+// Reads FreeRTOS run-time stats and the default heap. CPU shares are all zero
+// if the core was built without configGENERATE_RUN_TIME_STATS.
+class FreeRtosStatsProvider : public SystemStatsProvider {
+public:
+    bool sample(SystemSnapshot& out) override;
+};
+
+#endif // SYSTEM_STATS_H
@@ -0,0 +1,65 @@
+#include "PowerManager.h"
+#include "Logger.h"
+#include <esp_pm.h>
+#include <esp_wifi.h>
+#include <esp_freertos_hooks.h>
+
+bool PowerManager::lightSleep = false;
+uint8_t PowerManager::sessions = 0;
+volatile uint32_t PowerManager::idleWakeups[portNUM_PROCESSORS] = {};
+
+static esp_pm_lock_handle_t sessionLock = nullptr;
+
+// The idle task runs its hooks once per pass, and each pass ends in a wait
+// for interrupt (or light sleep), so the call count is the wakeup count.
+bool PowerManager::idleHook0() {
+    idleWakeups[0]++;
+    return true;
+}
+
+bool PowerManager::idleHook1() {
+    idleWakeups[portNUM_PROCESSORS - 1]++;
+    return true;
+}
+
+uint32_t PowerManager::wakeups() {
+    uint32_t n = 0;
+    for (int i = 0; i < portNUM_PROCESSORS; i++) n += idleWakeups[i];
+    return n;
+}
+
+void PowerManager::begin() {
+    esp_register_freertos_idle_hook_for_cpu(idleHook0, 0);
+    if (portNUM_PROCESSORS > 1) esp_register_freertos_idle_hook_for_cpu(idleHook1, 1);
+
+#if ESP_IDF_VERSION_MAJOR >= 5
+    esp_pm_config_t cfg = {};
+#else
+    esp_pm_config_esp32_t cfg = {};
+#endif
+    cfg.max_freq_mhz = POWER_MAX_CPU_MHZ;
+    cfg.min_freq_mhz = POWER_MIN_CPU_MHZ;
+    cfg.light_sleep_enable = POWER_LIGHT_SLEEP;
+    esp_err_t err = esp_pm_configure(&cfg);
+    lightSleep = err == ESP_OK && POWER_LIGHT_SLEEP;
+    if (err != ESP_OK) {
+        LOGW("PWR", "Power management unavailable (%s); staying at full clock", esp_err_to_name(err));
+    } else if (esp_pm_lock_create(ESP_PM_CPU_FREQ_MAX, 0, "ssh", &sessionLock) != ESP_OK) {
+        sessionLock = nullptr;
+    }
+    esp_wifi_set_ps(WIFI_PS_MIN_MODEM);
+    LOGI("PWR", "DFS %d-%d MHz, light sleep %s, Wi-Fi modem sleep",
+         POWER_MIN_CPU_MHZ, POWER_MAX_CPU_MHZ, lightSleep ? "on" : "off");
+}
+
+void PowerManager::sessionBegin() {
+    if (sessions++) return;
+    if (sessionLock) esp_pm_lock_acquire(sessionLock);
+    esp_wifi_set_ps(WIFI_PS_NONE);
+}
+
+void PowerManager::sessionEnd() {
+    if (!sessions || --sessions) return;
+    esp_wifi_set_ps(WIFI_PS_MIN_MODEM);
+    if (sessionLock) esp_pm_lock_release(sessionLock);
+}
@@ -0,0 +1,54 @@
+#ifndef POWER_MANAGER_H
+#define POWER_MANAGER_H
+
+#include <Arduino.h>
+
+// Automatic light sleep between network events. The CPU scales between
+// POWER_MIN_CPU_MHZ and POWER_MAX_CPU_MHZ and sleeps when every task is
+// blocked; Wi-Fi stays associated in modem sleep and wakes for DTIM beacons.
+// Needs CONFIG_PM_ENABLE and tickless idle in the SDK build; without them
+// begin() logs why and the board runs as before.
+#ifndef POWER_LIGHT_SLEEP
+#define POWER_LIGHT_SLEEP 1
+#endif
+#ifndef POWER_MAX_CPU_MHZ
+#define POWER_MAX_CPU_MHZ 240
+#endif
+#ifndef POWER_MIN_CPU_MHZ
+#define POWER_MIN_CPU_MHZ 40
+#endif
+
+class PowerManager {
+public:
+    // Call once Wi-Fi is started (modem sleep needs the driver).
+    static void begin();
+    static bool lightSleepEnabled() { return lightSleep; }
+
+    // While a session is open: full CPU clock, no light sleep, and Wi-Fi
+    // power save off so keystrokes are not held for the next beacon.
+    // Nests; the last sessionEnd() restores idle power saving.
+    static void sessionBegin();
+    static void sessionEnd();
+
+    // Times each core left its idle wait (interrupt, tick or sleep wakeup).
+    static uint32_t wakeups(int core) { return idleWakeups[core]; }
+    static uint32_t wakeups();
+
+private:
+    static bool lightSleep;
+    static uint8_t sessions;
+    static volatile uint32_t idleWakeups[portNUM_PROCESSORS];
+    static bool idleHook0();
+    static bool idleHook1();
+};
+
+// Keeps the board awake for the lifetime of a session (see sessionBegin()).
+class PowerSessionScope {
+public:
+    PowerSessionScope() { PowerManager::sessionBegin(); }
+    ~PowerSessionScope() { PowerManager::sessionEnd(); }
+    PowerSessionScope(const PowerSessionScope&) = delete;
+    PowerSessionScope& operator=(const PowerSessionScope&) = delete;
+};
+
+#endif // POWER_MANAGER_H
@@ -0,0 +1,105 @@
+#include "Reactor.h"
+#include <lwip/sockets.h>
+
+Reactor* Reactor::activeReactor = nullptr;
+
+bool Reactor::addListener(int fd, FdHandler handler, void* ctx) {
+    if (fd < 0 || nListeners >= REACTOR_MAX_LISTENERS) return false;
+    listeners[nListeners++] = { fd, handler, ctx, false };
+    return true;
+}
+
+void Reactor::removeListener(int fd) {
+    for (uint8_t i = 0; i < nListeners; i++) {
+        if (listeners[i].fd == fd) {
+            listeners[i] = listeners[--nListeners];
+            return;
+        }
+    }
+}
+
+void Reactor::setPaused(int fd, bool paused) {
+    for (uint8_t i = 0; i < nListeners; i++) {
+        if (listeners[i].fd == fd) listeners[i].paused = paused;
+    }
+}
+
+bool Reactor::addTimer(uint32_t intervalMs, TimerHandler handler, void* ctx) {
+    if (nTimers >= REACTOR_MAX_TIMERS || intervalMs == 0) return false;
+    timers[nTimers++] = { intervalMs, (uint32_t)(millis() + intervalMs), handler, ctx };
+    return true;
+}
+
+// Fire due timers; returns ms until the next one (-1 if none).
+int Reactor::runTimers() {
+    int next = -1;
+    uint32_t now = millis();
+    for (uint8_t i = 0; i < nTimers; i++) {
+        Timer& t = timers[i];
+        if ((int32_t)(now - t.nextMs) >= 0) {
+            t.handler(t.ctx);
+            t.nextMs += t.intervalMs;
+            if ((int32_t)(now - t.nextMs) >= 0) t.nextMs = now + t.intervalMs; // fell behind
+        }
+        int due = (int)(int32_t)(t.nextMs - now);
+        if (due < 0) due = 0;
+        if (next < 0 || due < next) next = due;
+    }
+    return next;
+}
+
+bool Reactor::poll(int timeoutMs, int waitFd) {
+    return poll(timeoutMs, &waitFd, waitFd >= 0 ? 1 : 0) != 0;
+}
+
+uint32_t Reactor::poll(int timeoutMs, const int* waitFds, uint8_t nWaitFds) {
+    Reactor* outer = activeReactor;
+    activeReactor = this;
+    int untilTimer = runTimers();
+    if (untilTimer >= 0 && (timeoutMs < 0 || untilTimer < timeoutMs)) timeoutMs = untilTimer;
+
+    fd_set rfds;
+    FD_ZERO(&rfds);
+    int maxFd = -1;
+    for (uint8_t i = 0; i < nListeners; i++) {
+        if (listeners[i].paused) continue;
+        FD_SET(listeners[i].fd, &rfds);
+        if (listeners[i].fd > maxFd) maxFd = listeners[i].fd;
+    }
+    for (uint8_t i = 0; i < nWaitFds; i++) {
+        if (waitFds[i] < 0) continue;
+        FD_SET(waitFds[i], &rfds);
+        if (waitFds[i] > maxFd) maxFd = waitFds[i];
+    }
+
+    struct timeval tv;
+    struct timeval* tvp = nullptr;
+    if (timeoutMs >= 0) {
+        tv.tv_sec = timeoutMs / 1000;
+        tv.tv_usec = (timeoutMs % 1000) * 1000;
+        tvp = &tv;
+    }
+    int n = select(maxFd + 1, &rfds, nullptr, nullptr, tvp);
+    nWakeups++;
+
+    uint32_t waitReady = 0;
+    if (n > 0) {
+        for (uint8_t i = 0; i < nWaitFds && i < 32; i++) {
+            if (waitFds[i] >= 0 && FD_ISSET(waitFds[i], &rfds)) waitReady |= 1UL << i;
+        }
+        // Handlers may add/remove listeners; iterate over a snapshot.
+        Listener ready[REACTOR_MAX_LISTENERS];
+        uint8_t nReady = 0;
+        for (uint8_t i = 0; i < nListeners; i++) {
+            if (!listeners[i].paused && FD_ISSET(listeners[i].fd, &rfds)) ready[nReady++] = listeners[i];
+        }
+        for (uint8_t i = 0; i < nReady; i++) ready[i].handler(ready[i].fd, ready[i].ctx);
+    }
+    runTimers();
+    activeReactor = outer;
+    return waitReady;
+}
+
+void Reactor::run() {
+    for (;;) poll(-1);
+}
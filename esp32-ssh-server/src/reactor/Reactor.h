@@ -0,0 +1,54 @@
+#ifndef REACTOR_H
+#define REACTOR_H
+
+#include <Arduino.h>
+
+#ifndef REACTOR_MAX_LISTENERS
+#define REACTOR_MAX_LISTENERS 4
+#endif
+#ifndef REACTOR_MAX_TIMERS
+#define REACTOR_MAX_TIMERS 4
+#endif
+
+// Single select() loop for the network task: listening sockets, periodic
+// timers, and (while a session runs) the session socket. With nothing due it
+// blocks indefinitely, so an idle device does not wake this task at all.
+class Reactor {
+public:
+    typedef void (*FdHandler)(int fd, void* ctx);
+    typedef void (*TimerHandler)(void* ctx);
+
+    bool addListener(int fd, FdHandler handler, void* ctx);
+    void removeListener(int fd);
+    // Paused listeners stay registered but are not selected on (e.g. the SSH
+    // listener while its single session is being served).
+    void setPaused(int fd, bool paused);
+    bool addTimer(uint32_t intervalMs, TimerHandler handler, void* ctx);
+
+    // Wait up to timeoutMs (-1 = forever) for a listener, a due timer or
+    // `waitFd`. Listener and timer handlers run from here; returns true when
+    // waitFd became readable.
+    bool poll(int timeoutMs, int waitFd = -1);
+    // Same, for several fds; bit i of the result is set when waitFds[i] is
+    // readable.
+    uint32_t poll(int timeoutMs, const int* waitFds, uint8_t nWaitFds);
+    void run();
+
+    uint32_t wakeups() const { return nWakeups; }
+
+    // Reactor currently driving the calling loop, if any.
+    static Reactor* active() { return activeReactor; }
+
+private:
+    struct Listener { int fd; FdHandler handler; void* ctx; bool paused; };
+    struct Timer { uint32_t intervalMs; uint32_t nextMs; TimerHandler handler; void* ctx; };
+    Listener listeners[REACTOR_MAX_LISTENERS] = {};
+    Timer timers[REACTOR_MAX_TIMERS] = {};
+    uint8_t nListeners = 0;
+    uint8_t nTimers = 0;
+    volatile uint32_t nWakeups = 0;
+    static Reactor* activeReactor;
+    int runTimers();
+};
+
+#endif // REACTOR_H
@@ -0,0 +1,134 @@
+#include "SessionRecorder.h"
+#include <string.h>
+
+// On-ring event header; data follows, both may wrap at the end of the ring.
+struct RecHeader {
+    uint32_t ms;
+    uint16_t len;
+    char type;
+    uint8_t reserved;
+};
+
+uint8_t* SessionRecorder::ring = nullptr;
+uint32_t SessionRecorder::capacity = 0;
+uint32_t SessionRecorder::head = 0;
+uint32_t SessionRecorder::tail = 0;
+ssh_channel SessionRecorder::paused[SSH_RECORD_MAX_PAUSED] = {};
+uint8_t SessionRecorder::nPaused = 0;
+SessionRecorder::Stats SessionRecorder::counters = {};
+
+static void ringPut(uint8_t* ring, uint32_t cap, uint32_t pos, const void* src, uint32_t n){
+    uint32_t at = pos % cap;
+    uint32_t first = n < cap - at ? n : cap - at;
+    memcpy(ring + at, src, first);
+    if (n > first) memcpy(ring, (const uint8_t*)src + first, n - first);
+}
+
+static void ringGet(const uint8_t* ring, uint32_t cap, uint32_t pos, void* dst, uint32_t n){
+    uint32_t at = pos % cap;
+    uint32_t first = n < cap - at ? n : cap - at;
+    memcpy(dst, ring + at, first);
+    if (n > first) memcpy((uint8_t*)dst + first, ring, n - first);
+}
+
+bool SessionRecorder::enable(size_t bytes){
+    if (ring) return true;
+    if (bytes < 1024) bytes = 1024;
+    ring = (uint8_t*)malloc(bytes);
+    if (!ring) return false;
+    capacity = bytes;
+    clear();
+    return true;
+}
+
+void SessionRecorder::disable(){
+    uint8_t* r = ring;
+    ring = nullptr;
+    free(r);
+    capacity = 0;
+}
+
+void SessionRecorder::setPaused(ssh_channel ch, bool pause){
+    for (uint8_t i = 0; i < nPaused; i++){
+        if (paused[i] != ch) continue;
+        if (!pause) paused[i] = paused[--nPaused];
+        return;
+    }
+    if (pause && nPaused < SSH_RECORD_MAX_PAUSED) paused[nPaused++] = ch;
+}
+
+bool SessionRecorder::isPaused(ssh_channel ch){
+    for (uint8_t i = 0; i < nPaused; i++) if (paused[i] == ch) return true;
+    return false;
+}
+
+void SessionRecorder::clear(){
+    head = tail = 0;
+    counters = {};
+}
+
+void SessionRecorder::record(char type, const void* data, size_t len){
+    uint32_t t0 = ESP.getCycleCount();
+    const uint8_t* p = (const uint8_t*)data;
+    // Keep any one event to a quarter of the ring so a bulk write cannot
+    // evict the whole history at once; longer writes become several events.
+    const uint32_t maxChunk = capacity / 4 - sizeof(RecHeader);
+    uint32_t ms = millis();
+    if (head > 0x40000000UL){
+        // Rebase by whole rings long before the offsets could wrap.
+        uint32_t shift = tail - tail % capacity;
+        head -= shift;
+        tail -= shift;
+    }
+    while (len > 0){
+        uint32_t n = len < maxChunk ? (uint32_t)len : maxChunk;
+        if (n > 0xFFFF) n = 0xFFFF;
+        uint32_t need = sizeof(RecHeader) + n;
+        while (head + need - tail > capacity){
+            RecHeader old;
+            ringGet(ring, capacity, tail, &old, sizeof(old));
+            tail += sizeof(RecHeader) + old.len;
+            counters.overwritten++;
+        }
+        RecHeader h = { ms, (uint16_t)n, type, 0 };
+        ringPut(ring, capacity, head, &h, sizeof(h));
+        ringPut(ring, capacity, head + sizeof(h), p, n);
+        head += need;
+        counters.events++;
+        counters.bytes += n;
+        p += n;
+        len -= n;
+    }
+    counters.cycles += ESP.getCycleCount() - t0;
+}
+
+void SessionRecorder::marker(const char* label){
+    if (ring && label) record('m', label, strlen(label));
+}
+
+bool SessionRecorder::next(uint32_t& cursor, Event& ev){
+    if (!ring) return false;
+    if (cursor < tail) cursor = tail; // older events were overwritten
+    if (cursor >= head) return false;
+    RecHeader h;
+    ringGet(ring, capacity, cursor, &h, sizeof(h));
+    ev.ms = h.ms;
+    ev.type = h.type;
+    ev.len = h.len;
+    ev.pos = cursor + sizeof(h);
+    cursor += sizeof(h) + h.len;
+    return true;
+}
+
+void SessionRecorder::read(const Event& ev, uint16_t offset, void* out, uint16_t len){
+    if (!ring || offset >= ev.len) return;
+    if (len > ev.len - offset) len = ev.len - offset;
+    ringGet(ring, capacity, ev.pos + offset, out, len);
+}
+
+SessionRecorder::Stats SessionRecorder::stats(){
+    Stats s = counters;
+    s.capacity = capacity;
+    s.used = head - tail;
+    return s;
+}
@@ -0,0 +1,68 @@
+#ifndef SESSION_RECORDER_H
+#define SESSION_RECORDER_H
+
+#include <Arduino.h>
+#include <libssh/libssh.h>
+
+#ifndef SSH_RECORD_BYTES
+#define SSH_RECORD_BYTES 16384      // ring size when recording is switched on
+#endif
+#ifndef SSH_RECORD_AT_BOOT
+#define SSH_RECORD_AT_BOOT 0
+#endif
+#ifndef SSH_RECORD_MAX_PAUSED
+#define SSH_RECORD_MAX_PAUSED 4     // channels paused at once; one per channel (SSH_MAX_CHANNELS)
+#endif
+
+// Audit trail of terminal sessions: channel input and output are teed into
+// a RAM ring as timestamped events (asciinema v2 "i"/"o"/"m"), oldest
+// events overwritten first. Bytes go straight from the caller's buffer into
+// the ring, one copy, no formatting on the write path; when recording is off
+// the tee is a single pointer test. No locking: the network task and the
+// channel worker tasks record and read, but ChannelScheduler runs only one
+// of them at a time.
+class SessionRecorder {
+public:
+    struct Event {
+        uint32_t ms;        // millis() when recorded
+        char type;          // 'i' input, 'o' output, 'm' marker
+        uint16_t len;
+        uint32_t pos;       // ring offset of the data, for read()
+    };
+    struct Stats {
+        uint32_t capacity, used;
+        uint32_t events, bytes;     // since enable()/clear()
+        uint32_t overwritten;       // events dropped to make room
+        uint64_t cycles;            // CPU cycles spent in the tee
+    };
+
+    static bool enable(size_t bytes = SSH_RECORD_BYTES);
+    static void disable();
+    static bool enabled() { return ring != nullptr; }
+    static void clear();
+    // Keep `ch` out of the recording (an RPC channel, or one the ring is
+    // being replayed to); the session's other channels go on recording.
+    static void setPaused(ssh_channel ch, bool paused);
+    static bool isPaused(ssh_channel ch);
+
+    static inline void output(ssh_channel ch, const void* data, size_t len) { if (ring && (!nPaused || !isPaused(ch))) record('o', data, len); }
+    static inline void input(ssh_channel ch, const void* data, size_t len) { if (ring && (!nPaused || !isPaused(ch))) record('i', data, len); }
+    static void marker(const char* label);
+
+    // Walk events oldest first: start with cursor = 0.
+    static bool next(uint32_t& cursor, Event& ev);
+    // Copy `len` data bytes of `ev` starting at `offset` into `out`.
+    static void read(const Event& ev, uint16_t offset, void* out, uint16_t len);
+    static Stats stats();
+
+private:
+    static uint8_t* ring;
+    static uint32_t capacity;
+    static uint32_t head, tail;     // monotonic byte offsets
+    static ssh_channel paused[SSH_RECORD_MAX_PAUSED];
+    static uint8_t nPaused;
+    static Stats counters;
+    static void record(char type, const void* data, size_t len);
+};
+
+#endif // SESSION_RECORDER_H
@@ -0,0 +1,183 @@
+#include "RpcServer.h"
+#include "SshChannelIo.h"
+#include "Blinker.h"
+#include "GpioDriver.h"
+#include "AllocTracker.h"
+#include "Logger.h"
+#include "SessionRecorder.h"
+#include <Arduino.h>
+#include <string.h>
+
+static const size_t RPC_HEADER = 9; // len + id + method/status
+
+// Bounded output cursor for one response body.
+struct RpcOut {
+    uint8_t* p;
+    size_t len;
+    size_t cap;
+    bool put(const void* data, size_t n){
+        if (len + n > cap) return false;
+        memcpy(p + len, data, n);
+        len += n;
+        return true;
+    }
+    bool put8(uint8_t v){ return put(&v, 1); }
+    bool put32(uint32_t v){
+        uint8_t b[4] = { (uint8_t)(v >> 24), (uint8_t)(v >> 16), (uint8_t)(v >> 8), (uint8_t)v };
+        return put(b, 4);
+    }
+    bool put64(uint64_t v){ return put32((uint32_t)(v >> 32)) && put32((uint32_t)v); }
+};
+
+static uint32_t get32(const uint8_t* b){
+    return ((uint32_t)b[0] << 24) | ((uint32_t)b[1] << 16) | ((uint32_t)b[2] << 8) | b[3];
+}
+
+static uint64_t get64(const uint8_t* b){
+    return ((uint64_t)get32(b) << 32) | get32(b + 4);
+}
+
+static void set32(uint8_t* b, uint32_t v){
+    b[0] = (uint8_t)(v >> 24); b[1] = (uint8_t)(v >> 16); b[2] = (uint8_t)(v >> 8); b[3] = (uint8_t)v;
+}
+
+typedef RpcStatus (*RpcHandler)(const uint8_t* args, size_t len, RpcOut& out, const SshServerStats& stats);
+
+static RpcStatus rpcPing(const uint8_t* args, size_t len, RpcOut& out, const SshServerStats&){
+    return out.put(args, len) ? RPC_OK : RPC_FAILED;
+}
+
+static RpcStatus rpcSysInfo(const uint8_t*, size_t len, RpcOut& out, const SshServerStats&){
+    if (len) return RPC_BAD_ARGS;
+    out.put32(millis());
+    out.put32(ESP.getFreeHeap());
+    out.put32(ESP.getMinFreeHeap());
+    out.put32(ESP.getMaxAllocHeap());
+    return RPC_OK;
+}
+
+static RpcStatus rpcSrvStats(const uint8_t*, size_t len, RpcOut& out, const SshServerStats& st){
+    if (len) return RPC_BAD_ARGS;
+    out.put32(st.accepted);
+    out.put32(st.acceptFailed);
+    out.put32(st.kexFailed);
+    out.put32(st.authFailed);
+    out.put32(st.dropped);
+    out.put32(st.completed);
+    return RPC_OK;
+}
+
+static RpcStatus rpcLedSet(const uint8_t* args, size_t len, RpcOut&, const SshServerStats&){
+    if (len != 1) return RPC_BAD_ARGS;
+    ledBlinker.set(args[0] != 0);
+    return RPC_OK;
+}
+
+static RpcStatus rpcLedBlink(const uint8_t* args, size_t len, RpcOut& out, const SshServerStats&){
+    if (len != 4) return RPC_BAD_ARGS;
+    uint32_t mhz = get32(args);
+    if (mhz == 0){
+        ledBlinker.set(false);
+    } else if (!ledBlinker.start(mhz / 1000.0f)){
+        return RPC_FAILED;
+    }
+    out.put32((uint32_t)(ledBlinker.frequency() * 1000.0f + 0.5f));
+    return RPC_OK;
+}
+
+static RpcStatus rpcLedGet(const uint8_t*, size_t len, RpcOut& out, const SshServerStats&){
+    if (len) return RPC_BAD_ARGS;
+    out.put8(ledBlinker.ledOn());
+    out.put8(ledBlinker.blinking());
+    out.put32((uint32_t)(ledBlinker.frequency() * 1000.0f + 0.5f));
+    return RPC_OK;
+}
+
+static RpcStatus rpcGpioOutput(const uint8_t* args, size_t len, RpcOut&, const SshServerStats&){
+    if (len != 8) return RPC_BAD_ARGS;
+    return gpioDriver.configureOutputs(get64(args)) ? RPC_OK : RPC_BAD_ARGS;
+}
+
+static RpcStatus rpcGpioWrite(const uint8_t* args, size_t len, RpcOut&, const SshServerStats&){
+    if (len != 16) return RPC_BAD_ARGS;
+    gpioDriver.write(get64(args), get64(args + 8));
+    return RPC_OK;
+}
+
+static RpcStatus rpcGpioRead(const uint8_t*, size_t len, RpcOut& out, const SshServerStats&){
+    if (len) return RPC_BAD_ARGS;
+    out.put64(gpioDriver.read());
+    out.put64(gpioDriver.outputs());
+    return RPC_OK;
+}
+
+static const RpcHandler HANDLERS[RPC_METHOD_COUNT] = {
+    rpcPing, rpcSysInfo, rpcSrvStats, rpcLedSet, rpcLedBlink, rpcLedGet,
+    rpcGpioOutput, rpcGpioWrite, rpcGpioRead,
+};
+
+void runRpcSubsystem(ssh_channel ch, const SshServerStats& stats){
+    AllocScope appScope(ALLOC_APP);
+    // Binary frames are not terminal traffic; keep this channel out of the
+    // recording.
+    SessionRecorder::marker("rpc subsystem (not recorded)");
+    SessionRecorder::setPaused(ch, true);
+    static uint8_t in[RPC_IN_BUF];
+    static uint8_t out[RPC_OUT_BUF];
+    size_t inLen = 0, outLen = 0;
+    uint32_t calls = 0, errors = 0;
+    const char* why = "client closed";
+
+    while (ssh_channel_is_open(ch) && !ssh_channel_is_eof(ch)){
+        int r = ssh_read_nonblocking(ch, in + inLen, sizeof(in) - inLen);
+        if (r < 0) break;
+        inLen += r;
+
+        // Dispatch every complete frame; responses accumulate in `out`.
+        size_t pos = 0;
+        bool broken = false;
+        while (inLen - pos >= 4){
+            uint32_t len = get32(in + pos);
+            if (len < RPC_HEADER - 4 || len > RPC_MAX_FRAME){
+                broken = true;
+                break;
+            }
+            if (inLen - pos - 4 < len) break;
+            if (sizeof(out) - outLen < RPC_MAX_FRAME + 4){
+                ssh_channel_write(ch, out, outLen);
+                outLen = 0;
+            }
+            const uint8_t* req = in + pos + 4;
+            uint8_t method = req[4];
+            RpcOut body = { out + outLen + RPC_HEADER, 0, RPC_MAX_FRAME - (RPC_HEADER - 4) };
+            RpcStatus status = method < RPC_METHOD_COUNT
+                ? HANDLERS[method](req + 5, len - 5, body, stats) : RPC_BAD_METHOD;
+            if (status != RPC_OK){
+                body.len = 0;
+                errors++;
+            }
+            set32(out + outLen, (uint32_t)(body.len + RPC_HEADER - 4));
+            memcpy(out + outLen + 4, req, 4); // request id, echoed verbatim
+            out[outLen + 8] = status;
+            outLen += RPC_HEADER + body.len;
+            pos += 4 + len;
+            calls++;
+        }
+        if (broken){
+            why = "bad frame length";
+            break;
+        }
+        memmove(in, in + pos, inLen - pos);
+        inLen -= pos;
+
+        // Coalesce replies while the client keeps the pipe full.
+        if (outLen && ssh_channel_poll(ch, 0) <= 0){
+            ssh_channel_write(ch, out, outLen);
+            outLen = 0;
+        }
+        if (r == 0) ssh_channel_wait(ch, 1000);
+    }
+    if (outLen) ssh_channel_write(ch, out, outLen);
+    SessionRecorder::setPaused(ch, false);
+    LOGI("RPC", "Subsystem done (%s): %u calls, %u errors", why, (unsigned)calls, (unsigned)errors);
+}
@@ -0,0 +1,54 @@
+#ifndef RPC_SERVER_H
+#define RPC_SERVER_H
+
+#include <libssh/libssh.h>
+#include "SshServer.h"
+
+#define RPC_SUBSYSTEM "esp-rpc"
+
+#ifndef RPC_MAX_FRAME
+#define RPC_MAX_FRAME 512   // largest request/response body (id + method/status + data)
+#endif
+#ifndef RPC_IN_BUF
+#define RPC_IN_BUF 2048
+#endif
+#ifndef RPC_OUT_BUF
+#define RPC_OUT_BUF 2048
+#endif
+
+// Wire format, all integers big-endian:
+//   request:  u32 len | u32 id | u8 method | args
+//   response: u32 len | u32 id | u8 status | result
+// `len` counts everything after itself. Requests may be pipelined; responses
+// come back in request order, several per channel write.
+//
+//   method           args               result
+//   RPC_PING         any bytes          the same bytes
+//   RPC_SYS_INFO     -                  u32 uptime_ms, free_heap, min_free_heap, largest_block
+//   RPC_SRV_STATS    -                  u32 accepted, accept_failed, kex_failed, auth_failed, dropped, completed
+//   RPC_LED_SET      u8 on              -
+//   RPC_LED_BLINK    u32 millihertz     u32 applied millihertz
+//   RPC_LED_GET      -                  u8 on, u8 blinking, u32 millihertz
+//   RPC_GPIO_OUTPUT  u64 pin mask       -   (configure as outputs)
+//   RPC_GPIO_WRITE   u64 set, u64 clear -   (one batched register write)
+//   RPC_GPIO_READ    -                  u64 input levels, u64 output levels
+enum RpcMethod : uint8_t {
+    RPC_PING = 0,
+    RPC_SYS_INFO,
+    RPC_SRV_STATS,
+    RPC_LED_SET,
+    RPC_LED_BLINK,
+    RPC_LED_GET,
+    RPC_GPIO_OUTPUT,
+    RPC_GPIO_WRITE,
+    RPC_GPIO_READ,
+    RPC_METHOD_COUNT
+};
+
+enum RpcStatus : uint8_t { RPC_OK = 0, RPC_BAD_METHOD, RPC_BAD_ARGS, RPC_FAILED };
+
+// Serve RPC frames on a channel that requested the RPC_SUBSYSTEM subsystem
+// until the client closes it or breaks framing.
+void runRpcSubsystem(ssh_channel ch, const SshServerStats& stats);
+
+#endif // RPC_SERVER_H
@@ -0,0 +1,232 @@
+#include "ScriptRunner.h"
+#include "Blinker.h"
+#include "GpioDriver.h"
+#include "CmdLine.h"
+#include <stdlib.h>
+#include <string.h>
+
+static bool parseUint(const char* s, uint32_t& out){
+    if (!s) return false;
+    char* end = nullptr;
+    unsigned long v = strtoul(s, &end, 0);
+    if (end == s || *end) return false;
+    out = (uint32_t)v;
+    return true;
+}
+
+bool ScriptProgram::compile(const char* src, char* err, size_t errLen){
+    nOps = 0;
+    source = src;
+    uint16_t openRepeats[SCRIPT_MAX_DEPTH];
+    uint8_t depth = 0;
+    uint16_t lineNo = 0;
+    const char* p = src;
+    auto fail = [&](const char* what){
+        snprintf(err, errLen, "line %u: %s", (unsigned)lineNo, what);
+        return false;
+    };
+    while (*p){
+        const char* eol = strchr(p, '\n');
+        size_t len = eol ? (size_t)(eol - p) : strlen(p);
+        const char* lineStart = p;
+        p = eol ? eol + 1 : p + len;
+        lineNo++;
+
+        char line[96];
+        if (len >= sizeof(line)) return fail("line too long");
+        memcpy(line, lineStart, len);
+        line[len] = '\0';
+        char* hash = strchr(line, '#');
+        if (hash) *hash = '\0';
+        char* argv[CMD_MAX_ARGS];
+        int argc = cmdTokenize(line, argv, CMD_MAX_ARGS);
+        if (argc < 0) return fail("unbalanced quotes or too many words");
+        if (argc == 0) continue;
+        const char* cmd = argv[0];
+        const char* a1 = argc > 1 ? argv[1] : nullptr;
+        const char* a2 = argc > 2 ? argv[2] : nullptr;
+        if (nOps >= SCRIPT_MAX_OPS) return fail("too many instructions");
+
+        ScriptOp& op = ops[nOps];
+        memset(&op, 0, sizeof(op));
+        op.line = lineNo;
+        if (!strcmp(cmd, "led")){
+            if (!a1 || (strcmp(a1, "on") && strcmp(a1, "off"))) return fail("led on|off");
+            op.code = SOP_LED;
+            op.arg = !strcmp(a1, "on");
+        } else if (!strcmp(cmd, "blink")){
+            BlinkArgs blink = { 0.0f, 50 };
+            char why[64];
+            if (!blinkParseArgs(argc, argv, blink, why, sizeof(why))) return fail(why);
+            if (blink.hz <= 0.0f) return fail("blink [--hz] <hz> [--duty <pct>]");
+            op.code = SOP_BLINK;
+            op.arg = (uint32_t)(blink.hz * 1000.0f + 0.5f);
+            op.value = blink.duty;
+        } else if (!strcmp(cmd, "sleep")){
+            if (!parseUint(a1, op.arg)) return fail("sleep <ms>");
+            op.code = SOP_SLEEP;
+        } else if (!strcmp(cmd, "gpio")){
+            if (a1 && !strcmp(a1, "read")){
+                op.code = SOP_GPIO_READ;
+            } else if (!a1 || !gpioParsePins(a2, op.mask)){
+                return fail("gpio out|set|clr <pins> | write <pins> <value> | read");
+            } else if (!strcmp(a1, "out")){
+                op.code = SOP_GPIO_OUT;
+            } else if (!strcmp(a1, "set")){
+                op.code = SOP_GPIO_WRITE;
+                op.value = op.mask;
+            } else if (!strcmp(a1, "clr")){
+                op.code = SOP_GPIO_WRITE;
+            } else if (!strcmp(a1, "write")){
+                const char* v = argc > 3 ? argv[3] : nullptr;
+                if (!v) return fail("gpio write <pins> <value>");
+                op.code = SOP_GPIO_WRITE;
+                op.value = strtoull(v, nullptr, 0);
+            } else {
+                return fail("unknown gpio operation");
+            }
+        } else if (!strcmp(cmd, "echo")){
+            // Text is the source line from argv[1] on, as typed. cmdTokenize()
+            // compacts `line` in place, so argv[1] is found again in the
+            // source: past the command word, which has no quoted blanks since
+            // it came out as "echo", and the blanks after it.
+            size_t at = strspn(lineStart, " \t");
+            at += strcspn(lineStart + at, " \t\r\n");
+            at += strspn(lineStart + at, " \t");
+            if (!a1 || at > len) at = len;
+            op.code = SOP_ECHO;
+            op.arg = (uint32_t)(lineStart + at - src);
+        } else if (!strcmp(cmd, "repeat")){
+            if (!parseUint(a1, op.arg)) return fail("repeat <count>");
+            if (depth >= SCRIPT_MAX_DEPTH) return fail("repeat nested too deep");
+            op.code = SOP_REPEAT;
+            openRepeats[depth++] = nOps;
+        } else if (!strcmp(cmd, "end")){
+            if (!depth) return fail("end without repeat");
+            op.code = SOP_END;
+            op.target = openRepeats[--depth];
+            ops[op.target].target = nOps + 1;
+        } else {
+            return fail("unknown command");
+        }
+        nOps++;
+    }
+    lineNo++;
+    if (depth) return fail("repeat without end");
+    return true;
+}
+
+// True once the user typed "stop" or the channel went away.
+static bool stopRequested(ssh_channel ch, SshLineReader& reader){
+    if (reader.poll(ch) && !strcmp(reader.line(), "stop")) return true;
+    return !ssh_channel_is_open(ch) || ssh_channel_is_eof(ch);
+}
+
+// Wait until `dueUs`, watching for "stop". Coarse part through the reactor,
+// the last SCRIPT_SPIN_US spinning.
+static bool waitUntil(ssh_channel ch, SshLineReader& reader, int64_t dueUs){
+    for (;;){
+        if (stopRequested(ch, reader)) return false;
+        int64_t left = dueUs - esp_timer_get_time();
+        if (left <= SCRIPT_SPIN_US) break;
+        reader.wait(ch, (int)((left - SCRIPT_SPIN_US) / 1000) + 1);
+    }
+    while (esp_timer_get_time() < dueUs) {}
+    return true;
+}
+
+bool ScriptProgram::run(ssh_channel ch, SshLineReader& reader){
+    memset(timing, 0, sizeof(timing));
+    uint32_t counters[SCRIPT_MAX_DEPTH];
+    uint8_t depth = 0;
+    uint32_t executed = 0;
+    uint32_t sinceYield = 0;
+    bool completed = true;
+    const char* why = "Done";
+    char msg[112];
+
+    int64_t start = esp_timer_get_time();
+    int64_t due = start;
+    for (uint16_t pc = 0; pc < nOps; ){
+        if (executed >= SCRIPT_MAX_STEPS){
+            why = "Step limit reached";
+            completed = false;
+            break;
+        }
+        // A loop without sleeps never reaches waitUntil(): look for "stop"
+        // here, and block for a tick so lower-priority tasks (idle and its
+        // watchdog included) run; taskYIELD() would not let them.
+        if (++sinceYield >= SCRIPT_CHECK_OPS){
+            sinceYield = 0;
+            if (stopRequested(ch, reader)){
+                why = "Stopped";
+                completed = false;
+                break;
+            }
+            vTaskDelay(1);
+        }
+        const ScriptOp& op = ops[pc];
+        int64_t now = esp_timer_get_time();
+        uint32_t late = now > due ? (uint32_t)(now - due) : 0;
+        LineTiming& t = timing[pc];
+        t.count++;
+        t.sumLateUs += late;
+        if (late > t.maxLateUs) t.maxLateUs = late;
+        executed++;
+        pc++;
+        switch (op.code){
+            case SOP_LED: ledBlinker.set(op.arg != 0); break;
+            case SOP_BLINK: ledBlinker.start(op.arg / 1000.0f, (uint8_t)op.value); break;
+            case SOP_GPIO_OUT: gpioDriver.configureOutputs(op.mask); break;
+            case SOP_GPIO_WRITE: gpioDriver.write(op.mask & op.value, op.mask & ~op.value); break;
+            case SOP_GPIO_READ:
+                snprintf(msg, sizeof(msg), "[%8lu us] gpio in=0x%010llx", (unsigned long)(now - start),
+                         (unsigned long long)gpioDriver.read());
+                ssh_write_line(ch, msg);
+                break;
+            case SOP_ECHO: {
+                const char* text = source + op.arg;
+                size_t n = strcspn(text, "\r\n#");
+                while (n && (text[n - 1] == ' ' || text[n - 1] == '\t')) n--;
+                int w = snprintf(msg, sizeof(msg), "[%8lu us] ", (unsigned long)(now - start));
+                ssh_write(ch, msg, w);
+                ssh_write(ch, text, n);
+                ssh_write(ch, "\r\n", 2);
+                break;
+            }
+            case SOP_SLEEP:
+                due += (int64_t)op.arg * 1000;
+                sinceYield = 0;
+                if (!waitUntil(ch, reader, due)){
+                    why = "Stopped";
+                    completed = false;
+                    pc = nOps;
+                }
+                continue; // the next op is scheduled at `due`
+            case SOP_REPEAT:
+                if (op.arg == 0) pc = op.target;
+                else counters[depth++] = op.arg;
+                break;
+            case SOP_END:
+                if (--counters[depth - 1] > 0) pc = op.target + 1;
+                else depth--;
+                break;
+        }
+    }
+
+    int64_t total = esp_timer_get_time() - start;
+    snprintf(msg, sizeof(msg), "%s after %lu us, %u steps. Per line: runs, mean/max late us",
+             why, (unsigned long)total, (unsigned)executed);
+    ssh_write_line(ch, msg);
+    for (uint16_t i = 0; i < nOps; i++){
+        const LineTiming& t = timing[i];
+        if (!t.count) continue;
+        snprintf(msg, sizeof(msg), "  line %3u  runs %5u  late %6u / %6u", (unsigned)ops[i].line, (unsigned)t.count,
+                 (unsigned)(t.sumLateUs / t.count), (unsigned)t.maxLateUs);
+        ssh_write_line(ch, msg);
+    }
+    snprintf(msg, sizeof(msg), "RESULT test=script steps=%u total_us=%lu completed=%d",
+             (unsigned)executed, (unsigned long)total, completed ? 1 : 0);
+    ssh_write_line(ch, msg);
+    return completed;
+}
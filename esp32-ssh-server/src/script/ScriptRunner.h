@@ -0,0 +1,81 @@
+#ifndef SCRIPT_RUNNER_H
+#define SCRIPT_RUNNER_H
+
+#include <Arduino.h>
+#include <libssh/libssh.h>
+#include "SshChannelIo.h"
+
+#ifndef SCRIPT_MAX_OPS
+#define SCRIPT_MAX_OPS 64
+#endif
+#ifndef SCRIPT_MAX_SOURCE
+#define SCRIPT_MAX_SOURCE 1024
+#endif
+#ifndef SCRIPT_MAX_DEPTH
+#define SCRIPT_MAX_DEPTH 4          // nested repeat blocks
+#endif
+#ifndef SCRIPT_SPIN_US
+#define SCRIPT_SPIN_US 2000         // busy-wait the tail of each sleep for sub-ms accuracy
+#endif
+#ifndef SCRIPT_CHECK_OPS
+#define SCRIPT_CHECK_OPS 256        // ops without a sleep between "stop" checks and yields
+#endif
+#ifndef SCRIPT_MAX_STEPS
+#define SCRIPT_MAX_STEPS 1000000UL  // instructions executed per run before it is stopped
+#endif
+
+enum ScriptOpCode : uint8_t {
+    SOP_LED,        // arg: 0/1
+    SOP_BLINK,      // arg: millihertz, value: duty percent
+    SOP_GPIO_OUT,   // mask
+    SOP_GPIO_WRITE, // mask, value
+    SOP_GPIO_READ,
+    SOP_SLEEP,      // arg: ms
+    SOP_REPEAT,     // arg: count, target: index after the matching end
+    SOP_END,        // target: index of the matching repeat
+    SOP_ECHO,       // arg: offset of the text in the source
+};
+
+struct ScriptOp {
+    uint8_t code;
+    uint16_t line;      // 1-based source line, for reports
+    uint16_t target;
+    uint32_t arg;
+    uint64_t mask;
+    uint64_t value;
+};
+
+// Line-oriented script compiled once into a flat instruction list:
+//
+//   led on|off           blink [--hz] <hz> [--duty <pct>]      sleep <ms>
+//   gpio out <pins>      gpio set|clr <pins> gpio write <pins> <value>
+//   gpio read            echo <text>         repeat <n> ... end
+//
+// '#' starts a comment. Sleeps are scheduled against the start of the run,
+// so per-step overhead does not accumulate as drift.
+class ScriptProgram {
+public:
+    // Compile `source` (kept by reference for echo text; must stay valid).
+    // On failure returns false and describes the first error in `err`.
+    bool compile(const char* source, char* err, size_t errLen);
+    // Execute on the session channel; a "stop" line aborts, and so does
+    // reaching SCRIPT_MAX_STEPS. Ends with a per-line timing report. Returns
+    // false if stopped or the channel closed.
+    bool run(ssh_channel ch, SshLineReader& reader);
+    uint16_t size() const { return nOps; }
+
+private:
+    // Per-instruction timing gathered during a run.
+    struct LineTiming {
+        uint32_t count;
+        uint32_t maxLateUs;   // op start vs. its scheduled time
+        uint64_t sumLateUs;
+    };
+
+    ScriptOp ops[SCRIPT_MAX_OPS];
+    LineTiming timing[SCRIPT_MAX_OPS];
+    uint16_t nOps = 0;
+    const char* source = nullptr;
+};
+
+#endif // SCRIPT_RUNNER_H
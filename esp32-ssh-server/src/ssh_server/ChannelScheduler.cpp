@@ -0,0 +1,296 @@
+#include "ChannelScheduler.h"
+#include "Reactor.h"
+#include "SessionRecorder.h"
+#include "Tracer.h"
+#include "MemoryBudget.h"
+#include "Logger.h"
+#include <lwip/sockets.h>
+#include <string.h>
+
+ChannelScheduler* ChannelScheduler::current = nullptr;
+
+ChannelScheduler::ChannelScheduler(ssh_session sess, const char* subsystem, ChannelMain main, void* ctx)
+    : sess(sess), subsystemName(subsystem), main(main), ctx(ctx) {}
+
+void ChannelScheduler::begin(ssh_channel first) {
+    schedTask = xTaskGetCurrentTaskHandle();
+    slots[0].ch = first;
+    slots[0].state = RUNNING;
+    slots[0].owner = this;
+    nOpened = nMaxLive = 1;
+    current = this;
+    // Anything queued before this point is replayed through the callback by
+    // the first ssh_execute_message_callbacks().
+    ssh_set_message_callback(sess, onMessage, this);
+}
+
+ChannelScheduler::Slot* ChannelScheduler::slotFor(ssh_channel ch) {
+    for (uint8_t i = 0; i < SSH_MAX_CHANNELS; i++) {
+        if (slots[i].state != FREE && slots[i].ch == ch) return &slots[i];
+    }
+    return nullptr;
+}
+
+uint8_t ChannelScheduler::live() const {
+    uint8_t n = 0;
+    for (uint8_t i = 0; i < SSH_MAX_CHANNELS; i++) n += slots[i].state != FREE;
+    return n;
+}
+
+uint32_t ChannelScheduler::wait(ssh_channel ch, int timeoutMs, const int* fds, uint8_t nFds) {
+    Slot* s = slotFor(ch);
+    if (!s) return 0;
+    // Every app parks here between reads, with its buffers at their largest.
+    MemoryBudget::sample();
+    s->forever = timeoutMs < 0;
+    s->deadline = millis() + (timeoutMs < 0 ? 0 : timeoutMs);
+    s->nFds = nFds < SSH_CHANNEL_WAIT_FDS ? nFds : SSH_CHANNEL_WAIT_FDS;
+    for (uint8_t i = 0; i < s->nFds; i++) s->fds[i] = fds[i];
+    s->ready = 0;
+    s->state = WAITING;
+    if (s->task) {
+        // Hand the session back to the scheduler until it resumes us.
+        xTaskNotifyGive(schedTask);
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    } else {
+        schedule(s);
+    }
+    return s->ready;
+}
+
+int64_t ChannelScheduler::takeInputReady(ssh_channel ch) {
+    Slot* s = slotFor(ch);
+    if (!s) return 0;
+    int64_t t = s->inputReadyUs;
+    s->inputReadyUs = 0;
+    return t;
+}
+
+void ChannelScheduler::finish() {
+    // The client waits for the first channel to close before it exits, so do
+    // not hold it open while other channels or the linger time run.
+    if (slots[0].ch) ssh_channel_close(slots[0].ch);
+    slots[0] = Slot();
+    lingerStart = millis();
+    schedule(nullptr);
+    ssh_set_message_callback(sess, nullptr, nullptr);
+    current = nullptr;
+    LOGI("SSH", "Channels: %u opened, %u at once", (unsigned)nOpened, (unsigned)nMaxLive);
+}
+
+// Runs until `self` (a channel on the calling task) may continue, or with
+// self == nullptr until every channel is done and the linger time passed.
+void ChannelScheduler::schedule(Slot* self) {
+    for (;;) {
+        startPending();
+        for (uint8_t i = 0; i < SSH_MAX_CHANNELS; i++) {
+            if (slots[i].task && slots[i].state == RUNNABLE) resume(slots[i]);
+        }
+        reap();
+        markReady(nullptr, 0, 0);
+        if (self) {
+            if (self->state == RUNNABLE) {
+                self->state = RUNNING;
+                return;
+            }
+        } else if (!live() && (!ssh_is_connected(sess) ||
+                               (int32_t)(millis() - lingerStart) >= SSH_SESSION_LINGER_MS)) {
+            return;
+        }
+        bool runnable = false;
+        for (uint8_t i = 0; i < SSH_MAX_CHANNELS; i++) runnable |= slots[i].state == RUNNABLE || slots[i].state == STARTING;
+        if (runnable) continue;
+
+        // Session socket first, then every waiting channel's own descriptors.
+        int fds[1 + SSH_MAX_CHANNELS * SSH_CHANNEL_WAIT_FDS];
+        uint8_t n = 0;
+        fds[n++] = ssh_get_fd(sess);
+        for (uint8_t i = 0; i < SSH_MAX_CHANNELS; i++) {
+            Slot& s = slots[i];
+            if (s.state != WAITING) continue;
+            for (uint8_t j = 0; j < s.nFds; j++) fds[n++] = s.fds[j];
+        }
+        int timeoutMs = nextTimeout(millis());
+        uint32_t mask = 0;
+        Reactor* r = Reactor::active();
+        if (r) {
+            mask = r->poll(timeoutMs, fds, n);
+        } else {
+            fd_set rfds;
+            FD_ZERO(&rfds);
+            int maxFd = -1;
+            for (uint8_t i = 0; i < n; i++) {
+                if (fds[i] < 0) continue;
+                FD_SET(fds[i], &rfds);
+                if (fds[i] > maxFd) maxFd = fds[i];
+            }
+            struct timeval tv = { timeoutMs / 1000, (timeoutMs % 1000) * 1000 };
+            if (select(maxFd + 1, &rfds, nullptr, nullptr, timeoutMs < 0 ? nullptr : &tv) > 0) {
+                for (uint8_t i = 0; i < n; i++) if (fds[i] >= 0 && FD_ISSET(fds[i], &rfds)) mask |= 1UL << i;
+            }
+        }
+        int64_t readyUs = (mask & 1) ? esp_timer_get_time() : 0;
+        // Reads pending packets into the channels and runs onMessage().
+        ssh_execute_message_callbacks(sess);
+        markReady(fds, mask, readyUs);
+    }
+}
+
+// Start a task for every channel whose shell/subsystem request was accepted.
+void ChannelScheduler::startPending() {
+    for (uint8_t i = 1; i < SSH_MAX_CHANNELS; i++) {
+        Slot& s = slots[i];
+        if (s.state != STARTING) continue;
+        char name[12];
+        snprintf(name, sizeof(name), "ssh-ch%u", (unsigned)i);
+        s.owner = this;
+        s.state = RUNNABLE;
+        if (xTaskCreatePinnedToCore(workerMain, name, SSH_CHANNEL_STACK, &s, uxTaskPriorityGet(nullptr),
+                                    &s.task, xPortGetCoreID()) != pdPASS) {
+            LOGW("SSH", "No memory for channel %u task", (unsigned)i);
+            ssh_channel_close(s.ch);
+            ssh_channel_free(s.ch);
+            s = Slot();
+            continue;
+        }
+        TRACE_INSTANT("ch_start", i);
+        uint8_t n = live();
+        if (n > nMaxLive) nMaxLive = n;
+        LOGI("SSH", "Channel %u: %s (%u open)", (unsigned)i, s.subsystem ? subsystemName : "shell", (unsigned)n);
+        if (SessionRecorder::enabled()) {
+            char label[40];
+            snprintf(label, sizeof(label), "channel %u %s", (unsigned)i, s.subsystem ? subsystemName : "shell");
+            SessionRecorder::marker(label);
+        }
+    }
+}
+
+void ChannelScheduler::resume(Slot& s) {
+    s.state = RUNNING;
+    xTaskNotifyGive(s.task);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+}
+
+void ChannelScheduler::workerMain(void* arg) {
+    Slot* s = (Slot*)arg;
+    ChannelScheduler* self = s->owner;
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    self->main(s->ch, s->subsystem, self->ctx);
+    s->state = DONE;
+    // The slot may be reused as soon as the scheduler runs; touch nothing after this.
+    TaskHandle_t sched = self->schedTask;
+    xTaskNotifyGive(sched);
+    vTaskDelete(nullptr);
+}
+
+// Release finished channels and ones the client closed before starting them.
+void ChannelScheduler::reap() {
+    for (uint8_t i = 1; i < SSH_MAX_CHANNELS; i++) {
+        Slot& s = slots[i];
+        bool abandoned = s.state == OPENED && !ssh_channel_is_open(s.ch);
+        if (s.state != DONE && !abandoned) continue;
+        TRACE_INSTANT("ch_done", i);
+        ssh_channel_close(s.ch);
+        ssh_channel_free(s.ch);
+        s = Slot();
+        if (!live()) lingerStart = millis();
+    }
+}
+
+int ChannelScheduler::nextTimeout(uint32_t now) const {
+    int next = -1;
+    for (uint8_t i = 0; i < SSH_MAX_CHANNELS; i++) {
+        const Slot& s = slots[i];
+        if (s.state != WAITING || s.forever) continue;
+        int due = (int)(int32_t)(s.deadline - now);
+        if (due < 0) due = 0;
+        if (next < 0 || due < next) next = due;
+    }
+    if (!live()) {
+        int due = (int)(int32_t)(lingerStart + SSH_SESSION_LINGER_MS - now);
+        if (due < 0) due = 0;
+        if (next < 0 || due < next) next = due;
+    }
+    return next;
+}
+
+// fds/mask as passed to poll(); each waiting channel's descriptors follow the
+// session socket in slot order. readyUs, when the session socket was
+// readable, stamps the channels that have input now.
+void ChannelScheduler::markReady(const int* fds, uint32_t mask, int64_t readyUs) {
+    uint32_t now = millis();
+    uint8_t bit = 1;
+    for (uint8_t i = 0; i < SSH_MAX_CHANNELS; i++) {
+        Slot& s = slots[i];
+        if (s.state != WAITING) continue;
+        if (fds) {
+            for (uint8_t j = 0; j < s.nFds; j++, bit++) {
+                if (mask & (1UL << bit)) s.ready |= 1UL << j;
+            }
+        }
+        int avail = ssh_channel_poll(s.ch, 0);
+        if (readyUs && avail > 0 && !s.inputReadyUs) s.inputReadyUs = readyUs;
+        if (s.ready || avail != 0 || !ssh_channel_is_open(s.ch) ||
+            (!s.forever && (int32_t)(now - s.deadline) >= 0)) {
+            s.state = RUNNABLE;
+        }
+    }
+}
+
+// Channel messages after the first shell: new session channels and their
+// pty/env/shell/subsystem requests. Returning 1 makes libssh send the
+// default (failure) reply.
+int ChannelScheduler::onMessage(ssh_session, ssh_message m, void* userdata) {
+    ChannelScheduler* self = (ChannelScheduler*)userdata;
+    int type = ssh_message_type(m);
+    int subtype = ssh_message_subtype(m);
+    if (type == SSH_REQUEST_CHANNEL_OPEN && subtype == SSH_CHANNEL_SESSION) {
+        Slot* s = nullptr;
+        for (uint8_t i = 1; i < SSH_MAX_CHANNELS && !s; i++) {
+            if (self->slots[i].state == FREE) s = &self->slots[i];
+        }
+        if (!s) {
+            LOGW("SSH", "Channel refused: %u already open", (unsigned)SSH_MAX_CHANNELS);
+            return 1;
+        }
+        // Each extra channel costs a task stack plus its app's buffers.
+        if (!MemoryBudget::canAfford(SSH_CHANNEL_STACK + SSH_HEAP_SHED_MARGIN)) {
+            MemoryBudget::noteRefused();
+            LOGW("SSH", "Channel refused: heap low");
+            return 1;
+        }
+        ssh_channel ch = ssh_message_channel_request_open_reply_accept(m);
+        if (!ch) return 0;
+        *s = Slot();
+        s->ch = ch;
+        s->state = OPENED;
+        self->nOpened++;
+        return 0;
+    }
+    if (type != SSH_REQUEST_CHANNEL) return 1;
+    Slot* s = self->slotFor(ssh_message_channel_request_channel(m));
+    if (!s) return 1;
+    switch (subtype) {
+    case SSH_CHANNEL_REQUEST_PTY:
+    case SSH_CHANNEL_REQUEST_ENV:
+    case SSH_CHANNEL_REQUEST_WINDOW_CHANGE:
+        ssh_message_channel_request_reply_success(m);
+        return 0;
+    case SSH_CHANNEL_REQUEST_SHELL:
+        if (s->state != OPENED) return 1;
+        ssh_message_channel_request_reply_success(m);
+        s->subsystem = false;
+        s->state = STARTING;
+        return 0;
+    case SSH_CHANNEL_REQUEST_SUBSYSTEM: {
+        const char* name = ssh_message_channel_request_subsystem(m);
+        if (s->state != OPENED || !name || strcmp(name, self->subsystemName)) return 1;
+        ssh_message_channel_request_reply_success(m);
+        s->subsystem = true;
+        s->state = STARTING;
+        return 0;
+    }
+    default:
+        return 1;
+    }
+}
@@ -0,0 +1,103 @@
+#ifndef CHANNEL_SCHEDULER_H
+#define CHANNEL_SCHEDULER_H
+
+#include <Arduino.h>
+#include <libssh/libssh.h>
+
+// Session channels served at once on one connection, first channel included.
+#ifndef SSH_MAX_CHANNELS
+#define SSH_MAX_CHANNELS 4
+#endif
+// Stack of the task behind each channel after the first.
+#ifndef SSH_CHANNEL_STACK
+#define SSH_CHANNEL_STACK 8192
+#endif
+// Extra descriptors one channel may wait on besides the session socket.
+#ifndef SSH_CHANNEL_WAIT_FDS
+#define SSH_CHANNEL_WAIT_FDS 2
+#endif
+// Keep the connection this long after its last channel closes, so a client
+// multiplexing over it (OpenSSH ControlMaster, paramiko) can open the next
+// channel without a new handshake.
+#ifndef SSH_SESSION_LINGER_MS
+#define SSH_SESSION_LINGER_MS 5000
+#endif
+
+// Runs several session channels of one SSH connection side by side, each with
+// its own app and line state. The first channel runs on the network task;
+// every further channel gets a task of its own, but only one of them runs at
+// a time: a channel runs until it waits for input (ssh_channel_wait), which
+// hands control back here. The scheduler then waits on the session socket
+// for all of them and resumes, round robin, the channels that have input or
+// whose timeout expired. Apps keep their blocking style and libssh is never
+// entered from two tasks at once.
+class ChannelScheduler {
+public:
+    // Serves one channel until it is done: a shell, or `subsystem` when the
+    // client asked for the subsystem this scheduler was created with.
+    typedef void (*ChannelMain)(ssh_channel ch, bool subsystem, void* ctx);
+
+    ChannelScheduler(ssh_session sess, const char* subsystem, ChannelMain main, void* ctx);
+
+    // Adopt the first channel, already past its shell/subsystem request, and
+    // handle channel messages from here on.
+    void begin(ssh_channel first);
+    // Park the calling channel until it may have input, one of `fds` is
+    // readable or timeoutMs (-1 = forever) passes; other channels run in the
+    // meantime. Bit i of the result is set when fds[i] became readable.
+    uint32_t wait(ssh_channel ch, int timeoutMs, const int* fds, uint8_t nFds);
+    // Called once the first channel's app returned: close that channel and
+    // serve the others until all have finished and the linger time passed.
+    void finish();
+
+    // esp_timer time at which the session socket turned readable with input
+    // for `ch` while it waited, and clear it; 0 if none.
+    int64_t takeInputReady(ssh_channel ch);
+
+    uint8_t opened() const { return nOpened; }
+    uint8_t maxConcurrent() const { return nMaxLive; }
+    // Channels open right now.
+    uint8_t live() const;
+
+    // Scheduler of the session being served, if any.
+    static ChannelScheduler* active() { return current; }
+
+private:
+    enum SlotState : uint8_t { FREE, OPENED, STARTING, RUNNABLE, RUNNING, WAITING, DONE };
+    struct Slot {
+        ssh_channel ch;
+        TaskHandle_t task;          // nullptr for the first channel
+        SlotState state;
+        bool subsystem;
+        bool forever;
+        uint32_t deadline;
+        int fds[SSH_CHANNEL_WAIT_FDS];
+        uint8_t nFds;
+        uint32_t ready;
+        int64_t inputReadyUs;
+        ChannelScheduler* owner;
+    };
+
+    ssh_session sess;
+    const char* subsystemName;
+    ChannelMain main;
+    void* ctx;
+    TaskHandle_t schedTask = nullptr;
+    Slot slots[SSH_MAX_CHANNELS] = {};
+    uint8_t nOpened = 0;
+    uint8_t nMaxLive = 0;
+    uint32_t lingerStart = 0;
+    static ChannelScheduler* current;
+
+    Slot* slotFor(ssh_channel ch);
+    void schedule(Slot* self);
+    void startPending();
+    void resume(Slot& s);
+    void reap();
+    int nextTimeout(uint32_t now) const;
+    void markReady(const int* fds, uint32_t mask, int64_t readyUs);
+    static int onMessage(ssh_session sess, ssh_message m, void* userdata);
+    static void workerMain(void* arg);
+};
+
+#endif // CHANNEL_SCHEDULER_H
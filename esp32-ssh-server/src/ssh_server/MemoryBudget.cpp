@@ -0,0 +1,88 @@
+#include "MemoryBudget.h"
+#include "AllocTracker.h"
+#include <esp_heap_caps.h>
+
+uint32_t MemoryBudget::estimate = SSH_SESSION_HEAP_COST;
+uint32_t MemoryBudget::recent[SSH_BUDGET_WINDOW] = {};
+uint8_t MemoryBudget::nextRecent = 0;
+uint32_t MemoryBudget::sessionFree = 0;
+uint32_t MemoryBudget::sessionLowest = 0;
+uint32_t MemoryBudget::minimumAtStart = 0;
+uint32_t MemoryBudget::kexPeak = 0;
+uint32_t MemoryBudget::nShed = 0;
+uint32_t MemoryBudget::nRefused = 0;
+
+BudgetLevel MemoryBudget::assess(uint32_t freeHeap, uint32_t largestBlock) {
+    uint32_t needed = estimate + SSH_HEAP_RESERVE;
+    if (freeHeap < needed || largestBlock < SSH_MIN_LARGEST_BLOCK) return BUDGET_CRITICAL;
+    if (freeHeap < needed + SSH_HEAP_SHED_MARGIN) return BUDGET_LOW;
+    return BUDGET_OK;
+}
+
+BudgetLevel MemoryBudget::assess() {
+    return assess(heap_caps_get_free_size(MALLOC_CAP_8BIT), heap_caps_get_largest_free_block(MALLOC_CAP_8BIT));
+}
+
+bool MemoryBudget::canAfford(uint32_t bytes) {
+    return heap_caps_get_free_size(MALLOC_CAP_8BIT) >= bytes + SSH_HEAP_RESERVE &&
+           heap_caps_get_largest_free_block(MALLOC_CAP_8BIT) >= bytes;
+}
+
+void MemoryBudget::sessionStarted() {
+    sessionFree = sessionLowest = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    minimumAtStart = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+}
+
+void MemoryBudget::sample() {
+    uint32_t low = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    // Key exchange scratch and packet bursts are freed again before the next
+    // sample; a new all-time minimum since the start shows how deep they went.
+    uint32_t minimum = heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT);
+    if (minimum < minimumAtStart && minimum < low) low = minimum;
+    if (low < sessionLowest) sessionLowest = low;
+}
+
+void MemoryBudget::handshakeDone() {
+    sample();
+    uint32_t took = sessionFree > sessionLowest ? sessionFree - sessionLowest : 0;
+#if ALLOC_TRACKING
+    // Per handshake, not only on a new all-time minimum: libssh's own peak
+    // since the session began (handleClient resets the peaks).
+    AllocTagStats a[ALLOC_TAG_COUNT];
+    AllocTracker::snapshot(a);
+    if (a[ALLOC_SSH].peakBytes > took) took = a[ALLOC_SSH].peakBytes;
+#endif
+    if (took <= kexPeak) return;
+    kexPeak = took;
+    if (kexPeak > estimate) estimate = kexPeak;
+}
+
+void MemoryBudget::sessionEnded() {
+    sample();
+    observeSession(sessionFree > sessionLowest ? sessionFree - sessionLowest : 0);
+}
+
+void MemoryBudget::observeSession(uint32_t bytes) {
+    recent[nextRecent] = bytes;
+    nextRecent = (nextRecent + 1) % SSH_BUDGET_WINDOW;
+    uint32_t cost = kexPeak > SSH_SESSION_HEAP_COST ? kexPeak : SSH_SESSION_HEAP_COST;
+    for (uint8_t i = 0; i < SSH_BUDGET_WINDOW; i++) {
+        if (recent[i] > cost) cost = recent[i];
+    }
+    estimate = cost;
+}
+
+const char* MemoryBudget::levelName(BudgetLevel level) {
+    switch (level) {
+    case BUDGET_OK: return "ok";
+    case BUDGET_LOW: return "low";
+    default: return "critical";
+    }
+}
+
+size_t MemoryBudget::format(char* out, size_t len) {
+    int n = snprintf(out, len, "mem_level=%s mem_session_cost=%u mem_shed=%u ssh_refused_lowmem=%u",
+                     levelName(assess()), (unsigned)estimate, (unsigned)nShed, (unsigned)nRefused);
+    if (n < 0) return 0;
+    return (size_t)n < len ? (size_t)n : len ? len - 1 : 0;
+}
@@ -0,0 +1,83 @@
+#ifndef MEMORY_BUDGET_H
+#define MEMORY_BUDGET_H
+
+#include <Arduino.h>
+
+// Heap a session takes from accept to close, until sessions have been
+// measured, and the least assumed afterwards: a measured low can miss a
+// short peak that stayed above the device's all-time minimum.
+#ifndef SSH_SESSION_HEAP_COST
+#define SSH_SESSION_HEAP_COST 40960
+#endif
+// The estimate is the largest cost among this many last sessions, so one
+// heavy session stops counting once this many more have run.
+#ifndef SSH_BUDGET_WINDOW
+#define SSH_BUDGET_WINDOW 8
+#endif
+// Heap left to the rest of the system (Wi-Fi, lwIP, logger) once a session
+// is in.
+#ifndef SSH_HEAP_RESERVE
+#define SSH_HEAP_RESERVE 16384
+#endif
+// Key exchange and packet buffers need contiguous blocks of about this size.
+#ifndef SSH_MIN_LARGEST_BLOCK
+#define SSH_MIN_LARGEST_BLOCK 16384
+#endif
+// Below session cost + reserve + this margin, optional memory users are shed
+// before the next session: the recorder ring, compression, the prewarmed
+// session.
+#ifndef SSH_HEAP_SHED_MARGIN
+#define SSH_HEAP_SHED_MARGIN 32768
+#endif
+
+enum BudgetLevel : uint8_t {
+    BUDGET_OK,          // a session and all optional work fit
+    BUDGET_LOW,         // a session fits once optional work is shed
+    BUDGET_CRITICAL     // refuse new sessions
+};
+
+// Admission control by memory: sessions are only accepted while the heap
+// can hold one more plus SSH_HEAP_RESERVE, so a key exchange does not run
+// the device out of memory halfway through. Only the network task and the
+// channel tasks it hands the session to (one at a time) call in.
+class MemoryBudget {
+public:
+    static BudgetLevel assess(uint32_t freeHeap, uint32_t largestBlock);
+    static BudgetLevel assess();
+    // Whether `bytes` more (one allocation) still leave the reserve free.
+    static bool canAfford(uint32_t bytes);
+    // Measure a session from accept: sessionStarted(), sample() at phase
+    // boundaries and while channels wait, sessionEnded() feeds the heap it
+    // took at its lowest into the estimate.
+    static void sessionStarted();
+    static void sample();
+    static void sessionEnded();
+    // sample() right after key exchange. The heap the handshake took at its
+    // deepest is kept as a floor of the estimate for good: its scratch is
+    // freed before any sample, so it only shows when it sets a new all-time
+    // minimum (or, with ALLOC_TRACKING, as the libssh peak), and later
+    // handshakes doing the same work would otherwise let it fall away.
+    static void handshakeDone();
+    static uint32_t handshakePeak() { return kexPeak; }
+    // Cost of one finished session; the estimate becomes the largest of the
+    // last SSH_BUDGET_WINDOW, at least SSH_SESSION_HEAP_COST and the
+    // handshake peak.
+    static void observeSession(uint32_t bytes);
+    static uint32_t sessionCost() { return estimate; }
+
+    static void noteShed() { nShed++; }
+    static void noteRefused() { nRefused++; }
+    static const char* levelName(BudgetLevel level);
+    // Appends "mem_level=... mem_session_cost=..." to `out`; returns bytes written.
+    static size_t format(char* out, size_t len);
+
+private:
+    static uint32_t estimate;
+    static uint32_t recent[SSH_BUDGET_WINDOW];
+    static uint8_t nextRecent;
+    static uint32_t sessionFree, sessionLowest, minimumAtStart;
+    static uint32_t kexPeak;
+    static uint32_t nShed, nRefused;
+};
+
+#endif // MEMORY_BUDGET_H
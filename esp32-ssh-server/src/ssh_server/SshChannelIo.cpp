@@ -0,0 +1,155 @@
+#include "SshChannelIo.h"
+#include "Reactor.h"
+#include "ChannelScheduler.h"
+#include <lwip/sockets.h>
+#include "SessionRecorder.h"
+#include "Tracer.h"
+#include <string.h>
+
+int ssh_write(ssh_channel ch, const void* data, uint32_t len){
+    TRACE_SCOPE("ch_write");
+    SessionRecorder::output(ch, data, len);
+    return ssh_channel_write(ch, data, len);
+}
+
+void ssh_write_str(ssh_channel ch, const char* s){
+    if (!ch) return;
+    if (s && *s) ssh_write(ch, s, strlen(s));
+}
+
+void ssh_write_line(ssh_channel ch, const char* s){
+    if (s) ssh_write(ch, s, strlen(s));
+    ssh_write(ch, "\r\n", 2);
+}
+
+// Readable stamp of the one channel waiting outside a ChannelScheduler.
+static ssh_channel inputReadyCh = nullptr;
+static int64_t inputReadyUs = 0;
+
+int ssh_read_nonblocking(ssh_channel ch, uint8_t* buf, int maxlen){
+    (void)ssh_take_input_ready(ch); // any read consumes the channel's readable stamp
+    if (!ssh_channel_is_open(ch) || ssh_channel_is_eof(ch)) return -1;
+    int avail = ssh_channel_poll(ch, 0);
+    if (avail <= 0) return 0;
+    if (avail > maxlen) avail = maxlen;
+    int r = ssh_channel_read_nonblocking(ch, buf, avail, 0);
+    if (r <= 0) return 0;
+    TRACE_INSTANT("ch_read", r);
+    SessionRecorder::input(ch, buf, r);
+    return r;
+}
+
+void ssh_channel_wait(ssh_channel ch, int timeoutMs){
+    (void)ssh_channel_wait_fds(ch, timeoutMs, nullptr, 0);
+}
+
+uint32_t ssh_channel_wait_fds(ssh_channel ch, int timeoutMs, const int* fds, uint8_t nFds){
+    if (ssh_channel_poll(ch, 0) != 0) return 0; // buffered data, EOF or error
+    TRACE_SCOPE("ch_wait");
+    ChannelScheduler* sched = ChannelScheduler::active();
+    if (sched) return sched->wait(ch, timeoutMs, fds, nFds);
+    if (nFds > SSH_CHANNEL_WAIT_FDS) nFds = SSH_CHANNEL_WAIT_FDS;
+    int all[SSH_CHANNEL_WAIT_FDS + 1];
+    for (uint8_t i = 0; i < nFds; i++) all[i] = fds[i];
+    all[nFds] = ssh_get_fd(ssh_channel_get_session(ch));
+    uint32_t fdMask = (1UL << nFds) - 1;
+    Reactor* r = Reactor::active();
+    if (r){
+        uint32_t mask = r->poll(timeoutMs, all, nFds + 1);
+        if (mask & (1UL << nFds)) ssh_note_input_ready(ch);
+        return mask & fdMask;
+    }
+    fd_set rfds;
+    FD_ZERO(&rfds);
+    int maxFd = -1;
+    for (uint8_t i = 0; i <= nFds; i++){
+        if (all[i] < 0) continue;
+        FD_SET(all[i], &rfds);
+        if (all[i] > maxFd) maxFd = all[i];
+    }
+    struct timeval tv = { timeoutMs / 1000, (timeoutMs % 1000) * 1000 };
+    uint32_t ready = 0;
+    if (select(maxFd + 1, &rfds, nullptr, nullptr, timeoutMs < 0 ? nullptr : &tv) > 0){
+        for (uint8_t i = 0; i < nFds; i++) if (all[i] >= 0 && FD_ISSET(all[i], &rfds)) ready |= 1UL << i;
+        if (all[nFds] >= 0 && FD_ISSET(all[nFds], &rfds)) ssh_note_input_ready(ch);
+    }
+    return ready;
+}
+
+void ssh_note_input_ready(ssh_channel ch){
+    inputReadyCh = ch;
+    inputReadyUs = esp_timer_get_time();
+}
+
+int64_t ssh_take_input_ready(ssh_channel ch){
+    ChannelScheduler* sched = ChannelScheduler::active();
+    if (sched) return sched->takeInputReady(ch);
+    if (ch != inputReadyCh) return 0;
+    inputReadyCh = nullptr;
+    return inputReadyUs;
+}
+
+LatencyHistogram sshEchoLatency;
+
+size_t SshLineReader::takePending(uint8_t* out, size_t maxLen){
+    if (eatLeadingLF && pendPos < pendLen && pending[pendPos] == '\n') pendPos++;
+    eatLeadingLF = false;
+    size_t n = pendLen - pendPos;
+    if (n > maxLen) n = maxLen;
+    memcpy(out, pending + pendPos, n);
+    pendPos += n;
+    return n;
+}
+
+bool SshLineReader::poll(ssh_channel ch){
+    if (lineReady){
+        lineReady = false;
+        len = 0;
+        buf[0] = '\0';
+    }
+    int64_t t0 = 0;
+    if (pendPos >= pendLen){
+        // A readable stamp is only meaningful for this read; take it either way.
+        t0 = ssh_take_input_ready(ch);
+        if (!t0) t0 = esp_timer_get_time();
+        int r = ssh_read_nonblocking(ch, pending, sizeof(pending));
+        if (r <= 0) return false;
+        pendPos = 0;
+        pendLen = (uint8_t)r;
+    } else {
+        t0 = esp_timer_get_time();
+    }
+    char echo[3 * sizeof(pending)];
+    size_t echoLen = 0;
+    if (eatLeadingLF && pending[pendPos] == '\n') pendPos++;
+    eatLeadingLF = false;
+    while (pendPos < pendLen){
+        char c = (char)pending[pendPos++];
+        if (c == '\r' || c == '\n'){
+            eatLeadingLF = (c == '\r');
+            buf[len] = '\0';
+            lineReady = true;
+            echo[echoLen++] = '\r';
+            echo[echoLen++] = '\n';
+            break;
+        }
+        if (c == 0x7f || c == 0x08){ // backspace
+            if (len > 0){
+                len--;
+                memcpy(echo + echoLen, "\b \b", 3);
+                echoLen += 3;
+            }
+            continue;
+        }
+        if ((unsigned char)c >= 32 && (unsigned char)c < 127 && len < SSH_LINE_MAX){
+            buf[len++] = c;
+            echo[echoLen++] = c;
+        }
+    }
+    buf[len] = '\0';
+    if (echoKeys && echoLen > 0){
+        ssh_write(ch, echo, echoLen);
+        sshEchoLatency.add((uint32_t)(esp_timer_get_time() - t0));
+    }
+    return lineReady;
+}
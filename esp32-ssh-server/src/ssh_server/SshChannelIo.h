@@ -0,0 +1,72 @@
+#ifndef SSH_CHANNEL_IO_H
+#define SSH_CHANNEL_IO_H
+
+#include <Arduino.h>
+#include <libssh/libssh.h>
+#include "LatencyHistogram.h"
+
+// Small helpers shared by the session menu and the apps it launches.
+// Terminal output goes through ssh_write() and input through
+// ssh_read_nonblocking() so the session recorder sees both; bench bulk
+// transfers and RPC frames call libssh directly and are not recorded.
+int ssh_write(ssh_channel ch, const void* data, uint32_t len);
+void ssh_write_str(ssh_channel ch, const char* s);
+void ssh_write_line(ssh_channel ch, const char* s);
+int ssh_read_nonblocking(ssh_channel ch, uint8_t* buf, int maxlen);
+
+// Park a session loop until the channel may have input or timeoutMs passes.
+// Inside a multi-channel session this is where other channels get to run
+// (see ChannelScheduler); otherwise it selects on the session socket, under
+// a Reactor while servicing its other listeners.
+void ssh_channel_wait(ssh_channel ch, int timeoutMs);
+// Same, also waking when one of `fds` is readable; bit i of the result is set
+// for fds[i]. At most SSH_CHANNEL_WAIT_FDS descriptors.
+uint32_t ssh_channel_wait_fds(ssh_channel ch, int timeoutMs, const int* fds, uint8_t nFds);
+// Called by the waits above when they see the session socket readable
+// while `ch` waits.
+void ssh_note_input_ready(ssh_channel ch);
+// esp_timer time at which a wait of `ch` last saw the session socket
+// readable, and clear it; 0 if none or if `ch` was read since. Under a
+// ChannelScheduler the stamp is kept per channel there.
+int64_t ssh_take_input_ready(ssh_channel ch);
+
+#ifndef SSH_LINE_MAX
+#define SSH_LINE_MAX 256
+#endif
+
+// Keystroke-to-echo time for every read that produced echo: from the moment
+// a wait saw the session socket readable (so packet read and decryption are
+// included) until the single echo write returned. Input that arrived without
+// a wait is timed from its read.
+extern LatencyHistogram sshEchoLatency;
+
+// Line discipline for a session channel: assembles printable input into a
+// fixed buffer with backspace handling, and echoes everything consumed from
+// one read in a single channel write. Bytes after a line ending are kept for
+// the next poll(), so pasted multi-line input is not lost.
+class SshLineReader {
+public:
+    explicit SshLineReader(bool echoKeys = true) : echoKeys(echoKeys) {}
+    // Consume available input without blocking; true when line() holds a
+    // complete line (valid until the next poll()).
+    bool poll(ssh_channel ch);
+    const char* line() const { return buf; }
+    // Writable view of the completed line for in-place parsing.
+    char* lineBuf() { return buf; }
+    size_t length() const { return len; }
+    // ssh_channel_wait() unless input from an earlier read is still queued here.
+    void wait(ssh_channel ch, int timeoutMs){ if (pendPos >= pendLen) ssh_channel_wait(ch, timeoutMs); }
+    // Hand input queued behind the last line to a raw-mode consumer.
+    size_t takePending(uint8_t* out, size_t maxLen);
+
+private:
+    bool echoKeys;
+    bool lineReady = false;
+    bool eatLeadingLF = false; // swallow LF immediately after CR
+    char buf[SSH_LINE_MAX + 1] = {};
+    size_t len = 0;
+    uint8_t pending[64];
+    uint8_t pendPos = 0, pendLen = 0;
+};
+
+#endif // SSH_CHANNEL_IO_H
@@ -1,80 +1,141 @@
 #include "SshServer.h"
+#include "SshChannelIo.h"
+#include "ChannelScheduler.h"
+#include "Tracer.h"
+#include "BenchApp.h"
+#include "LogsApp.h"
+#include "TopApp.h"
+#include "SerialApp.h"
+#include "GpioApp.h"
+#include "ScriptApp.h"
+#include "RecorderApp.h"
+#include "HistoryApp.h"
+#include "SessionRecorder.h"
+#include "Blinker.h"
+#include "CmdLine.h"
+#include "RpcServer.h"
+#include "Logger.h"
+#include "AllocTracker.h"
+#include "PowerManager.h"
 #include <Arduino.h>
 #include <libssh/libssh.h>
 #include <libssh/server.h>
 // No SPIFFS/host-key storage; ephemeral in-memory host key
 #include <string.h>
+#include <esp_heap_caps.h>
+#include <lwip/sockets.h>
 
-#ifndef LED_BUILTIN
-#define LED_BUILTIN 2
-#endif
+SshServer::SshServer(const char* host_key) : host_key(host_key) {
+    ssh_init();
+}
 
-static void ssh_write_str(ssh_channel ch, const char* s){
-    if (!ch) return;
-    if (s && *s) ssh_channel_write(ch, s, strlen(s));
+void SshServer::setAlgorithms(const char* ciphers, const char* kex, const char* hmacs) {
+    this->ciphers = ciphers;
+    this->kex = kex;
+    this->hmacs = hmacs;
 }
 
-static void ssh_write_line(ssh_channel ch, const char* s){
-    if (s) ssh_channel_write(ch, s, strlen(s));
-    ssh_channel_write(ch, "\r\n", 2);
+void SshServer::setCompression(bool enabled, int level) {
+    compression = enabled;
+    compressionLevel = level;
 }
 
-static int ssh_read_nonblocking(ssh_channel ch, uint8_t* buf, int maxlen){
-    if (!ssh_channel_is_open(ch) || ssh_channel_is_eof(ch)) return -1;
-    int avail = ssh_channel_poll(ch, 0);
-    if (avail <= 0) return 0;
-    if (avail > maxlen) avail = maxlen;
-    int r = ssh_channel_read_nonblocking(ch, buf, avail, 0);
-    return r > 0 ? r : 0;
+uint32_t SshServer::taskCpuUs() {
+#if configGENERATE_RUN_TIME_STATS && configUSE_TRACE_FACILITY
+    TaskStatus_t st;
+    vTaskGetInfo(nullptr, &st, pdFALSE, eRunning);
+    return st.ulRunTimeCounter;
+#else
+    return 0;
+#endif
 }
 
-// Read lines without blocking; returns true when a full line is available in outLine
-static bool ssh_read_line(ssh_channel ch, String &inBuf, String &outLine, bool echoKeys){
-    static bool eatLeadingLF = false; // swallow LF immediately after CR
-    uint8_t tmp[64];
-    int r = ssh_read_nonblocking(ch, tmp, sizeof(tmp));
-    if (r <= 0) return false;
-    int i = 0;
-    if (eatLeadingLF){
-        while (i < r && tmp[i] == '\n') i++;
-        eatLeadingLF = false;
+// Offer zlib@openssh.com server->client only when the deflate state fits.
+bool SshServer::offerCompression(ssh_session sess) {
+    if (!compression) return false;
+    // libssh's deflateInit() uses zlib's defaults, which cannot be changed
+    // from here: windowBits 15, memLevel 8.
+    const unsigned windowBits = 15, memLevel = 8;
+    const size_t deflateBytes = (1UL << (windowBits + 2)) + (1UL << (memLevel + 9)) + 6 * 1024;
+    size_t freeHeap = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    size_t largest = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+    if (freeHeap < deflateBytes + SSH_COMPRESSION_HEAP_RESERVE || largest < (1UL << (windowBits + 1))) {
+        LOGW("SSH", "Compression skipped: need %u B, free %u largest %u",
+             (unsigned)deflateBytes, (unsigned)freeHeap, (unsigned)largest);
+        return false;
     }
-    for (; i<r; i++){
-        char c = (char)tmp[i];
-        if (c == '\r' || c == '\n'){
-            if (c == '\r') eatLeadingLF = true;
-            outLine = inBuf;
-            inBuf = "";
-            if (echoKeys) ssh_channel_write(ch, "\r\n", 2);
-            return true;
-        }
-        if (c == 0x7f || c == 0x08){ // backspace
-            if (inBuf.length() > 0){
-                inBuf.remove(inBuf.length()-1);
-                if (echoKeys) ssh_channel_write(ch, "\b \b", 3);
-            }
-            continue;
-        }
-        if ((unsigned char)c >= 32 && (unsigned char)c < 127){
-            if (inBuf.length() < 256){
-                inBuf += c;
-                if (echoKeys) ssh_channel_write(ch, &c, 1);
-            }
-        }
+    if (ssh_options_set(sess, SSH_OPTIONS_COMPRESSION_S_C, "zlib@openssh.com,none") != SSH_OK ||
+        ssh_options_set(sess, SSH_OPTIONS_COMPRESSION_C_S, "none") != SSH_OK ||
+        ssh_options_set(sess, SSH_OPTIONS_COMPRESSION_LEVEL, &compressionLevel) != SSH_OK) {
+        LOGW("SSH", "Compression unavailable: %s", ssh_get_error(sess));
+        return false;
     }
-    return false;
+    return true;
 }
 
-SshServer::SshServer(const char* host_key) : host_key(host_key) {
-    ssh_init();
+// Wire vs payload bytes for the whole session; ratio > 1 means compression paid off.
+void SshServer::logSessionStats() {
+    uint64_t raw = info.rawCounter.out_bytes;
+    uint64_t wire = info.socketCounter.out_bytes;
+    uint32_t cpu = taskCpuUs() - info.cpuStartUs;
+    LOGI("SSH", "Session stats: compression=%s out raw=%llu wire=%llu ratio=%.2f in wire=%llu cpu_us=%llu",
+         info.compressionOffered ? "zlib" : "none",
+         (unsigned long long)raw, (unsigned long long)wire,
+         wire ? (double)raw / (double)wire : 0.0,
+         (unsigned long long)info.socketCounter.in_bytes, (unsigned long long)cpu);
+    if (!AllocTracker::enabled()) return;
+    // Peaks were reset when the session was accepted, so they bound what one
+    // session costs per subsystem.
+    AllocTagStats a[ALLOC_TAG_COUNT];
+    AllocTracker::snapshot(a);
+    LOGI("SSH", "Session heap: ssh peak=%u allocs=%u app peak=%u allocs=%u lwip peak=%u allocs=%u",
+         (unsigned)a[ALLOC_SSH].peakBytes, (unsigned)(a[ALLOC_SSH].allocs - info.allocStart[ALLOC_SSH].allocs),
+         (unsigned)a[ALLOC_APP].peakBytes, (unsigned)(a[ALLOC_APP].allocs - info.allocStart[ALLOC_APP].allocs),
+         (unsigned)a[ALLOC_LWIP].peakBytes, (unsigned)(a[ALLOC_LWIP].allocs - info.allocStart[ALLOC_LWIP].allocs));
+}
+
+// A session with the per-connection options applied; everything libssh needs
+// the socket for happens later in ssh_bind_accept().
+ssh_session SshServer::newSession() {
+    ssh_session sess = ssh_new();
+    if (!sess) return nullptr;
+    // Bound every blocking libssh call until the shell starts, so a silent or
+    // half-open client cannot hold the single session slot forever.
+    long handshakeTimeout = SSH_HANDSHAKE_TIMEOUT_S;
+    ssh_options_set(sess, SSH_OPTIONS_TIMEOUT, &handshakeTimeout);
+    return sess;
+}
+
+void SshServer::wireBytes(uint64_t& in, uint64_t& out) const {
+    in = stats.wireInTotal;
+    out = stats.wireOutTotal;
+    if (info.session) {
+        in += info.socketCounter.in_bytes;
+        out += info.socketCounter.out_bytes;
+    }
+}
+
+uint8_t SshServer::openChannels() const {
+    if (!info.session) return 0;
+    ChannelScheduler* channels = ChannelScheduler::active();
+    return channels ? channels->live() : 1;
+}
+
+void SshServer::prewarm() {
+    if (!SSH_PREWARM_SESSION || spare || !sshbind) return;
+    // A parked session is optional; keep the heap for the real one.
+    if (MemoryBudget::assess() != BUDGET_OK) return;
+    TRACE_SCOPE("ssh_prewarm");
+    spare = newSession();
 }
 
 void SshServer::begin() {
     libssh_begin();
+    if (SSH_RECORD_AT_BOOT) SessionRecorder::enable();
 
     sshbind = ssh_bind_new();
     if (!sshbind) {
-        Serial.println("ssh_bind_new failed");
+        LOGE("SSH", "ssh_bind_new failed");
         return;
     }
 
@@ -86,13 +147,27 @@ void SshServer::begin() {
     int rcOpt;
 
     rcOpt = ssh_bind_options_set(sshbind, SSH_BIND_OPTIONS_BINDADDR, addr4);
-    Serial.printf("[SSH] opt BINDADDR(%s) rc=%d\n", addr4, rcOpt);
+    LOGI("SSH", "opt BINDADDR(%s) rc=%d", addr4, rcOpt);
     rcOpt = ssh_bind_options_set(sshbind, SSH_BIND_OPTIONS_BINDPORT, &port);
-    Serial.printf("[SSH] opt BINDPORT(%d) rc=%d\n", port, rcOpt);
+    LOGI("SSH", "opt BINDPORT(%d) rc=%d", port, rcOpt);
     rcOpt = ssh_bind_options_set(sshbind, SSH_BIND_OPTIONS_BINDPORT_STR, portStr);
-    Serial.printf("[SSH] opt BINDPORT_STR(%s) rc=%d\n", portStr, rcOpt);
+    LOGI("SSH", "opt BINDPORT_STR(%s) rc=%d", portStr, rcOpt);
     rcOpt = ssh_bind_options_set(sshbind, SSH_BIND_OPTIONS_HOSTKEY, "ssh-ed25519");
-    Serial.printf("[SSH] opt HOSTKEY(ed25519) rc=%d\n", rcOpt);
+    LOGI("SSH", "opt HOSTKEY(ed25519) rc=%d", rcOpt);
+    if (ciphers) {
+        rcOpt = ssh_bind_options_set(sshbind, SSH_BIND_OPTIONS_CIPHERS_C_S, ciphers);
+        rcOpt |= ssh_bind_options_set(sshbind, SSH_BIND_OPTIONS_CIPHERS_S_C, ciphers);
+        LOGI("SSH", "opt CIPHERS(%s) rc=%d", ciphers, rcOpt);
+    }
+    if (kex) {
+        rcOpt = ssh_bind_options_set(sshbind, SSH_BIND_OPTIONS_KEY_EXCHANGE, kex);
+        LOGI("SSH", "opt KEY_EXCHANGE(%s) rc=%d", kex, rcOpt);
+    }
+    if (hmacs) {
+        rcOpt = ssh_bind_options_set(sshbind, SSH_BIND_OPTIONS_HMAC_C_S, hmacs);
+        rcOpt |= ssh_bind_options_set(sshbind, SSH_BIND_OPTIONS_HMAC_S_C, hmacs);
+        LOGI("SSH", "opt HMAC(%s) rc=%d", hmacs, rcOpt);
+    }
 #ifdef SSH_BIND_OPTIONS_BINDADDR6
     const char *addr6 = "::";
     ssh_bind_options_set(sshbind, SSH_BIND_OPTIONS_BINDADDR6, addr6);
@@ -102,23 +177,28 @@ void SshServer::begin() {
     ssh_key genKey = nullptr;
     if (ssh_pki_generate(SSH_KEYTYPE_ED25519, 0, &genKey) == SSH_OK) {
         if (ssh_bind_options_set(sshbind, SSH_BIND_OPTIONS_IMPORT_KEY, genKey) == SSH_OK) {
-            Serial.println("[SSH] Using ephemeral ED25519 host key");
+            LOGI("SSH", "Using ephemeral ED25519 host key");
         } else {
-            Serial.printf("[SSH] Import generated key failed: %s\n", ssh_get_error(sshbind));
+            LOGE("SSH", "Import generated key failed: %s", ssh_get_error(sshbind));
         }
     } else {
-        Serial.println("[SSH] Host key generation failed");
+        LOGE("SSH", "Host key generation failed");
     }
 
-    Serial.printf("[SSH] Calling ssh_bind_listen() on port %d...\n", port);
+    LOGI("SSH", "Calling ssh_bind_listen() on port %d...", port);
     if (ssh_bind_listen(sshbind) < 0) {
-        Serial.printf("[SSH] Listen failed: %s\n", ssh_get_error(sshbind));
+        LOGE("SSH", "Listen failed: %s", ssh_get_error(sshbind));
         return;
     }
-    Serial.printf("[SSH] Listening OK on port %d (0.0.0.0 / ::)\n", port);
+    LOGI("SSH", "Listening OK on port %d (0.0.0.0 / ::)", port);
+    prewarm();
     // No SPIFFS; no key saving
 }
 
+int SshServer::listenFd() {
+    return sshbind ? (int)ssh_bind_get_fd(sshbind) : -1;
+}
+
 int SshServer::auth_password(ssh_session session, const char *user, const char *password, void *userdata) {
     if (strcmp(user, "cago") == 0 && strcmp(password, "cago1231") == 0) {
         return SSH_AUTH_SUCCESS;
@@ -126,34 +206,221 @@ int SshServer::auth_password(ssh_session session, const char *user, const char *
     return SSH_AUTH_DENIED;
 }
 
+// Apps that keep their state in statics or drive one peripheral serve one
+// channel of the session at a time.
+enum ExclusiveApp { APP_BLINK, APP_BENCH, APP_TOP, APP_SERIAL, APP_SCRIPT, APP_RPC, APP_EXCLUSIVE_COUNT };
+static bool appBusy[APP_EXCLUSIVE_COUNT];
+
+static bool claimApp(ssh_channel ch, ExclusiveApp app) {
+    if (appBusy[app]) {
+        ssh_write_line(ch, "Busy on another channel of this session.");
+        return false;
+    }
+    appBusy[app] = true;
+    return true;
+}
+
+// Shed optional memory users while the heap is short of a session plus its
+// margin: the recorder ring first and, when not even a bare session fits,
+// the prewarmed one. A ring shed here comes back once the budget is OK with
+// it allocated again. Returns the level left after shedding.
+BudgetLevel SshServer::makeRoom() {
+    BudgetLevel level = MemoryBudget::assess();
+    if (SessionRecorder::enabled()) recorderShed = 0;  // turned on again by hand
+    if (level != BUDGET_OK && SessionRecorder::enabled()) {
+        recorderShed = SessionRecorder::stats().capacity;
+        SessionRecorder::disable();
+        MemoryBudget::noteShed();
+        LOGW("SSH", "Heap low: session recording stopped");
+        level = MemoryBudget::assess();
+    } else if (level == BUDGET_OK && recorderShed) {
+        uint32_t freeHeap = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+        uint32_t largest = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+        if (freeHeap > recorderShed && largest > recorderShed &&
+            MemoryBudget::assess(freeHeap - recorderShed, largest) == BUDGET_OK &&
+            SessionRecorder::enable(recorderShed)) {
+            LOGI("SSH", "Heap recovered: session recording resumed (%u B ring)", (unsigned)recorderShed);
+            recorderShed = 0;
+            level = MemoryBudget::assess();
+        }
+    }
+    if (level == BUDGET_CRITICAL && spare) {
+        ssh_free(spare);
+        spare = nullptr;
+        MemoryBudget::noteShed();
+        level = MemoryBudget::assess();
+    }
+    return level;
+}
+
+// Turn the next client away without libssh: take it off the listen queue,
+// exchange versions and send a plaintext SSH_MSG_DISCONNECT (allowed before
+// key exchange), so the client prints the reason instead of a reset.
+void SshServer::refuseLowMemory() {
+    static const uint8_t SSH_MSG_DISCONNECT = 1;
+    static const uint32_t SSH_DISCONNECT_SERVICE_NOT_AVAILABLE = 7;
+    MemoryBudget::noteRefused();
+    uint32_t freeHeap = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    uint32_t largest = heap_caps_get_largest_free_block(MALLOC_CAP_8BIT);
+    LOGW("SSH", "Session refused: heap %u free, %u largest, session needs %u + %u reserve",
+         (unsigned)freeHeap, (unsigned)largest, (unsigned)MemoryBudget::sessionCost(), (unsigned)SSH_HEAP_RESERVE);
+    int fd = accept(listenFd(), nullptr, nullptr);
+    if (fd < 0) return;
+
+    char why[96];
+    uint32_t whyLen = snprintf(why, sizeof(why), "Server low on memory (%u bytes free), try again later",
+                               (unsigned)freeHeap);
+    if (whyLen >= sizeof(why)) whyLen = sizeof(why) - 1;
+    uint8_t pkt[160];
+    size_t n = 0;
+    const char version[] = "SSH-2.0-esp32\r\n";
+    memcpy(pkt, version, sizeof(version) - 1);
+    n = sizeof(version) - 1;
+    // Binary packet, no cipher or MAC yet: length, padding length, payload
+    // (type, reason, description, language), padding to a multiple of 8.
+    uint32_t payloadLen = 1 + 4 + 4 + whyLen + 4;
+    uint8_t padLen = 8 - (5 + payloadLen) % 8;
+    if (padLen < 4) padLen += 8;
+    uint32_t pktLen = 1 + payloadLen + padLen;
+    auto putU32 = [&](uint32_t v){
+        pkt[n++] = (uint8_t)(v >> 24); pkt[n++] = (uint8_t)(v >> 16);
+        pkt[n++] = (uint8_t)(v >> 8); pkt[n++] = (uint8_t)v;
+    };
+    putU32(pktLen);
+    pkt[n++] = padLen;
+    pkt[n++] = SSH_MSG_DISCONNECT;
+    putU32(SSH_DISCONNECT_SERVICE_NOT_AVAILABLE);
+    putU32(whyLen);
+    memcpy(pkt + n, why, whyLen);
+    n += whyLen;
+    putU32(0);
+    memset(pkt + n, 0, padLen);
+    n += padLen;
+    send(fd, pkt, n, 0);
+
+    // Read what the client already sent before closing, or lwIP answers it
+    // with a reset that can discard the disconnect on the client side.
+    shutdown(fd, SHUT_WR);
+    struct timeval tv = { 0, 200 * 1000 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    char sink[64];
+    unsigned long start = millis();
+    while (millis() - start < 500 && recv(fd, sink, sizeof(sink), 0) > 0) {}
+    closesocket(fd);
+}
+
 void SshServer::handleClient() {
-    ssh_session sess = ssh_new();
-    if (!sess) return;
+    AllocScope allocScope(ALLOC_SSH);
+    // Before libssh allocates anything for this client.
+    BudgetLevel budget = makeRoom();
+    if (budget == BUDGET_CRITICAL) {
+        refuseLowMemory();
+        return;
+    }
+    PowerSessionScope powerScope;
+    AllocTracker::resetPeaks();
+    MemoryBudget::sessionStarted();
+    int64_t setupStart = esp_timer_get_time();
+    bool prewarmed = spare != nullptr;
+    ssh_session sess = prewarmed ? spare : newSession();
+    spare = nullptr;
+    if (!sess) {
+        MemoryBudget::sessionEnded();
+        // Leaving the client queued would make the listener fire again at once.
+        refuseLowMemory();
+        return;
+    }
+    uint32_t setupUs = (uint32_t)(esp_timer_get_time() - setupStart);
+    ssh_channel ch = nullptr;
 
-    Serial.println("[SSH] Waiting for incoming connection (accept blocking)...");
+    // Connection phases as consecutive spans on the trace timeline.
+    const char* tracePhase = nullptr;
+    auto phase = [&](const char* name){
+        if (tracePhase) TRACE_END(tracePhase);
+        tracePhase = name;
+        if (name) TRACE_BEGIN(name);
+    };
+
+    // Every early exit funnels through here so the channel, session and
+    // counters are released/updated the same way on all paths, the session's
+    // cost is observed for the next admission (a failed key exchange uses as
+    // much as a served one), and the next session is prepared before the
+    // listener is watched again.
+    auto closeSession = [&](uint32_t& counter, const char* why){
+        MemoryBudget::sessionEnded();
+        counter++;
+        if (why) LOGW("SSH", "Closing session: %s", why);
+        phase(nullptr);
+        if (ch) ssh_channel_free(ch);
+        ch = nullptr;
+        ssh_disconnect(sess);
+        ssh_free(sess);
+        stats.wireInTotal += info.socketCounter.in_bytes;
+        stats.wireOutTotal += info.socketCounter.out_bytes;
+        info.session = nullptr;
+        prewarm();
+    };
+
+    LOGD("SSH", "Accepting incoming connection...");
+    int64_t acceptStart = esp_timer_get_time();
+    phase("ssh_accept");
     if (ssh_bind_accept(sshbind, sess) == SSH_ERROR) {
-        Serial.printf("Accept failed: %s\n", ssh_get_error(sshbind));
+        LOGW("SSH", "Accept failed: %s", ssh_get_error(sshbind));
+        phase(nullptr);
+        MemoryBudget::sessionEnded();
+        stats.acceptFailed++;
         ssh_free(sess);
+        prewarm();
         return;
     }
-    Serial.println("[SSH] TCP accepted, doing key exchange");
+    stats.accepted++;
+    if (prewarmed) stats.prewarmed++;
+    LOGI("SSH", "TCP accepted, doing key exchange");
+    memset(&info, 0, sizeof(info));
+    info.acceptUs = (uint32_t)(esp_timer_get_time() - acceptStart);
+    info.setupUs = setupUs;
+    info.prewarmed = prewarmed;
+    AllocTracker::snapshot(info.allocStart);
+    info.session = sess;
+    info.cpuStartUs = taskCpuUs();
+    ssh_set_counters(sess, &info.socketCounter, &info.rawCounter);
+    // The deflate state is optional work: offered only while the budget is OK.
+    info.compressionOffered = budget == BUDGET_OK && offerCompression(sess);
+    if (interactive) {
+        int one = 1;
+        if (setsockopt(ssh_get_fd(sess), IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one)) != 0) {
+            LOGW("SSH", "TCP_NODELAY failed: errno %d", errno);
+        }
+    }
+    int64_t kexStart = esp_timer_get_time();
+    phase("ssh_kex");
     if (ssh_handle_key_exchange(sess)) {
-        Serial.printf("Key exchange failed: %s\n", ssh_get_error(sess));
-        ssh_disconnect(sess);
-        ssh_free(sess);
+        LOGW("SSH", "Key exchange failed: %s", ssh_get_error(sess));
+        closeSession(stats.kexFailed, nullptr);
         return;
     }
+    info.handshakeUs = (uint32_t)(esp_timer_get_time() - kexStart);
+    MemoryBudget::handshakeDone();
+    stats.handshakes++;
+    stats.setupUsTotal += info.setupUs;
+    stats.acceptUsTotal += info.acceptUs;
+    stats.kexUsTotal += info.handshakeUs;
+    // Two lines: the logger keeps LOG_MAX_ARGS words and LOG_STR_BYTES of
+    // string arguments per message, and algorithm names run to ~37 bytes.
+    LOGI("SSH", "KEX %s in %u us (setup %u%s, accept %u)", ssh_get_kex_algo(sess), (unsigned)info.handshakeUs,
+         (unsigned)info.setupUs, info.prewarmed ? " prewarmed" : "", (unsigned)info.acceptUs);
+    LOGI("SSH", "Cipher %s mac %s", ssh_get_cipher_out(sess), ssh_get_hmac_out(sess));
 
     ssh_set_auth_methods(sess, SSH_AUTH_METHOD_PASSWORD);
 
     // Authentication loop
+    phase("ssh_auth");
     bool authed = false;
+    int authAttempts = 0;
     while (!authed) {
         ssh_message m = ssh_message_get(sess);
         if (!m) {
-            Serial.println("Auth: no message (client closed)");
-            ssh_disconnect(sess);
-            ssh_free(sess);
+            closeSession(stats.dropped, "auth: no message (client closed or timed out)");
             return;
         }
         if (ssh_message_type(m) == SSH_REQUEST_AUTH &&
@@ -165,52 +432,54 @@ void SshServer::handleClient() {
                               nullptr) == SSH_AUTH_SUCCESS) {
                 ssh_message_auth_reply_success(m, 0);
                 ssh_message_free(m);
-                Serial.println("Authenticated");
+                LOGI("SSH", "Authenticated");
                 authed = true;
                 break;
             }
             ssh_message_auth_set_methods(m, SSH_AUTH_METHOD_PASSWORD);
             ssh_message_reply_default(m);
             ssh_message_free(m);
-            Serial.println("Auth failed (closing)");
-            ssh_disconnect(sess);
-            ssh_free(sess);
+            closeSession(stats.authFailed, "auth failed");
             return;
         }
         ssh_message_reply_default(m);
         ssh_message_free(m);
+        if (++authAttempts >= SSH_MAX_AUTH_ATTEMPTS) {
+            closeSession(stats.authFailed, "too many auth attempts");
+            return;
+        }
     }
 
     // Channel open
-    ssh_channel ch = nullptr;
+    phase("ssh_channel");
     while (!ch) {
         ssh_message m = ssh_message_get(sess);
         if (!m) {
-            Serial.println("Channel: no message");
-            ssh_disconnect(sess);
-            ssh_free(sess);
+            closeSession(stats.dropped, "channel: no message");
             return;
         }
         if (ssh_message_type(m) == SSH_REQUEST_CHANNEL_OPEN &&
             ssh_message_subtype(m) == SSH_CHANNEL_SESSION) {
             ch = ssh_message_channel_request_open_reply_accept(m);
             ssh_message_free(m);
-            Serial.println("Channel opened");
+            if (!ch) {
+                closeSession(stats.dropped, "channel accept failed");
+                return;
+            }
+            LOGI("SSH", "Channel opened");
             break;
         }
         ssh_message_reply_default(m);
         ssh_message_free(m);
     }
 
-    // PTY and Shell request
+    // PTY and shell (or RPC subsystem) request
     bool shellReady = false;
+    bool rpc = false;
     while (!shellReady) {
         ssh_message m = ssh_message_get(sess);
         if (!m) {
-            Serial.println("Shell: no message");
-            if (ch) ssh_channel_free(ch);
-            ssh_disconnect(sess);
-            ssh_free(sess);
+            closeSession(stats.dropped, "shell: no message");
             return;
         }
         if (ssh_message_type(m) == SSH_REQUEST_CHANNEL) {
@@ -218,7 +487,7 @@ void SshServer::handleClient() {
             if (subtype == SSH_CHANNEL_REQUEST_PTY) {
                 ssh_message_channel_request_reply_success(m);
                 ssh_message_free(m);
-                Serial.println("PTY allocated");
+                LOGD("SSH", "PTY allocated");
                 continue; // wait for shell/exec
             }
             if (subtype == SSH_CHANNEL_REQUEST_ENV) {
@@ -230,118 +499,201 @@ void SshServer::handleClient() {
             if (subtype == SSH_CHANNEL_REQUEST_SHELL) {
                 ssh_message_channel_request_reply_success(m);
                 ssh_message_free(m);
-                Serial.println("Shell ready");
+                LOGI("SSH", "Shell ready");
                 shellReady = true;
                 break;
             }
+            if (subtype == SSH_CHANNEL_REQUEST_SUBSYSTEM) {
+                const char* name = ssh_message_channel_request_subsystem(m);
+                if (name && !strcmp(name, RPC_SUBSYSTEM)) {
+                    ssh_message_channel_request_reply_success(m);
+                    ssh_message_free(m);
+                    LOGI("SSH", "RPC subsystem ready");
+                    rpc = true;
+                    shellReady = true;
+                    break;
+                }
+            }
         }
         ssh_message_reply_default(m);
         ssh_message_free(m);
     }
 
-    // Interactive app menu
-    auto runEchoMode = [&](ssh_channel ch){
+    if (SessionRecorder::enabled()) {
+        char label[64];
+        char ip[16] = "?";
+        struct sockaddr_in peer;
+        socklen_t plen = sizeof(peer);
+        if (getpeername(ssh_get_fd(sess), (struct sockaddr*)&peer, &plen) == 0)
+            inet_ntop(AF_INET, &peer.sin_addr, ip, sizeof(ip));
+        snprintf(label, sizeof(label), "session %u from %s%s", (unsigned)stats.accepted, ip, rpc ? " (rpc)" : "");
+        SessionRecorder::marker(label);
+    }
+
+    // Interactive app menu; each channel has its own line reader, so
+    // typed-ahead input survives switching between apps.
+    auto runEchoMode = [&](ssh_channel ch, SshLineReader& reader){
         ssh_write_line(ch, "Echo mode: type text and press Enter. Press 'q' then Enter to return to menu.");
         ssh_write_str(ch, "> ");
-        String buf; String line;
         while (ssh_channel_is_open(ch) && !ssh_channel_is_eof(ch)){
-            if (ssh_read_line(ch, buf, line, true)){
-                if (line == "q"){
+            if (reader.poll(ch)){
+                if (!strcmp(reader.line(), "q")){
                     ssh_write_line(ch, "(leaving echo mode)");
                     return;
                 }
-                ssh_write_line(ch, line.c_str());
+                ssh_write_line(ch, reader.line());
                 ssh_write_str(ch, "> ");
             }
-            delay(10);
+            reader.wait(ch, 1000);
         }
     };
 
-    auto runBlinkApp = [&](ssh_channel ch){
-        pinMode(LED_BUILTIN, OUTPUT);
-        bool ledOn = false;
-        float freq = 2.0f; // Hz
-        const float minF = 0.1f, maxF = 20.0f;
-        unsigned long lastToggle = millis();
-        unsigned long halfPeriodMs = (unsigned long)(500.0f / freq);
-        auto recompute = [&](){ halfPeriodMs = (unsigned long)(500.0f / freq); if (halfPeriodMs < 1) halfPeriodMs = 1; };
-        ssh_write_line(ch, "Blinking LED app: default 2.0 Hz.");
-        ssh_write_line(ch, "Commands: '+' faster, '-' slower, a number sets Hz (e.g. 5), 'q' to return.");
+    auto runBlinkApp = [&](ssh_channel ch, SshLineReader& reader){
+        BlinkArgs blink = { 2.0f, 50 };
+        ledBlinker.start(blink.hz, blink.duty);
+        ssh_write_line(ch, "Blinking LED app: default 2.0 Hz, 50% duty.");
+        ssh_write_line(ch, "Commands: '+' faster, '-' slower, [--hz] HZ [--duty PCT] (e.g. 5 or --hz 5 --duty 25), 'q' to return.");
         ssh_write_str(ch, "> ");
-    String buf; String line;
         while (ssh_channel_is_open(ch) && !ssh_channel_is_eof(ch)){
-            // Toggle LED
-            unsigned long now = millis();
-            if (now - lastToggle >= halfPeriodMs){
-                ledOn = !ledOn;
-                digitalWrite(LED_BUILTIN, ledOn ? HIGH : LOW);
-                lastToggle = now;
-            }
-            // Input processing
-            if (ssh_read_line(ch, buf, line, true)){
-                if (line == "q"){
+            if (reader.poll(ch)){
+                const char* line = reader.line();
+                if (!strcmp(line, "q")){
                     ssh_write_line(ch, "(stopping blink, returning to menu)");
-                    digitalWrite(LED_BUILTIN, LOW);
+                    ledBlinker.set(false);
                     return;
                 }
-                if (line == "+") { freq += 0.5f; if (freq > maxF) freq = maxF; recompute(); }
-                else if (line == "-") { freq -= 0.5f; if (freq < minF) freq = minF; recompute(); }
+                char msg[96];
+                if (!strcmp(line, "+")) blink.hz += 0.5f;
+                else if (!strcmp(line, "-")) blink.hz -= 0.5f;
                 else {
-                    char *end=nullptr; double v = strtod(line.c_str(), &end);
-                    if (end && *end == '\0') { freq = (float)v; if (freq < minF) freq = minF; if (freq > maxF) freq = maxF; recompute(); }
+                    // argv[0] is the command name for the parser.
+                    char* argv[CMD_MAX_ARGS] = { (char*)"blink" };
+                    int argc = cmdTokenize(reader.lineBuf(), argv + 1, CMD_MAX_ARGS - 1);
+                    BlinkArgs next = blink;
+                    if (argc < 0) ssh_write_line(ch, "Unbalanced quotes or too many words.");
+                    else if (!blinkParseArgs(argc + 1, argv, next, msg, sizeof(msg))) ssh_write_line(ch, msg);
+                    else blink = next;
                 }
-                char msg[48]; snprintf(msg, sizeof(msg), "freq = %.2f Hz", (double)freq);
+                ledBlinker.start(blink.hz, blink.duty);
+                blink.hz = ledBlinker.frequency();
+                snprintf(msg, sizeof(msg), "freq = %.2f Hz, duty = %u%%", (double)blink.hz, (unsigned)blink.duty);
                 ssh_write_line(ch, msg);
                 ssh_write_str(ch, "> ");
             }
-            delay(5);
+            // The LED toggles from its own timer; only input wakes us.
+            reader.wait(ch, 1000);
         }
-        digitalWrite(LED_BUILTIN, LOW);
+        ledBlinker.set(false);
     };
 
-    auto runMenu = [&](ssh_channel ch){
+    auto printMenu = [&](ssh_channel ch){
         ssh_write_line(ch, "=== ESP32 Apps ===");
         ssh_write_line(ch, "1) echo_mode");
         ssh_write_line(ch, "2) blinking_led");
+        ssh_write_line(ch, "3) bench");
+        ssh_write_line(ch, "4) logs");
+        ssh_write_line(ch, "5) top");
+        ssh_write_line(ch, "6) serial");
+        ssh_write_line(ch, "7) gpio");
+        ssh_write_line(ch, "8) script");
+        ssh_write_line(ch, "9) rec");
+        ssh_write_line(ch, "10) history");
         ssh_write_line(ch, "Type number and Enter to run, or 'quit' to disconnect.");
         ssh_write_str(ch, "> ");
-        String buf; String line;
+    };
+
+    auto runMenu = [&](ssh_channel ch){
+        AllocScope appScope(ALLOC_APP);
+        SshLineReader reader;
+        printMenu(ch);
         while (ssh_channel_is_open(ch) && !ssh_channel_is_eof(ch)){
-            if (ssh_read_line(ch, buf, line, true)){
-                if (line == "quit"){
+            if (reader.poll(ch)){
+                const char* line = reader.line();
+                if (!strcmp(line, "quit")){
                     ssh_write_line(ch, "Goodbye.");
                     return false; // close session
                 }
-                if (line == "1"){
-                    runEchoMode(ch);
+                if (!strcmp(line, "1")){
+                    runEchoMode(ch, reader);
                     // show menu again after return
-                    ssh_write_line(ch, "=== ESP32 Apps ===");
-                    ssh_write_line(ch, "1) echo_mode");
-                    ssh_write_line(ch, "2) blinking_led");
-                    ssh_write_line(ch, "Type number and Enter to run, or 'quit' to disconnect.");
-                    ssh_write_str(ch, "> ");
-                } else if (line == "2"){
-                    runBlinkApp(ch);
-                    ssh_write_line(ch, "=== ESP32 Apps ===");
-                    ssh_write_line(ch, "1) echo_mode");
-                    ssh_write_line(ch, "2) blinking_led");
-                    ssh_write_line(ch, "Type number and Enter to run, or 'quit' to disconnect.");
-                    ssh_write_str(ch, "> ");
+                    printMenu(ch);
+                } else if (!strcmp(line, "2")){
+                    if (claimApp(ch, APP_BLINK)){
+                        runBlinkApp(ch, reader);
+                        appBusy[APP_BLINK] = false;
+                    }
+                    printMenu(ch);
+                } else if (!strcmp(line, "3")){
+                    if (claimApp(ch, APP_BENCH)){
+                        runBenchApp(ch, reader, info);
+                        appBusy[APP_BENCH] = false;
+                    }
+                    printMenu(ch);
+                } else if (!strcmp(line, "4")){
+                    runLogsApp(ch, reader);
+                    printMenu(ch);
+                } else if (!strcmp(line, "5")){
+                    static FreeRtosStatsProvider taskStats;
+                    if (claimApp(ch, APP_TOP)){
+                        runTopApp(ch, reader, taskStats);
+                        appBusy[APP_TOP] = false;
+                    }
+                    printMenu(ch);
+                } else if (!strcmp(line, "6")){
+                    if (claimApp(ch, APP_SERIAL)){
+                        runSerialApp(ch, reader);
+                        appBusy[APP_SERIAL] = false;
+                    }
+                    printMenu(ch);
+                } else if (!strcmp(line, "7")){
+                    runGpioApp(ch, reader, gpioDriver);
+                    printMenu(ch);
+                } else if (!strcmp(line, "8")){
+                    if (claimApp(ch, APP_SCRIPT)){
+                        runScriptApp(ch, reader);
+                        appBusy[APP_SCRIPT] = false;
+                    }
+                    printMenu(ch);
+                } else if (!strcmp(line, "9")){
+                    runRecorderApp(ch, reader);
+                    printMenu(ch);
+                } else if (!strcmp(line, "10")){
+                    runHistoryApp(ch, reader);
+                    printMenu(ch);
                 } else {
-                    ssh_write_line(ch, "Unknown option. Choose 1, 2 or 'quit'.");
+                    ssh_write_line(ch, "Unknown option. Choose 1-10 or 'quit'.");
                     ssh_write_str(ch, "> ");
                 }
             }
-            delay(10);
+            reader.wait(ch, 1000);
         }
         return false;
     };
 
-    // Run the menu; closing returns to caller and ends session
-    (void)runMenu(ch);
+    auto serveChannel = [&](ssh_channel ch, bool subsystem){
+        if (!subsystem) {
+            (void)runMenu(ch);
+        } else if (appBusy[APP_RPC]) {
+            LOGW("SSH", "RPC already running on another channel");
+        } else {
+            appBusy[APP_RPC] = true;
+            runRpcSubsystem(ch, stats);
+            appBusy[APP_RPC] = false;
+        }
+    };
+
+    // Run the menu (or serve RPC) on this channel; further channels the
+    // client opens on the connection run beside it until all are closed.
+    ChannelScheduler channels(sess, RPC_SUBSYSTEM, [](ssh_channel c, bool subsystem, void* fn){
+        (*(decltype(serveChannel)*)fn)(c, subsystem);
+    }, &serveChannel);
+    MemoryBudget::sample();
+    phase("ssh_serve");
+    channels.begin(ch);
+    serveChannel(ch, rpc);
+    channels.finish();
 
-    if (ch) ssh_channel_free(ch);
-    ssh_disconnect(sess);
-    ssh_free(sess);
-    Serial.println("Session closed");
+    logSessionStats();
+    closeSession(stats.completed, nullptr);
+    LOGI("SSH", "Session closed");
 }
@@ -3,17 +3,136 @@
 
 #include "libssh_esp32.h"
 #include <libssh/server.h>
+#include "AllocTracker.h"
+#include "MemoryBudget.h"
+
+// Algorithm preference lists offered during negotiation, most preferred first.
+// The ESP32 has AES and SHA-2 accelerators behind mbedTLS, so AES modes with
+// SHA-2 MACs go ahead of chacha20-poly1305, which libssh runs in software.
+// Override with -DSSH_CIPHERS="..." etc. in build_flags or via setAlgorithms().
+#ifndef SSH_CIPHERS
+#define SSH_CIPHERS "aes128-gcm@openssh.com,aes128-ctr,chacha20-poly1305@openssh.com,aes256-gcm@openssh.com,aes256-ctr"
+#endif
+#ifndef SSH_KEX
+#define SSH_KEX "curve25519-sha256,curve25519-sha256@libssh.org,ecdh-sha2-nistp256,diffie-hellman-group14-sha256"
+#endif
+#ifndef SSH_HMACS
+#define SSH_HMACS "hmac-sha2-256-etm@openssh.com,hmac-sha2-256,hmac-sha1"
+#endif
+
+// Delayed zlib@openssh.com compression, server->client only. PSRAM boards
+// only: libssh calls deflateInit() with zlib's fixed 15-bit window and
+// memLevel 8, ~262 KB per session, so a board without PSRAM never has the
+// heap and the offer is always skipped. Client->server stays uncompressed
+// because inflate must match the client's 32 KB window.
+#ifndef SSH_COMPRESSION
+#define SSH_COMPRESSION 0
+#endif
+#ifndef SSH_COMPRESSION_LEVEL
+#define SSH_COMPRESSION_LEVEL 1
+#endif
+// Heap that must remain free after the deflate state is allocated.
+#ifndef SSH_COMPRESSION_HEAP_RESERVE
+#define SSH_COMPRESSION_HEAP_RESERVE 32768
+#endif
+
+// Interactive latency mode: disable Nagle on session sockets so single-key
+// echo packets are not held back waiting for the client's delayed ACK.
+#ifndef SSH_INTERACTIVE_MODE
+#define SSH_INTERACTIVE_MODE 1
+#endif
+
+// Limits applied to each connection until its shell starts.
+#ifndef SSH_HANDSHAKE_TIMEOUT_S
+#define SSH_HANDSHAKE_TIMEOUT_S 15
+#endif
+#ifndef SSH_MAX_AUTH_ATTEMPTS
+#define SSH_MAX_AUTH_ATTEMPTS 6
+#endif
+
+// Keep the next ssh_session allocated and configured while the server is idle,
+// so an incoming connection goes straight to accept and key exchange. libssh
+// generates the KEX ephemeral key inside ssh_handle_key_exchange() with no
+// hook to supply one, so session setup is the part that can be moved off the
+// connection's critical path. Costs the idle session's heap between clients.
+#ifndef SSH_PREWARM_SESSION
+#define SSH_PREWARM_SESSION 1
+#endif
+
+// Connection outcome counters since boot (exported on the diag port).
+struct SshServerStats {
+    uint32_t accepted;
+    uint32_t acceptFailed;
+    uint32_t kexFailed;
+    uint32_t authFailed;
+    uint32_t dropped;      // client went away / timed out before the shell started
+    uint32_t completed;    // shell sessions that ran to the end
+    uint32_t prewarmed;    // accepts that used a session prepared while idle
+    uint32_t handshakes;   // successful key exchanges, and their summed phase times:
+    uint64_t setupUsTotal;     // ssh_new + options on the connection path
+    uint64_t acceptUsTotal;    // ssh_bind_accept
+    uint64_t kexUsTotal;       // ssh_handle_key_exchange
+    uint64_t wireInTotal;      // socket bytes of finished sessions
+    uint64_t wireOutTotal;
+};
+
+// Per-connection details handed to apps running on the session channel.
+struct SshSessionInfo {
+    ssh_session session;
+    struct ssh_counter_struct socketCounter; // bytes/packets on the wire
+    struct ssh_counter_struct rawCounter;    // payload bytes/packets before encryption
+    uint32_t handshakeUs;                    // TCP accept -> key exchange complete
+    uint32_t setupUs;                        // session allocation on the connection path
+    uint32_t acceptUs;                       // ssh_bind_accept
+    bool prewarmed;                          // session was prepared before the client arrived
+    uint32_t cpuStartUs;                     // ssh task run time when the session began
+    bool compressionOffered;                 // zlib@openssh.com offered for server->client
+    AllocTagStats allocStart[ALLOC_TAG_COUNT]; // heap accounting when the session began
+};
 
 class SshServer {
 public:
     SshServer(const char* host_key);
+    // Must be called before begin(); nullptr leaves that list at the libssh default.
+    void setAlgorithms(const char* ciphers, const char* kex, const char* hmacs);
+    // Must be called before begin(); level is the zlib level (1 fastest .. 9 smallest).
+    void setCompression(bool enabled, int level);
+    void setInteractiveMode(bool enabled) { interactive = enabled; }
     void begin();
     void handleClient();
+    // Listening socket, for callers that wait for connections themselves; -1 before begin().
+    int listenFd();
+    const SshServerStats& getStats() const { return stats; }
+    // Socket bytes of every session so far, the open one included.
+    void wireBytes(uint64_t& in, uint64_t& out) const;
+    // Session channels open right now; 0 while idle.
+    uint8_t openChannels() const;
+
+    // Run time of the calling task in run-time counter ticks (microseconds under
+    // ESP-IDF), or 0 when FreeRTOS run-time stats are compiled out. The counter
+    // is 32 bits and wraps after ~71 minutes: subtract two readings as uint32_t.
+    static uint32_t taskCpuUs();
 
 private:
     ssh_session session;
-    ssh_bind sshbind;
+    ssh_bind sshbind = nullptr;
     const char* host_key;
+    const char* ciphers = SSH_CIPHERS;
+    const char* kex = SSH_KEX;
+    const char* hmacs = SSH_HMACS;
+    bool compression = SSH_COMPRESSION;
+    int compressionLevel = SSH_COMPRESSION_LEVEL;
+    bool interactive = SSH_INTERACTIVE_MODE;
+    SshSessionInfo info;
+    SshServerStats stats = {};
+    ssh_session spare = nullptr;   // next session, prepared while idle
+    uint32_t recorderShed = 0;     // ring bytes of a recording stopped for memory
+    ssh_session newSession();
+    void prewarm();
+    BudgetLevel makeRoom();
+    void refuseLowMemory();
+    bool offerCompression(ssh_session sess);
+    void logSessionStats();
     static int auth_password(ssh_session session, const char *user, const char *password, void *userdata);
 };
 
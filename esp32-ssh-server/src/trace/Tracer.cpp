@@ -0,0 +1,79 @@
+#include "Tracer.h"
+#include <string.h>
+
+#if SSH_TRACE
+
+static_assert((SSH_TRACE_EVENTS & (SSH_TRACE_EVENTS - 1)) == 0, "SSH_TRACE_EVENTS must be a power of two");
+
+Tracer::Event Tracer::ring[SSH_TRACE_EVENTS];
+uint32_t Tracer::head = 0;
+volatile bool Tracer::paused = false;
+
+static portMUX_TYPE traceMux = portMUX_INITIALIZER_UNLOCKED;
+static TaskHandle_t taskHandles[SSH_TRACE_TASKS];
+static char taskNames[SSH_TRACE_TASKS][configMAX_TASK_NAME_LEN];
+static uint8_t taskCount = 0;
+
+// Index of the calling task, naming it on first use. Called under traceMux.
+static uint8_t taskIndex(){
+    TaskHandle_t self = xTaskGetCurrentTaskHandle();
+    for (uint8_t i = 0; i < taskCount; i++){
+        if (taskHandles[i] == self) return i;
+    }
+    if (taskCount == SSH_TRACE_TASKS) return SSH_TRACE_TASKS;
+    taskHandles[taskCount] = self;
+    strncpy(taskNames[taskCount], pcTaskGetName(self), configMAX_TASK_NAME_LEN - 1);
+    return taskCount++;
+}
+
+void Tracer::record(char phase, const char* name, uint16_t arg){
+    if (paused) return;
+    uint32_t us = micros();
+    portENTER_CRITICAL(&traceMux);
+    Event& ev = ring[head & (SSH_TRACE_EVENTS - 1)];
+    ev.us = us;
+    ev.name = name;
+    ev.phase = phase;
+    ev.task = taskIndex();
+    ev.arg = arg;
+    head++;
+    portEXIT_CRITICAL(&traceMux);
+}
+
+void Tracer::clear(){
+    portENTER_CRITICAL(&traceMux);
+    head = 0;
+    // Task slots are kept: a handle freed since may be reused, but by then
+    // its old events are gone too.
+    portEXIT_CRITICAL(&traceMux);
+}
+
+bool Tracer::next(uint32_t& cursor, Event& ev){
+    bool ok = false;
+    portENTER_CRITICAL(&traceMux);
+    uint32_t tail = head > SSH_TRACE_EVENTS ? head - SSH_TRACE_EVENTS : 0;
+    if (cursor < tail) cursor = tail; // older events were overwritten
+    if (cursor < head){
+        ev = ring[cursor & (SSH_TRACE_EVENTS - 1)];
+        cursor++;
+        ok = true;
+    }
+    portEXIT_CRITICAL(&traceMux);
+    return ok;
+}
+
+const char* Tracer::taskName(uint8_t task){
+    return task < taskCount ? taskNames[task] : "other";
+}
+
+Tracer::Stats Tracer::stats(){
+    Stats s;
+    portENTER_CRITICAL(&traceMux);
+    s.recorded = head;
+    s.overwritten = head > SSH_TRACE_EVENTS ? head - SSH_TRACE_EVENTS : 0;
+    s.tasks = taskCount;
+    portEXIT_CRITICAL(&traceMux);
+    return s;
+}
+
+#endif // SSH_TRACE
@@ -0,0 +1,79 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+#include <Arduino.h>
+
+// Timeline tracing: 0 compiles every TRACE_* site out.
+#ifndef SSH_TRACE
+#define SSH_TRACE 1
+#endif
+// Events kept; a power of two. 12 bytes each.
+#ifndef SSH_TRACE_EVENTS
+#define SSH_TRACE_EVENTS 512
+#endif
+// Distinct tasks named in a trace; later ones share one "other" track.
+#ifndef SSH_TRACE_TASKS
+#define SSH_TRACE_TASKS 12
+#endif
+
+// Fixed ring of begin/end/instant events, each stamped with micros() and the
+// task that recorded it, so the ssh task, Wi-Fi events, controlTask and the
+// apps can be laid side by side in Perfetto / chrome://tracing. Names must be
+// string literals: only the pointer is stored. Any task may record; a record
+// is a few stores under a spinlock. The oldest events are overwritten first.
+class Tracer {
+public:
+    struct Event {
+        uint32_t us;
+        const char* name;
+        char phase;         // 'B' begin, 'E' end, 'i' instant
+        uint8_t task;       // index for taskName()
+        uint16_t arg;
+    };
+    struct Stats {
+        uint32_t recorded;      // since clear()
+        uint32_t overwritten;
+        uint8_t tasks;
+    };
+
+    static void record(char phase, const char* name, uint16_t arg);
+    // Stop recording while the ring is being read out.
+    static void setPaused(bool paused) { Tracer::paused = paused; }
+    static bool isPaused() { return paused; }
+    static void clear();
+
+    // Walk events oldest first: start with cursor = 0.
+    static bool next(uint32_t& cursor, Event& ev);
+    static const char* taskName(uint8_t task);
+    static Stats stats();
+
+private:
+    static Event ring[SSH_TRACE_EVENTS];
+    static uint32_t head;       // events ever recorded since clear()
+    static volatile bool paused;
+};
+
+#if SSH_TRACE
+// Ends the span when the enclosing block is left, whichever way.
+class TraceScope {
+public:
+    explicit TraceScope(const char* name) : name(name) { Tracer::record('B', name, 0); }
+    ~TraceScope() { Tracer::record('E', name, 0); }
+private:
+    const char* name;
+};
+
+#define TRACE_BEGIN(name) Tracer::record('B', name, 0)
+#define TRACE_END(name) Tracer::record('E', name, 0)
+#define TRACE_INSTANT(name, arg) Tracer::record('i', name, (uint16_t)(arg))
+#define TRACE_CONCAT2(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT2(a, b)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCAT(traceScope, __LINE__)(name)
+#else
+#define TRACE_BEGIN(name) ((void)0)
+#define TRACE_END(name) ((void)0)
+#define TRACE_INSTANT(name, arg) ((void)0)
+#define TRACE_SCOPE(name) ((void)0)
+#endif
+
+#endif // TRACER_H
@@ -0,0 +1,42 @@
+#include "ArduinoWifiDriver.h"
+#include <WiFi.h>
+#include <Preferences.h>
+
+#define WIFI_PREFS_NS "wifi"
+#define WIFI_PREFS_KEY "cache"
+
+void ArduinoWifiDriver::begin(const char* ssid, const char* password, uint8_t channel, const uint8_t* bssid) {
+    WiFi.begin(ssid, password, channel, bssid);
+}
+
+void ArduinoWifiDriver::configIp(uint32_t ip, uint32_t gateway, uint32_t netmask, uint32_t dns) {
+    // WiFi.config() with a zero address re-enables the DHCP client.
+    WiFi.config(IPAddress(ip), IPAddress(gateway), IPAddress(netmask), IPAddress(dns));
+}
+
+uint32_t ArduinoWifiDriver::dnsIp() {
+    return (uint32_t)WiFi.dnsIP(0);
+}
+
+bool ArduinoWifiDriver::loadCache(WifiCache& cache) {
+    Preferences prefs;
+    if (!prefs.begin(WIFI_PREFS_NS, true)) return false;
+    bool ok = prefs.getBytesLength(WIFI_PREFS_KEY) == sizeof(cache) &&
+              prefs.getBytes(WIFI_PREFS_KEY, &cache, sizeof(cache)) == sizeof(cache);
+    prefs.end();
+    return ok;
+}
+
+void ArduinoWifiDriver::saveCache(const WifiCache& cache) {
+    Preferences prefs;
+    if (!prefs.begin(WIFI_PREFS_NS, false)) return;
+    prefs.putBytes(WIFI_PREFS_KEY, &cache, sizeof(cache));
+    prefs.end();
+}
+
+void ArduinoWifiDriver::eraseCache() {
+    Preferences prefs;
+    if (!prefs.begin(WIFI_PREFS_NS, false)) return;
+    prefs.remove(WIFI_PREFS_KEY);
+    prefs.end();
+}
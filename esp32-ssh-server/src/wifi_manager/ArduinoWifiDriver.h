@@ -0,0 +1,17 @@
+#ifndef ARDUINO_WIFI_DRIVER_H
+#define ARDUINO_WIFI_DRIVER_H
+
+#include "WifiManager.h"
+
+// Arduino WiFi plus Preferences namespace "wifi".
+class ArduinoWifiDriver : public WifiDriver {
+public:
+    void begin(const char* ssid, const char* password, uint8_t channel, const uint8_t* bssid) override;
+    void configIp(uint32_t ip, uint32_t gateway, uint32_t netmask, uint32_t dns) override;
+    uint32_t dnsIp() override;
+    bool loadCache(WifiCache& cache) override;
+    void saveCache(const WifiCache& cache) override;
+    void eraseCache() override;
+};
+
+#endif // ARDUINO_WIFI_DRIVER_H
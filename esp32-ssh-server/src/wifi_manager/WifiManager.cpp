@@ -1,18 +1,94 @@
 #include "WifiManager.h"
 #include <Arduino.h>
+#include <string.h>
+#include "Logger.h"
 
-WifiManager::WifiManager() {
-    // Constructor
+WifiManager::WifiManager(WifiDriver& driver) : driver(driver) {}
+
+const char* WifiManager::strategyName(WifiStrategy s) {
+    return s == WIFI_CACHED ? "cached" : "scan";
 }
 
 void WifiManager::connect(const char* ssid, const char* password) {
-    WiFi.begin(ssid, password);
-    Serial.print("Connecting to WiFi...");
-    while (WiFi.status() != WL_CONNECTED) {
-        delay(500);
-        Serial.print(".");
+    if (!cacheLoaded) {
+        cacheLoaded = true;
+        cacheValid = driver.loadCache(cache) && cache.channel != 0;
+    }
+    current = cacheValid && !skipCache ? WIFI_CACHED : WIFI_FULL_SCAN;
+    stats[current].attempts++;
+    joining = true;
+    startMs = millis();
+    if (current == WIFI_CACHED) {
+        if (WIFI_CACHE_LEASE && cache.ip) driver.configIp(cache.ip, cache.gateway, cache.netmask, cache.dns);
+        else driver.configIp(0, 0, 0, 0);
+        driver.begin(ssid, password, cache.channel, cache.bssid);
+        // One %s instead of six bytes: the logger keeps LOG_MAX_ARGS words.
+        char bssid[18];
+        snprintf(bssid, sizeof(bssid), "%02x:%02x:%02x:%02x:%02x:%02x",
+                 cache.bssid[0], cache.bssid[1], cache.bssid[2], cache.bssid[3], cache.bssid[4], cache.bssid[5]);
+        LOGI("WIFI", "Rejoining %s on channel %u%s", bssid, (unsigned)cache.channel,
+             WIFI_CACHE_LEASE && cache.ip ? " with cached lease" : "");
+    } else {
+        driver.configIp(0, 0, 0, 0);
+        driver.begin(ssid, password, 0, nullptr);
+        LOGI("WIFI", "Connecting to WiFi (full scan)...");
+    }
+}
+
+void WifiManager::onConnected(const uint8_t bssid[6], uint8_t channel) {
+    memcpy(joinedBssid, bssid, sizeof(joinedBssid));
+    joinedChannel = channel;
+}
+
+void WifiManager::onGotIp(uint32_t ip, uint32_t gateway, uint32_t netmask) {
+    if (!joining) return; // lease renewal or address change on a live link
+    joining = false;
+    skipCache = false;
+    WifiJoinStats& s = stats[current];
+    s.joined++;
+    s.lastMs = millis() - startMs;
+    s.totalMs += s.lastMs;
+    LOGI("WIFI", "Got IP in %u ms (%s)", (unsigned)s.lastMs, strategyName(current));
+
+    // Refresh the cache only when something changed, to spare the flash.
+    WifiCache fresh = {};
+    memcpy(fresh.bssid, joinedBssid, sizeof(fresh.bssid));
+    fresh.channel = joinedChannel;
+    if (WIFI_CACHE_LEASE) {
+        fresh.ip = ip;
+        fresh.gateway = gateway;
+        fresh.netmask = netmask;
+        fresh.dns = current == WIFI_CACHED ? cache.dns : driver.dnsIp();
+    }
+    if (fresh.channel && (!cacheValid || memcmp(&fresh, &cache, sizeof(fresh)) != 0)) {
+        cache = fresh;
+        cacheValid = true;
+        driver.saveCache(cache);
+        LOGI("WIFI", "Cached BSSID/channel %u%s", (unsigned)cache.channel, WIFI_CACHE_LEASE ? " and lease" : "");
+    }
+}
+
+void WifiManager::onDisconnected(uint8_t reason) {
+    if (!joining || current != WIFI_CACHED) return;
+    // The AP moved, changed channel or refused the cached join: scan next
+    // time, and drop the entry so a reboot does not retry it either.
+    LOGW("WIFI", "Cached rejoin failed (reason %u); falling back to a full scan", (unsigned)reason);
+    skipCache = true;
+    cacheValid = false;
+    driver.eraseCache();
+}
+
+size_t WifiManager::format(char* out, size_t len) const {
+    size_t n = 0;
+    for (int i = 0; i < WIFI_STRATEGY_COUNT; i++) {
+        const WifiJoinStats& s = stats[i];
+        const char* name = strategyName((WifiStrategy)i);
+        int w = snprintf(out + n, len - n, "%swifi_%s_attempts=%u wifi_%s_joined=%u wifi_%s_last_ms=%u wifi_%s_avg_ms=%u",
+                         i ? " " : "", name, (unsigned)s.attempts, name, (unsigned)s.joined,
+                         name, (unsigned)s.lastMs, name, (unsigned)(s.joined ? s.totalMs / s.joined : 0));
+        if (w < 0) break;
+        n += (size_t)w < len - n ? (size_t)w : len - n - 1;
+        if (n + 1 >= len) break;
     }
-    Serial.println("\nConnected to WiFi");
-    Serial.print("IP Address: ");
-    Serial.println(WiFi.localIP());
+    return n;
 }
@@ -1,12 +1,85 @@
 #ifndef WIFI_MANAGER_H
 #define WIFI_MANAGER_H
 
-#include <WiFi.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// Rejoin with the last good BSSID/channel (no scan) and, when
+// WIFI_CACHE_LEASE is set, the last DHCP lease as a static config (no DHCP
+// round trip). A cached attempt that fails falls back to a full scan with
+// DHCP, and the cache is refreshed from whichever join succeeds. A reused
+// lease is never renewed, so once it expires on the server the address can
+// be handed to another station: only enable it for an address the AP
+// reserves for this station (a DHCP reservation).
+#ifndef WIFI_CACHE_LEASE
+#define WIFI_CACHE_LEASE 0
+#endif
+
+// What a join needs to skip the scan and DHCP; persisted in NVS.
+struct WifiCache {
+    uint8_t bssid[6];
+    uint8_t channel;
+    uint32_t ip, gateway, netmask, dns;     // network byte order, 0 = none
+};
+
+enum WifiStrategy : uint8_t {
+    WIFI_CACHED,        // directed join with the cached BSSID/channel/lease
+    WIFI_FULL_SCAN,     // plain WiFi.begin(): scan all channels, then DHCP
+    WIFI_STRATEGY_COUNT
+};
+
+// Time-to-IP per strategy since boot.
+struct WifiJoinStats {
+    uint32_t attempts;
+    uint32_t joined;        // attempts that reached an IPv4 address
+    uint32_t lastMs;        // connect() -> got IP, last success
+    uint32_t totalMs;
+};
+
+// Radio and storage behind WifiManager, so the rejoin/fallback logic does
+// not depend on the Arduino WiFi class (see ArduinoWifiDriver.h).
+class WifiDriver {
+public:
+    virtual ~WifiDriver() {}
+    // channel 0 / bssid nullptr: scan for the SSID.
+    virtual void begin(const char* ssid, const char* password, uint8_t channel, const uint8_t* bssid) = 0;
+    // All zero: DHCP.
+    virtual void configIp(uint32_t ip, uint32_t gateway, uint32_t netmask, uint32_t dns) = 0;
+    virtual uint32_t dnsIp() = 0;
+    virtual bool loadCache(WifiCache& cache) = 0;
+    virtual void saveCache(const WifiCache& cache) = 0;
+    virtual void eraseCache() = 0;
+};
 
 class WifiManager {
 public:
-    WifiManager();
+    explicit WifiManager(WifiDriver& driver);
+    // Starts association and returns; completion arrives as WiFi/IP events,
+    // which the event handler forwards to the on*() calls below. Picks the
+    // cached strategy unless the last cached attempt failed.
     void connect(const char* ssid, const char* password);
+    void onConnected(const uint8_t bssid[6], uint8_t channel);
+    void onGotIp(uint32_t ip, uint32_t gateway, uint32_t netmask);
+    void onDisconnected(uint8_t reason);
+
+    WifiStrategy strategy() const { return current; }
+    const WifiJoinStats& joinStats(WifiStrategy s) const { return stats[s]; }
+    static const char* strategyName(WifiStrategy s);
+    // "wifi_<strategy>_attempts=.. _joined=.. _last_ms=.. _avg_ms=.." for the diag port.
+    size_t format(char* out, size_t len) const;
+
+private:
+    WifiDriver& driver;
+    WifiCache cache = {};
+    bool cacheLoaded = false;
+    bool cacheValid = false;
+    bool skipCache = false;         // last cached attempt failed; scan next time
+    bool joining = false;           // connect() issued, no IP yet
+    WifiStrategy current = WIFI_FULL_SCAN;
+    uint32_t startMs = 0;
+    uint8_t joinedBssid[6] = {};
+    uint8_t joinedChannel = 0;
+    WifiJoinStats stats[WIFI_STRATEGY_COUNT] = {};
 };
 
 #endif // WIFI_MANAGER_H
@@ -0,0 +1,28 @@
+#ifndef NATIVE_ARDUINO_H
+#define NATIVE_ARDUINO_H
+
+// Host stand-in for the parts of the Arduino core the units under test use.
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+
+inline unsigned long millis(){ return (unsigned long)(esp_timer_get_time() / 1000); }
+inline unsigned long micros(){ return (unsigned long)esp_timer_get_time(); }
+
+// A 240 MHz CPU whose cycle counter follows the host clock.
+struct NativeEsp {
+    uint32_t getCpuFreqMHz(){ return 240; }
+    uint32_t getCycleCount(){ return (uint32_t)(esp_timer_get_time() * 240); }
+};
+inline NativeEsp& nativeEsp(){
+    static NativeEsp esp;
+    return esp;
+}
+#define ESP nativeEsp()
+
+#endif // NATIVE_ARDUINO_H
@@ -0,0 +1,13 @@
+#ifndef NATIVE_ETS_SYS_H
+#define NATIVE_ETS_SYS_H
+
+#include <stdint.h>
+#include "esp_timer.h"
+
+// The ROM busy-wait, spinning on the host clock.
+inline void ets_delay_us(uint32_t us){
+    int64_t end = esp_timer_get_time() + us;
+    while (esp_timer_get_time() < end) {}
+}
+
+#endif // NATIVE_ETS_SYS_H
@@ -0,0 +1,62 @@
+#ifndef NATIVE_ESP_HEAP_CAPS_H
+#define NATIVE_ESP_HEAP_CAPS_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+// A heap of fixed capacity for host builds. heap_caps_malloc() fails past
+// the capacity or the largest-block cap, and the figures the firmware reads
+// (free, largest block, all-time minimum) follow what a test allocates.
+#define MALLOC_CAP_8BIT (1 << 2)
+
+struct NativeHeap {
+    size_t capacity, used, largestCap, minimumFree;
+};
+
+inline NativeHeap& nativeHeap(){
+    static NativeHeap heap = { 256 * 1024, 0, 112 * 1024, 256 * 1024 };
+    return heap;
+}
+
+// Start over with an empty heap, as after a reboot. `largestBlock` caps the
+// largest free block to model fragmentation.
+inline void nativeHeapReset(size_t capacity, size_t largestBlock){
+    NativeHeap& h = nativeHeap();
+    h.capacity = capacity;
+    h.used = 0;
+    h.largestCap = largestBlock;
+    h.minimumFree = capacity;
+}
+
+inline size_t heap_caps_get_free_size(uint32_t caps){
+    const NativeHeap& h = nativeHeap();
+    return h.capacity - h.used;
+}
+
+inline size_t heap_caps_get_largest_free_block(uint32_t caps){
+    size_t free = heap_caps_get_free_size(caps);
+    return free < nativeHeap().largestCap ? free : nativeHeap().largestCap;
+}
+
+inline size_t heap_caps_get_minimum_free_size(uint32_t caps){ return nativeHeap().minimumFree; }
+
+inline void* heap_caps_malloc(size_t size, uint32_t caps){
+    NativeHeap& h = nativeHeap();
+    if (size > heap_caps_get_largest_free_block(caps)) return nullptr;
+    size_t* block = (size_t*)malloc(sizeof(size_t) + size);
+    if (!block) return nullptr;
+    block[0] = size;
+    h.used += size;
+    if (h.capacity - h.used < h.minimumFree) h.minimumFree = h.capacity - h.used;
+    return block + 1;
+}
+
+inline void heap_caps_free(void* ptr){
+    if (!ptr) return;
+    size_t* block = (size_t*)ptr - 1;
+    nativeHeap().used -= block[0];
+    free(block);
+}
+
+#endif // NATIVE_ESP_HEAP_CAPS_H
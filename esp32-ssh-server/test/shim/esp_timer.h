@@ -0,0 +1,29 @@
+#ifndef NATIVE_ESP_TIMER_H
+#define NATIVE_ESP_TIMER_H
+
+#include <stdint.h>
+#include <time.h>
+
+// Host clock: monotonic time since the first call, plus whatever a test
+// added with nativeAdvanceMs() to step past a timeout without sleeping.
+inline int64_t& nativeClockSkewUs(){
+    static int64_t skew = 0;
+    return skew;
+}
+
+typedef struct esp_timer* esp_timer_handle_t;
+
+inline void nativeAdvanceMs(uint32_t ms){ nativeClockSkewUs() += (int64_t)ms * 1000; }
+
+inline int64_t esp_timer_get_time(){
+    struct Origin {
+        timespec t;
+        Origin(){ clock_gettime(CLOCK_MONOTONIC, &t); }
+    };
+    static const Origin origin;
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)(now.tv_sec - origin.t.tv_sec) * 1000000 + (now.tv_nsec - origin.t.tv_nsec) / 1000 + nativeClockSkewUs();
+}
+
+#endif // NATIVE_ESP_TIMER_H
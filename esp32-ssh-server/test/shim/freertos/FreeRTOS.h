@@ -0,0 +1,27 @@
+#ifndef NATIVE_FREERTOS_H
+#define NATIVE_FREERTOS_H
+
+#include <stdint.h>
+
+// FreeRTOS types and constants for host builds; one tick is one millisecond.
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+typedef uint32_t TickType_t;
+
+#define pdFALSE 0
+#define pdTRUE 1
+#define pdPASS 1
+#define pdFAIL 0
+#define portMAX_DELAY 0xffffffffu
+#define portTICK_PERIOD_MS 1
+#define configMAX_TASK_NAME_LEN 16
+#define portNUM_PROCESSORS 2
+
+// Critical sections guard register access on the target; host tests that
+// use them run the unit on one thread.
+typedef int portMUX_TYPE;
+#define portMUX_INITIALIZER_UNLOCKED 0
+#define portENTER_CRITICAL(mux) ((void)(mux))
+#define portEXIT_CRITICAL(mux) ((void)(mux))
+
+#endif // NATIVE_FREERTOS_H
@@ -0,0 +1,98 @@
+#ifndef NATIVE_FREERTOS_TASK_H
+#define NATIVE_FREERTOS_TASK_H
+
+#include "FreeRTOS.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+// FreeRTOS tasks as host threads, with a task's notification count kept
+// under its own mutex. Priorities and cores are not modelled.
+typedef void (*TaskFunction_t)(void*);
+
+struct NativeTask {
+    pthread_t thread;
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t notified;
+    TaskFunction_t fn;
+    void* arg;
+    char name[configMAX_TASK_NAME_LEN];
+};
+typedef NativeTask* TaskHandle_t;
+
+inline NativeTask* nativeTaskNew(){
+    NativeTask* t = new NativeTask();
+    pthread_mutex_init(&t->lock, nullptr);
+    pthread_cond_init(&t->cond, nullptr);
+    strcpy(t->name, "main");
+    return t;
+}
+
+inline NativeTask*& nativeTaskSelf(){
+    static thread_local NativeTask* self = nullptr;
+    return self;
+}
+
+inline void* nativeTaskEntry(void* arg){
+    NativeTask* t = (NativeTask*)arg;
+    nativeTaskSelf() = t;
+    t->fn(t->arg);
+    return nullptr;
+}
+
+inline BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char* name, uint32_t stackDepth, void* arg,
+                                          UBaseType_t priority, TaskHandle_t* created, BaseType_t core){
+    NativeTask* t = nativeTaskNew();
+    t->fn = fn;
+    t->arg = arg;
+    snprintf(t->name, sizeof(t->name), "%s", name);
+    if (pthread_create(&t->thread, nullptr, nativeTaskEntry, t) != 0){
+        delete t;
+        return pdFAIL;
+    }
+    pthread_detach(t->thread);
+    if (created) *created = t;
+    return pdPASS;
+}
+
+inline TaskHandle_t xTaskGetCurrentTaskHandle(){
+    NativeTask*& self = nativeTaskSelf();
+    if (!self) self = nativeTaskNew();
+    return self;
+}
+
+// Only deleting the calling task is supported.
+inline void vTaskDelete(TaskHandle_t task){
+    delete xTaskGetCurrentTaskHandle();
+    pthread_exit(nullptr);
+}
+
+inline BaseType_t xTaskNotifyGive(TaskHandle_t task){
+    pthread_mutex_lock(&task->lock);
+    task->notified++;
+    pthread_cond_signal(&task->cond);
+    pthread_mutex_unlock(&task->lock);
+    return pdPASS;
+}
+
+// Blocks without a time limit whatever `ticks` says.
+inline uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks){
+    NativeTask* self = xTaskGetCurrentTaskHandle();
+    pthread_mutex_lock(&self->lock);
+    while (!self->notified) pthread_cond_wait(&self->cond, &self->lock);
+    uint32_t n = self->notified;
+    self->notified = clearOnExit ? 0 : n - 1;
+    pthread_mutex_unlock(&self->lock);
+    return n;
+}
+
+// Threads that were not created as tasks are named "main".
+inline char* pcTaskGetName(TaskHandle_t task){ return (task ? task : xTaskGetCurrentTaskHandle())->name; }
+
+inline void vTaskDelay(TickType_t ticks){ usleep((useconds_t)ticks * 1000 * portTICK_PERIOD_MS); }
+inline UBaseType_t uxTaskPriorityGet(TaskHandle_t task){ return 1; }
+inline BaseType_t xPortGetCoreID(){ return 0; }
+
+#endif // NATIVE_FREERTOS_TASK_H
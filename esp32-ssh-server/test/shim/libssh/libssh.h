@@ -0,0 +1,66 @@
+#ifndef NATIVE_LIBSSH_H
+#define NATIVE_LIBSSH_H
+
+// The slice of the libssh API the units under test call, with libssh's own
+// names and values. Nothing here is defined: each test supplies a fake
+// session, channel and message, and the functions over them.
+#include <stdint.h>
+
+typedef struct ssh_session_struct* ssh_session;
+typedef struct ssh_channel_struct* ssh_channel;
+typedef struct ssh_message_struct* ssh_message;
+
+#define SSH_OK 0
+#define SSH_ERROR (-1)
+#define SSH_AGAIN (-2)
+#define SSH_EOF (-127)
+
+enum ssh_requests_e {
+    SSH_REQUEST_AUTH = 1,
+    SSH_REQUEST_CHANNEL_OPEN,
+    SSH_REQUEST_CHANNEL,
+    SSH_REQUEST_SERVICE,
+    SSH_REQUEST_GLOBAL
+};
+
+enum ssh_channel_type_e {
+    SSH_CHANNEL_UNKNOWN = 0,
+    SSH_CHANNEL_SESSION,
+    SSH_CHANNEL_DIRECT_TCPIP,
+    SSH_CHANNEL_FORWARDED_TCPIP,
+    SSH_CHANNEL_X11,
+    SSH_CHANNEL_AUTH_AGENT
+};
+
+enum ssh_channel_requests_e {
+    SSH_CHANNEL_REQUEST_UNKNOWN = 0,
+    SSH_CHANNEL_REQUEST_PTY,
+    SSH_CHANNEL_REQUEST_EXEC,
+    SSH_CHANNEL_REQUEST_SHELL,
+    SSH_CHANNEL_REQUEST_ENV,
+    SSH_CHANNEL_REQUEST_SUBSYSTEM,
+    SSH_CHANNEL_REQUEST_WINDOW_CHANGE,
+    SSH_CHANNEL_REQUEST_X11
+};
+
+typedef int (*ssh_message_callback)(ssh_session session, ssh_message msg, void* data);
+
+void ssh_set_message_callback(ssh_session session, ssh_message_callback callback, void* data);
+int ssh_execute_message_callbacks(ssh_session session);
+int ssh_get_fd(ssh_session session);
+int ssh_is_connected(ssh_session session);
+
+int ssh_channel_poll(ssh_channel channel, int is_stderr);
+int ssh_channel_is_open(ssh_channel channel);
+int ssh_channel_is_eof(ssh_channel channel);
+int ssh_channel_close(ssh_channel channel);
+void ssh_channel_free(ssh_channel channel);
+
+int ssh_message_type(ssh_message msg);
+int ssh_message_subtype(ssh_message msg);
+ssh_channel ssh_message_channel_request_open_reply_accept(ssh_message msg);
+ssh_channel ssh_message_channel_request_channel(ssh_message msg);
+int ssh_message_channel_request_reply_success(ssh_message msg);
+const char* ssh_message_channel_request_subsystem(ssh_message msg);
+
+#endif // NATIVE_LIBSSH_H
@@ -0,0 +1,15 @@
+#ifndef NATIVE_LWIP_SOCKETS_H
+#define NATIVE_LWIP_SOCKETS_H
+
+// lwIP mirrors the BSD socket API; on the host it is the real one.
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/select.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+
+#define closesocket(s) close(s)
+
+#endif // NATIVE_LWIP_SOCKETS_H
@@ -0,0 +1,19 @@
+#ifndef NATIVE_LOGGER_H
+#define NATIVE_LOGGER_H
+
+// Logger::write for host tests: prints at once instead of queueing for a
+// drain task. Include from exactly one file of each test program.
+#include "Logger.h"
+#include <stdarg.h>
+
+void Logger::write(LogLevel level, const char* tag, const char* fmt, ...){
+    static const char LEVEL_CHARS[] = { 'E', 'W', 'I', 'D' };
+    va_list ap;
+    va_start(ap, fmt);
+    printf("%c [%s] ", LEVEL_CHARS[level & 3], tag);
+    vprintf(fmt, ap);
+    printf("\n");
+    va_end(ap);
+}
+
+#endif // NATIVE_LOGGER_H
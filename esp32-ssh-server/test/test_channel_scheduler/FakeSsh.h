@@ -0,0 +1,161 @@
+#ifndef FAKE_SSH_H
+#define FAKE_SSH_H
+
+#include <libssh/libssh.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <string>
+#include <vector>
+
+// One client-side event: a channel message, channel data, the client closing
+// a channel or the whole connection dropping.
+struct FakeStep {
+    enum Kind { OPEN, SHELL, SUBSYSTEM, DATA, CLOSE, DISCONNECT };
+    Kind kind;
+    int channel;            // index into FakeSsh::channels; 0 is the first channel, -1 all (DATA)
+    const char* text;       // subsystem name or data
+};
+
+struct ssh_channel_struct {
+    std::string in, out;    // client to app, app to client
+    bool open = true;
+    bool closed = false;    // ssh_channel_close() called
+    bool freed = false;
+};
+
+struct ssh_message_struct {
+    int type, subtype;
+    ssh_channel channel;
+    const char* subsystem;
+};
+
+struct ssh_session_struct {
+    ssh_message_callback callback = nullptr;
+    void* callbackData = nullptr;
+    bool connected = true;
+};
+
+// A scripted client over a fake libssh. Every step puts one byte in a pipe
+// whose read end is the session socket, and each ssh_execute_message_callbacks()
+// applies one step: the scheduler under test sees the socket readable exactly
+// while steps remain, and every step is handled before the next one arrives.
+class FakeSsh {
+public:
+    ssh_session_struct session;
+    std::vector<ssh_channel> channels;      // accepted, in order; [0] is the first
+    uint32_t refusedOpens = 0, refusedRequests = 0;
+    bool usedAfterFree = false;
+
+    explicit FakeSsh(const std::vector<FakeStep>& script) : script(script) {
+        if (pipe(wake) == 0) fcntl(wake[0], F_SETFL, O_NONBLOCK);
+        channels.push_back(new ssh_channel_struct());
+        for (size_t i = 0; i < script.size(); i++){
+            char b = 1;
+            if (write(wake[1], &b, 1) != 1) break;
+        }
+        current() = this;
+    }
+    ~FakeSsh(){
+        for (size_t i = 0; i < channels.size(); i++) delete channels[i];
+        close(wake[0]);
+        close(wake[1]);
+        current() = nullptr;
+    }
+
+    static FakeSsh*& current(){
+        static FakeSsh* fake = nullptr;
+        return fake;
+    }
+
+    int fd() const { return wake[0]; }
+
+    void applyNext(){
+        char b;
+        if (read(wake[0], &b, 1) != 1 || next >= script.size()) return;
+        const FakeStep& step = script[next++];
+        ssh_channel ch = step.channel < 0 || step.kind == FakeStep::OPEN || step.kind == FakeStep::DISCONNECT ?
+                         nullptr : channels[step.channel];
+        switch (step.kind){
+        case FakeStep::OPEN: {
+            ssh_message_struct m = { SSH_REQUEST_CHANNEL_OPEN, SSH_CHANNEL_SESSION, nullptr, nullptr };
+            if (session.callback(&session, &m, session.callbackData)) refusedOpens++;
+            break;
+        }
+        case FakeStep::SHELL:
+        case FakeStep::SUBSYSTEM: {
+            ssh_message_struct m = { SSH_REQUEST_CHANNEL,
+                                     step.kind == FakeStep::SHELL ? SSH_CHANNEL_REQUEST_SHELL : SSH_CHANNEL_REQUEST_SUBSYSTEM,
+                                     ch, step.text };
+            if (session.callback(&session, &m, session.callbackData)) refusedRequests++;
+            break;
+        }
+        case FakeStep::DATA:
+            if (ch) ch->in += step.text;
+            else for (size_t i = 0; i < channels.size(); i++) if (channels[i]->open) channels[i]->in += step.text;
+            break;
+        case FakeStep::CLOSE:
+            ch->open = false;
+            break;
+        case FakeStep::DISCONNECT:
+            session.connected = false;
+            for (size_t i = 0; i < channels.size(); i++) channels[i]->open = false;
+            break;
+        }
+    }
+
+private:
+    std::vector<FakeStep> script;
+    size_t next = 0;
+    int wake[2];
+};
+
+void ssh_set_message_callback(ssh_session session, ssh_message_callback callback, void* data){
+    session->callback = callback;
+    session->callbackData = data;
+}
+
+int ssh_execute_message_callbacks(ssh_session){
+    FakeSsh::current()->applyNext();
+    return SSH_OK;
+}
+
+int ssh_get_fd(ssh_session){ return FakeSsh::current()->fd(); }
+int ssh_is_connected(ssh_session session){ return session->connected; }
+
+int ssh_channel_poll(ssh_channel channel, int){
+    if (channel->freed) FakeSsh::current()->usedAfterFree = true;
+    if (!channel->in.empty()) return (int)channel->in.size();
+    return channel->open ? 0 : SSH_EOF;
+}
+
+int ssh_channel_is_open(ssh_channel channel){
+    if (channel->freed) FakeSsh::current()->usedAfterFree = true;
+    return channel->open;
+}
+
+int ssh_channel_close(ssh_channel channel){
+    channel->open = false;
+    channel->closed = true;
+    return SSH_OK;
+}
+
+// The fake owns its channels, so a freed one stays readable for the checks.
+void ssh_channel_free(ssh_channel channel){
+    if (channel->freed) FakeSsh::current()->usedAfterFree = true;
+    channel->freed = true;
+}
+
+int ssh_message_type(ssh_message msg){ return msg->type; }
+int ssh_message_subtype(ssh_message msg){ return msg->subtype; }
+
+ssh_channel ssh_message_channel_request_open_reply_accept(ssh_message){
+    ssh_channel ch = new ssh_channel_struct();
+    FakeSsh::current()->channels.push_back(ch);
+    return ch;
+}
+
+ssh_channel ssh_message_channel_request_channel(ssh_message msg){ return msg->channel; }
+int ssh_message_channel_request_reply_success(ssh_message){ return SSH_OK; }
+const char* ssh_message_channel_request_subsystem(ssh_message msg){ return msg->subsystem; }
+
+#endif // FAKE_SSH_H
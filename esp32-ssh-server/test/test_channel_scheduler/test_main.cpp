@@ -0,0 +1,193 @@
+// Host tests for running several channels of one session: pio test -e native
+#define SSH_TRACE 0
+#define SSH_SESSION_LINGER_MS 200
+#include <unity.h>
+#include <atomic>
+#include "FakeSsh.h"
+#include "native_logger.h"
+
+// The native env builds nothing under src/; the units under test come in here.
+#include "ChannelScheduler.cpp"
+#include "MemoryBudget.cpp"
+#include "Reactor.cpp"
+
+// Linked by ChannelScheduler.cpp but outside this test: the session
+// recorder, which stays disabled.
+uint8_t* SessionRecorder::ring = nullptr;
+void SessionRecorder::marker(const char*){}
+
+static const char* SUBSYSTEM = "esp-rpc";
+
+void setUp(){ nativeHeapReset(256 * 1024, 112 * 1024); }
+void tearDown(){}
+
+// Apps between two waits, and the most seen at once. Tallied here rather
+// than asserted, since apps after the first run on their own threads.
+static std::atomic<int> appsRunning(0), appsMaxRunning(0);
+
+static void appEnter(){
+    int n = ++appsRunning;
+    int seen = appsMaxRunning;
+    while (n > seen && !appsMaxRunning.compare_exchange_weak(seen, n)) {}
+}
+
+// Echoes every read as "S:<data>;" (shell) or "R:<data>;" (subsystem) and
+// returns on "q" or once the client closed the channel.
+static void echoApp(ssh_channel ch, bool subsystem, void*){
+    appEnter();
+    for (;;){
+        if (!ch->in.empty()){
+            std::string data;
+            data.swap(ch->in);
+            ch->out += (subsystem ? "R:" : "S:") + data + ";";
+            if (data == "q") break;
+        }
+        if (!ch->open) break;
+        appsRunning--;
+        ChannelScheduler::active()->wait(ch, -1, nullptr, 0);
+        appEnter();
+    }
+    appsRunning--;
+}
+
+// Like echoApp, marking with '*' each read that came with the channel's own
+// socket-readable stamp.
+static void stampApp(ssh_channel ch, bool, void*){
+    for (;;){
+        int64_t readyUs = ChannelScheduler::active()->takeInputReady(ch);
+        if (!ch->in.empty()){
+            std::string data;
+            data.swap(ch->in);
+            ch->out += data + (readyUs ? "*;" : ";");
+            if (data == "q") break;
+        }
+        if (!ch->open) break;
+        ChannelScheduler::active()->wait(ch, -1, nullptr, 0);
+    }
+}
+
+// Serves a session the way the SSH server does: the first channel's app on
+// this thread, then finish(). Returns how long finish() took in ms.
+static uint32_t serve(FakeSsh& fake, ChannelScheduler& sched, ChannelScheduler::ChannelMain app = echoApp){
+    appsMaxRunning = 0;
+    sched.begin(fake.channels[0]);
+    app(fake.channels[0], false, nullptr);
+    uint32_t t0 = millis();
+    sched.finish();
+    return millis() - t0;
+}
+
+static void test_channels_take_turns(){
+    std::vector<FakeStep> script = {
+        { FakeStep::OPEN, 0, nullptr },                 // channel 1
+        { FakeStep::SHELL, 1, nullptr },
+        { FakeStep::DATA, 1, "a" },
+        { FakeStep::DATA, 0, "x" },
+        { FakeStep::OPEN, 0, nullptr },                 // channel 2
+        { FakeStep::SUBSYSTEM, 2, SUBSYSTEM },
+        { FakeStep::DATA, 2, "r1" },
+        { FakeStep::OPEN, 0, nullptr },                 // channel 3, never started
+        { FakeStep::SUBSYSTEM, 3, "bogus" },
+        { FakeStep::OPEN, 0, nullptr },                 // one past SSH_MAX_CHANNELS
+        { FakeStep::CLOSE, 3, nullptr },
+        { FakeStep::DATA, 1, "b" },
+        { FakeStep::CLOSE, 1, nullptr },
+        { FakeStep::DATA, 0, "q" },
+        { FakeStep::DATA, 2, "r2" },
+        { FakeStep::DATA, 2, "q" },
+        { FakeStep::OPEN, 0, nullptr },                 // channel 4, while lingering
+        { FakeStep::SHELL, 4, nullptr },
+        { FakeStep::DATA, 4, "late" },
+        { FakeStep::DATA, 4, "q" },
+    };
+    FakeSsh fake(script);
+    ChannelScheduler sched(&fake.session, SUBSYSTEM, echoApp, nullptr);
+    uint32_t finishMs = serve(fake, sched);
+
+    TEST_ASSERT_EQUAL_INT(1, appsMaxRunning.load());
+    TEST_ASSERT_EQUAL_size_t(5, fake.channels.size());
+    TEST_ASSERT_EQUAL_STRING("S:x;S:q;", fake.channels[0]->out.c_str());
+    TEST_ASSERT_EQUAL_STRING("S:a;S:b;", fake.channels[1]->out.c_str());
+    TEST_ASSERT_EQUAL_STRING("R:r1;R:r2;R:q;", fake.channels[2]->out.c_str());
+    TEST_ASSERT_EQUAL_STRING("", fake.channels[3]->out.c_str());
+    TEST_ASSERT_EQUAL_STRING("S:late;S:q;", fake.channels[4]->out.c_str());
+    TEST_ASSERT_EQUAL_UINT32(1, fake.refusedOpens);
+    TEST_ASSERT_EQUAL_UINT32(1, fake.refusedRequests);
+
+    // The first channel belongs to the server; every other one is released here.
+    TEST_ASSERT_TRUE(fake.channels[0]->closed);
+    TEST_ASSERT_FALSE(fake.channels[0]->freed);
+    for (size_t i = 1; i < fake.channels.size(); i++) TEST_ASSERT_TRUE(fake.channels[i]->freed);
+    TEST_ASSERT_FALSE(fake.usedAfterFree);
+
+    TEST_ASSERT_EQUAL_UINT8(5, sched.opened());
+    TEST_ASSERT_EQUAL_UINT8(3, sched.maxConcurrent());
+    TEST_ASSERT_EQUAL_UINT8(0, sched.live());
+    TEST_ASSERT_GREATER_OR_EQUAL(SSH_SESSION_LINGER_MS, finishMs);
+    TEST_ASSERT_TRUE(ChannelScheduler::active() == nullptr);
+}
+
+// A dropped connection ends every channel and skips the linger time.
+static void test_disconnect_ends_channels(){
+    std::vector<FakeStep> script = {
+        { FakeStep::OPEN, 0, nullptr },
+        { FakeStep::SHELL, 1, nullptr },
+        { FakeStep::DATA, 1, "a" },
+        { FakeStep::DATA, 0, "q" },
+        { FakeStep::DISCONNECT, 0, nullptr },
+    };
+    FakeSsh fake(script);
+    ChannelScheduler sched(&fake.session, SUBSYSTEM, echoApp, nullptr);
+    uint32_t finishMs = serve(fake, sched);
+
+    TEST_ASSERT_EQUAL_STRING("S:a;", fake.channels[1]->out.c_str());
+    TEST_ASSERT_TRUE(fake.channels[1]->freed);
+    TEST_ASSERT_FALSE(fake.usedAfterFree);
+    TEST_ASSERT_LESS_THAN(SSH_SESSION_LINGER_MS, finishMs);
+}
+
+// Input for two channels in one packet batch stamps both; a channel reading
+// does not take the other's stamp.
+static void test_input_ready_per_channel(){
+    std::vector<FakeStep> script = {
+        { FakeStep::OPEN, 0, nullptr },
+        { FakeStep::SHELL, 1, nullptr },
+        { FakeStep::DATA, -1, "k" },
+        { FakeStep::DATA, 1, "j" },
+        { FakeStep::DATA, -1, "q" },
+    };
+    FakeSsh fake(script);
+    ChannelScheduler sched(&fake.session, SUBSYSTEM, stampApp, nullptr);
+    serve(fake, sched, stampApp);
+
+    TEST_ASSERT_EQUAL_STRING("k*;q*;", fake.channels[0]->out.c_str());
+    TEST_ASSERT_EQUAL_STRING("k*;j*;q*;", fake.channels[1]->out.c_str());
+}
+
+// An extra channel needs its task stack plus the shed margin on top of the reserve.
+static void test_low_heap_refuses_channel(){
+    nativeHeapReset(SSH_CHANNEL_STACK + SSH_HEAP_SHED_MARGIN + SSH_HEAP_RESERVE - 1, 112 * 1024);
+    std::vector<FakeStep> script = {
+        { FakeStep::OPEN, 0, nullptr },
+        { FakeStep::DATA, 0, "q" },
+        { FakeStep::DISCONNECT, 0, nullptr },
+    };
+    FakeSsh fake(script);
+    ChannelScheduler sched(&fake.session, SUBSYSTEM, echoApp, nullptr);
+    serve(fake, sched);
+
+    TEST_ASSERT_EQUAL_size_t(1, fake.channels.size());
+    TEST_ASSERT_EQUAL_UINT32(1, fake.refusedOpens);
+    char line[128];
+    MemoryBudget::format(line, sizeof(line));
+    TEST_ASSERT_NOT_NULL(strstr(line, "ssh_refused_lowmem=1"));
+}
+
+int main(int, char**){
+    UNITY_BEGIN();
+    RUN_TEST(test_channels_take_turns);
+    RUN_TEST(test_disconnect_ends_channels);
+    RUN_TEST(test_input_ready_per_channel);
+    RUN_TEST(test_low_heap_refuses_channel);
+    return UNITY_END();
+}
@@ -0,0 +1,239 @@
+// Host tests for the command tokenizer and option parser: pio test -e native
+#include <unity.h>
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+
+// The native env builds nothing under src/; the unit under test comes in here.
+#include "CmdLine.cpp"
+
+void setUp(){}
+void tearDown(){}
+
+// Independent statement of the tokenizer rules, for differential fuzzing:
+// whitespace separates, '...' is literal, "..." takes \" and \\ only, bare
+// text takes any backslash escape, adjacent pieces join. Returns the word
+// count or the error of the first word that fails: starting word maxArgs + 1
+// or leaving a quote open.
+static int referenceTokenize(const std::string& line, int maxArgs, std::vector<std::string>& words){
+    words.clear();
+    size_t i = 0, n = line.size();
+    for (;;){
+        while (i < n && strchr(" \t\r\n", line[i])) i++;
+        if (i >= n) return (int)words.size();
+        if ((int)words.size() == maxArgs) return CMD_ERR_TOO_MANY;
+        std::string word;
+        char quote = 0;
+        for (; i < n; i++){
+            char c = line[i];
+            bool hasNext = i + 1 < n;
+            if (quote == '\''){
+                if (c == '\'') quote = 0; else word += c;
+            } else if (quote == '"'){
+                if (c == '\\' && hasNext && (line[i + 1] == '"' || line[i + 1] == '\\')) word += line[++i];
+                else if (c == '"') quote = 0;
+                else word += c;
+            } else if (c == '\\' && hasNext){
+                word += line[++i];
+            } else if (c == '\'' || c == '"'){
+                quote = c;
+            } else if (strchr(" \t\r\n", c)){
+                break;
+            } else {
+                word += c;
+            }
+        }
+        if (quote) return CMD_ERR_QUOTE;
+        words.push_back(word);
+    }
+}
+
+static void test_tokenize_words_and_quotes(){
+    char line[] = "  gpio  write\t'4, 5' \"a \\\"b\\\" \\c\" x\\ y 'it'\"'\"s\r\n";
+    char* argv[CMD_MAX_ARGS];
+    TEST_ASSERT_EQUAL_INT(6, cmdTokenize(line, argv, CMD_MAX_ARGS));
+    TEST_ASSERT_EQUAL_STRING("gpio", argv[0]);
+    TEST_ASSERT_EQUAL_STRING("write", argv[1]);
+    TEST_ASSERT_EQUAL_STRING("4, 5", argv[2]);
+    TEST_ASSERT_EQUAL_STRING("a \"b\" \\c", argv[3]);
+    TEST_ASSERT_EQUAL_STRING("x y", argv[4]);
+    TEST_ASSERT_EQUAL_STRING("it's", argv[5]);
+}
+
+static void test_tokenize_errors(){
+    char* argv[4];
+    char open1[] = "echo 'oops";
+    TEST_ASSERT_EQUAL_INT(CMD_ERR_QUOTE, cmdTokenize(open1, argv, 4));
+    char open2[] = "echo \"oops\\\"";
+    TEST_ASSERT_EQUAL_INT(CMD_ERR_QUOTE, cmdTokenize(open2, argv, 4));
+    char empty[] = " \t\r\n";
+    TEST_ASSERT_EQUAL_INT(0, cmdTokenize(empty, argv, 4));
+}
+
+// Exactly maxArgs words fit; one more is refused without touching argv[maxArgs].
+static void test_tokenize_argv_overflow(){
+    for (int maxArgs = 0; maxArgs <= 6; maxArgs++){
+        char* argv[8];
+        char sentinel;
+        for (int i = 0; i < 8; i++) argv[i] = &sentinel;
+        std::string words;
+        for (int i = 0; i < maxArgs; i++) words += "w ";
+        std::vector<char> fit(words.begin(), words.end());
+        fit.push_back('\0');
+        TEST_ASSERT_EQUAL_INT(maxArgs, cmdTokenize(fit.data(), argv, maxArgs));
+        words += "extra";
+        std::vector<char> over(words.begin(), words.end());
+        over.push_back('\0');
+        TEST_ASSERT_EQUAL_INT(CMD_ERR_TOO_MANY, cmdTokenize(over.data(), argv, maxArgs));
+        for (int i = maxArgs; i < 8; i++) TEST_ASSERT_TRUE(argv[i] == &sentinel);
+    }
+}
+
+// Random lines over an alphabet heavy in quotes, escapes and separators,
+// checked against referenceTokenize() and for writes outside line/argv.
+static void test_tokenize_fuzz(){
+    static const char ALPHABET[] = "ab '\"\\\t\n\r";
+    const size_t LINE_MAX = 48, GUARD = 16;
+    uint32_t seed = 12345;
+    for (int iter = 0; iter < 200000; iter++){
+        seed = seed * 1664525u + 1013904223u;
+        size_t len = (seed >> 8) % LINE_MAX;
+        int maxArgs = (int)((seed >> 20) % 8);
+        std::string text;
+        for (size_t i = 0; i < len; i++){
+            seed = seed * 1664525u + 1013904223u;
+            text += ALPHABET[(seed >> 16) % (sizeof(ALPHABET) - 1)];
+        }
+        char buf[LINE_MAX + 1 + GUARD];
+        memset(buf, 0x5a, sizeof(buf));
+        memcpy(buf, text.c_str(), len + 1);
+        char* argv[8 + 1];
+        char sentinel;
+        for (int i = 0; i < 9; i++) argv[i] = &sentinel;
+
+        int got = cmdTokenize(buf, argv, maxArgs);
+        std::vector<std::string> want;
+        int ref = referenceTokenize(text, maxArgs, want);
+        if (got != ref){
+            char msg[160];
+            snprintf(msg, sizeof(msg), "iteration %d: '%s' maxArgs %d: got %d, want %d", iter, text.c_str(), maxArgs, got, ref);
+            TEST_FAIL_MESSAGE(msg);
+        }
+        for (size_t i = len + 1; i < sizeof(buf); i++) TEST_ASSERT_EQUAL_HEX8(0x5a, (uint8_t)buf[i]);
+        for (int i = got < 0 ? maxArgs : got; i < 9; i++) TEST_ASSERT_TRUE(argv[i] == &sentinel);
+        for (int i = 0; i < got; i++){
+            TEST_ASSERT_TRUE(argv[i] >= buf && argv[i] <= buf + len);
+            TEST_ASSERT_EQUAL_STRING(want[i].c_str(), argv[i]);
+        }
+    }
+}
+
+struct TestArgs {
+    int count;
+    bool verbose;
+    const char* pos;
+};
+
+static error_t parseTestOpt(int key, char* arg, struct argp_state* state){
+    TestArgs* a = (TestArgs*)state->input;
+    switch (key){
+        case 'n': a->count = atoi(arg); return 0;
+        case 'v': a->verbose = true; return 0;
+        case ARGP_KEY_ARG:
+            if (state->arg_num > 0) return cmdFail(state, "one argument only");
+            a->pos = arg;
+            return 0;
+        default: return ARGP_ERR_UNKNOWN;
+    }
+}
+
+static const struct argp_option testOptions[] = {
+    { "count", 'n', "N", 0, "repeat N times", 0 },
+    { "verbose", 'v', nullptr, 0, "say more", 0 },
+    { nullptr, 0, nullptr, 0, nullptr, 0 }
+};
+static const struct argp testArgp = { testOptions, parseTestOpt, "ARG", nullptr, nullptr, nullptr, nullptr };
+
+static error_t parseUintOpt(int key, char* arg, struct argp_state* state){
+    unsigned long n = 0;
+    if (key != ARGP_KEY_ARG) return ARGP_ERR_UNKNOWN;
+    error_t e = cmdArgUint(state, arg, 1, 100, n);
+    if (!e) ((TestArgs*)state->input)->count = (int)n;
+    return e;
+}
+
+static const struct argp uintArgp = { testOptions, parseUintOpt, "N", nullptr, nullptr, nullptr, nullptr };
+
+static void test_parse_options(){
+    char line[] = "cmd -vn3 -- -5";
+    char* argv[CMD_MAX_ARGS];
+    int argc = cmdTokenize(line, argv, CMD_MAX_ARGS);
+    TestArgs a = { 0, false, nullptr };
+    char err[64];
+    TEST_ASSERT_EQUAL_INT(0, cmdParse(&testArgp, argc, argv, &a, err, sizeof(err)));
+    TEST_ASSERT_EQUAL_INT(3, a.count);
+    TEST_ASSERT_TRUE(a.verbose);
+    TEST_ASSERT_EQUAL_STRING("-5", a.pos);
+
+    char bad[] = "cmd --count";
+    argc = cmdTokenize(bad, argv, CMD_MAX_ARGS);
+    TEST_ASSERT_NOT_EQUAL(0, cmdParse(&testArgp, argc, argv, &a, err, sizeof(err)));
+    TEST_ASSERT_EQUAL_STRING("cmd: --count needs N", err);
+}
+
+// Range-checked numbers for parser callbacks, with the message on failure.
+static void test_parse_uint_argument(){
+    struct argp_state state = {};
+    state.name = (char*)"ping";
+    unsigned long v = 7;
+    TEST_ASSERT_EQUAL_INT(0, cmdArgUint(&state, "0x10", 1, 100, v));
+    TEST_ASSERT_EQUAL_UINT32(16, v);
+    TEST_ASSERT_NOT_EQUAL(0, cmdArgUint(&state, "101", 1, 100, v));
+    TEST_ASSERT_NOT_EQUAL(0, cmdArgUint(&state, "-1", 1, 100, v));
+    TEST_ASSERT_NOT_EQUAL(0, cmdArgUint(&state, "5x", 1, 100, v));
+    TEST_ASSERT_EQUAL_UINT32(16, v);
+
+    char line[] = "ping 0";
+    char* argv[CMD_MAX_ARGS];
+    int argc = cmdTokenize(line, argv, CMD_MAX_ARGS);
+    TestArgs a = { 0, false, nullptr };
+    char err[64];
+    TEST_ASSERT_NOT_EQUAL(0, cmdParse(&uintArgp, argc, argv, &a, err, sizeof(err)));
+    TEST_ASSERT_EQUAL_STRING("ping: expected 1-100, got '0'", err);
+}
+
+// Not a pass/fail check: a whole command, tokenized and option-parsed, per
+// second, next to the other RESULT lines.
+static void test_parse_benchmark(){
+    static const char LINE[] = "seq --count=25 -v \"step one\"";
+    const int ITERATIONS = 500000;
+    char buf[sizeof(LINE)];
+    char* argv[CMD_MAX_ARGS];
+    char err[64];
+    int parsed = 0;
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; i++){
+        memcpy(buf, LINE, sizeof(LINE));
+        int argc = cmdTokenize(buf, argv, CMD_MAX_ARGS);
+        TestArgs a = { 0, false, nullptr };
+        if (cmdParse(&testArgp, argc, argv, &a, err, sizeof(err)) == 0 && a.count == 25) parsed++;
+    }
+    double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    TEST_ASSERT_EQUAL_INT(ITERATIONS, parsed);
+    printf("RESULT test=cmd_parse bytes=%u words=4 cmds_per_s=%.0f ns_per_cmd=%.1f\n",
+           (unsigned)(sizeof(LINE) - 1), ITERATIONS / s, s * 1e9 / ITERATIONS);
+}
+
+int main(int, char**){
+    UNITY_BEGIN();
+    RUN_TEST(test_tokenize_words_and_quotes);
+    RUN_TEST(test_tokenize_errors);
+    RUN_TEST(test_tokenize_argv_overflow);
+    RUN_TEST(test_tokenize_fuzz);
+    RUN_TEST(test_parse_options);
+    RUN_TEST(test_parse_uint_argument);
+    RUN_TEST(test_parse_benchmark);
+    return UNITY_END();
+}
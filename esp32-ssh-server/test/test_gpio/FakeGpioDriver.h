@@ -0,0 +1,56 @@
+#ifndef FAKE_GPIO_DRIVER_H
+#define FAKE_GPIO_DRIVER_H
+
+#include "GpioDriver.h"
+#include <esp_timer.h>
+#include <vector>
+
+// Pins as plain bits, with every call logged along with the esp_timer time
+// it was made at, so a test can check what was driven and when.
+class FakeGpioDriver : public GpioDriver {
+public:
+    enum Kind { CONFIG_OUT, CONFIG_IN, WRITE, READ };
+    struct Op { Kind kind; uint64_t setMask; uint64_t clearMask; int64_t atUs; };
+
+    std::vector<Op> ops;
+    uint64_t outputMask = 0, pullUps = 0, levels = 0;
+
+    bool configureOutputs(uint64_t mask) override {
+        log(CONFIG_OUT, mask, 0);
+        if (mask & ~(uint64_t)GPIO_APP_OUTPUT_MASK) return false;
+        outputMask |= mask;
+        return true;
+    }
+    bool configureInputs(uint64_t mask, bool pullUp) override {
+        log(CONFIG_IN, mask, 0);
+        if (mask & ~(uint64_t)GPIO_APP_INPUT_MASK) return false;
+        outputMask &= ~mask;
+        if (pullUp) pullUps |= mask;
+        else pullUps &= ~mask;
+        return true;
+    }
+    void write(uint64_t setMask, uint64_t clearMask) override {
+        log(WRITE, setMask, clearMask);
+        levels = (levels | (setMask & outputMask)) & ~(clearMask & outputMask);
+    }
+    uint64_t read() override {
+        log(READ, 0, 0);
+        return levels | (pullUps & ~outputMask);
+    }
+    uint64_t outputs() override { return levels & outputMask; }
+
+    // Logged operations of one kind, in call order.
+    std::vector<Op> all(Kind kind) const {
+        std::vector<Op> out;
+        for (size_t i = 0; i < ops.size(); i++) if (ops[i].kind == kind) out.push_back(ops[i]);
+        return out;
+    }
+
+private:
+    void log(Kind kind, uint64_t setMask, uint64_t clearMask){
+        Op op = { kind, setMask, clearMask, esp_timer_get_time() };
+        ops.push_back(op);
+    }
+};
+
+#endif // FAKE_GPIO_DRIVER_H
@@ -0,0 +1,33 @@
+#ifndef FAKE_DRIVER_GPIO_H
+#define FAKE_DRIVER_GPIO_H
+
+#include <stdint.h>
+
+// gpio_config() for host builds: accepts everything and keeps the last call.
+typedef int esp_err_t;
+#define ESP_OK 0
+
+typedef enum { GPIO_MODE_INPUT = 1, GPIO_MODE_OUTPUT = 2, GPIO_MODE_INPUT_OUTPUT = 3 } gpio_mode_t;
+typedef enum { GPIO_PULLUP_DISABLE = 0, GPIO_PULLUP_ENABLE = 1 } gpio_pullup_t;
+typedef enum { GPIO_PULLDOWN_DISABLE = 0, GPIO_PULLDOWN_ENABLE = 1 } gpio_pulldown_t;
+typedef enum { GPIO_INTR_DISABLE = 0 } gpio_int_type_t;
+
+typedef struct {
+    uint64_t pin_bit_mask;
+    gpio_mode_t mode;
+    gpio_pullup_t pull_up_en;
+    gpio_pulldown_t pull_down_en;
+    gpio_int_type_t intr_type;
+} gpio_config_t;
+
+inline gpio_config_t& fakeGpioLastConfig(){
+    static gpio_config_t cfg;
+    return cfg;
+}
+
+inline esp_err_t gpio_config(const gpio_config_t* cfg){
+    fakeGpioLastConfig() = *cfg;
+    return ESP_OK;
+}
+
+#endif // FAKE_DRIVER_GPIO_H
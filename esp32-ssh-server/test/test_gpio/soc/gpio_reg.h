@@ -0,0 +1,46 @@
+#ifndef FAKE_GPIO_REG_H
+#define FAKE_GPIO_REG_H
+
+#include <stdint.h>
+#include <vector>
+
+// The GPIO output and input registers as plain memory. Every store is logged
+// in order, so a test sees how a write() sequences its W1TS and W1TC stores;
+// outputs read back on the input registers as in GPIO_MODE_INPUT_OUTPUT.
+enum FakeGpioReg {
+    GPIO_OUT_REG, GPIO_OUT_W1TS_REG, GPIO_OUT_W1TC_REG,
+    GPIO_OUT1_REG, GPIO_OUT1_W1TS_REG, GPIO_OUT1_W1TC_REG,
+    GPIO_IN_REG, GPIO_IN1_REG, FAKE_GPIO_REGS
+};
+
+struct FakeGpioStore { int reg; uint32_t value; };
+
+inline uint32_t* fakeGpioRegs(){
+    static uint32_t regs[FAKE_GPIO_REGS];
+    return regs;
+}
+
+inline std::vector<FakeGpioStore>& fakeGpioStores(){
+    static std::vector<FakeGpioStore> stores;
+    return stores;
+}
+
+inline void fakeGpioRegWrite(int reg, uint32_t value){
+    FakeGpioStore s = { reg, value };
+    fakeGpioStores().push_back(s);
+    uint32_t* r = fakeGpioRegs();
+    switch (reg){
+        case GPIO_OUT_W1TS_REG: r[GPIO_OUT_REG] |= value; break;
+        case GPIO_OUT_W1TC_REG: r[GPIO_OUT_REG] &= ~value; break;
+        case GPIO_OUT1_W1TS_REG: r[GPIO_OUT1_REG] |= value; break;
+        case GPIO_OUT1_W1TC_REG: r[GPIO_OUT1_REG] &= ~value; break;
+        default: r[reg] = value; break;
+    }
+    r[GPIO_IN_REG] = r[GPIO_OUT_REG];
+    r[GPIO_IN1_REG] = r[GPIO_OUT1_REG];
+}
+
+#define REG_WRITE(reg, value) fakeGpioRegWrite((reg), (value))
+#define REG_READ(reg) (fakeGpioRegs()[(reg)])
+
+#endif // FAKE_GPIO_REG_H
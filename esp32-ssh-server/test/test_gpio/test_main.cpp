@@ -0,0 +1,147 @@
+// Host tests for the GPIO driver and console: pio test -e native
+#include <unity.h>
+#include <string>
+#include <vector>
+#include "FakeGpioDriver.h"
+
+// The native env builds nothing under src/; the units under test come in here.
+// soc/gpio_reg.h and driver/gpio.h resolve to the fakes next to this file.
+#include "CmdLine.cpp"
+#include "GpioDriver.cpp"
+#include "GpioApp.cpp"
+
+// The channel is a transcript of what the app wrote; the client types the
+// scripted lines in order, then "q".
+struct ssh_channel_struct {
+    std::string out;
+    std::vector<std::string> lines;
+    size_t next = 0;
+};
+
+int ssh_channel_is_open(ssh_channel){ return 1; }
+int ssh_channel_is_eof(ssh_channel){ return 0; }
+
+int ssh_write(ssh_channel ch, const void* data, uint32_t len){
+    ch->out.append((const char*)data, len);
+    return (int)len;
+}
+void ssh_write_str(ssh_channel ch, const char* s){ ch->out += s; }
+void ssh_write_line(ssh_channel ch, const char* s){ ch->out += std::string(s) + "\r\n"; }
+void ssh_channel_wait(ssh_channel, int){}
+
+bool SshLineReader::poll(ssh_channel ch){
+    const char* line = ch->next < ch->lines.size() ? ch->lines[ch->next].c_str() : "q";
+    ch->next++;
+    snprintf(buf, sizeof(buf), "%s", line);
+    return true;
+}
+
+static void runApp(FakeGpioDriver& fake, ssh_channel_struct& ch){
+    TimedGpioDriver timed(fake);
+    SshLineReader reader;
+    runGpioApp(&ch, reader, timed);
+}
+
+void setUp(){ fakeGpioStores().clear(); }
+void tearDown(){}
+
+// Both banks rise before either falls; a pin in both masks is driven high
+// and pins outside GPIO_APP_OUTPUT_MASK are left alone.
+static void test_register_write_order(){
+    Esp32GpioDriver gpio;
+    gpio.write((1ULL << 4) | (1ULL << 32) | (1ULL << 6), (1ULL << 5) | (1ULL << 33) | (1ULL << 4));
+    std::vector<FakeGpioStore>& s = fakeGpioStores();
+    TEST_ASSERT_EQUAL_size_t(4, s.size());
+    TEST_ASSERT_EQUAL_INT(GPIO_OUT_W1TS_REG, s[0].reg);
+    TEST_ASSERT_EQUAL_HEX32(1u << 4, s[0].value);
+    TEST_ASSERT_EQUAL_INT(GPIO_OUT1_W1TS_REG, s[1].reg);
+    TEST_ASSERT_EQUAL_HEX32(1u << 0, s[1].value);
+    TEST_ASSERT_EQUAL_INT(GPIO_OUT_W1TC_REG, s[2].reg);
+    TEST_ASSERT_EQUAL_HEX32(1u << 5, s[2].value);
+    TEST_ASSERT_EQUAL_INT(GPIO_OUT1_W1TC_REG, s[3].reg);
+    TEST_ASSERT_EQUAL_HEX32(1u << 1, s[3].value);
+    TEST_ASSERT_TRUE(gpio.outputs() == ((1ULL << 4) | (1ULL << 32)));
+}
+
+// A bank with nothing to change gets no store.
+static void test_register_write_skips_idle_bank(){
+    Esp32GpioDriver gpio;
+    gpio.write(1ULL << 2, 0);
+    TEST_ASSERT_EQUAL_size_t(1, fakeGpioStores().size());
+    TEST_ASSERT_EQUAL_INT(GPIO_OUT_W1TS_REG, fakeGpioStores()[0].reg);
+}
+
+static void test_timed_driver_counts_ops(){
+    FakeGpioDriver fake;
+    TimedGpioDriver timed(fake);
+    TEST_ASSERT_TRUE(timed.configureOutputs(0x30));
+    TEST_ASSERT_FALSE(timed.configureOutputs(1ULL << 6));
+    for (int i = 0; i < 3; i++) timed.write(0x10, 0x20);
+    TEST_ASSERT_TRUE(timed.read() == 0x10);
+    TEST_ASSERT_EQUAL_UINT32(2, timed.stats(TimedGpioDriver::OP_CONFIG).count);
+    TEST_ASSERT_EQUAL_UINT32(3, timed.stats(TimedGpioDriver::OP_WRITE).count);
+    TEST_ASSERT_EQUAL_UINT32(1, timed.stats(TimedGpioDriver::OP_READ).count);
+    TEST_ASSERT_EQUAL_size_t(6, fake.ops.size());
+    timed.reset();
+    TEST_ASSERT_EQUAL_UINT32(0, timed.stats(TimedGpioDriver::OP_WRITE).count);
+}
+
+// Each console drive is one driver write carrying the whole pin set.
+static void test_app_drives_pin_sets_in_one_write(){
+    FakeGpioDriver fake;
+    ssh_channel_struct ch;
+    ch.lines = { "out 4,5", "write 4,5 0x10", "in 18-19 --pull-up", "set 0x20", "read" };
+    runApp(fake, ch);
+    std::vector<FakeGpioDriver::Op> w = fake.all(FakeGpioDriver::WRITE);
+    TEST_ASSERT_EQUAL_size_t(2, w.size());
+    TEST_ASSERT_TRUE(w[0].setMask == 0x10 && w[0].clearMask == 0x20);
+    TEST_ASSERT_TRUE(w[1].setMask == 0x20 && w[1].clearMask == 0);
+    TEST_ASSERT_TRUE(fake.pullUps == ((1ULL << 18) | (1ULL << 19)));
+    TEST_ASSERT_TRUE(ch.out.find("high: 4 5 18 19\r\n") != std::string::npos);
+    TEST_ASSERT_TRUE(ch.out.find("RESULT test=gpio in=0x00000c0030 out=0x0000000030") != std::string::npos);
+    TEST_ASSERT_TRUE(ch.out.find("Usage:") == std::string::npos);
+}
+
+// Steps land in order and never early; the timing is read off the fake's log.
+static void test_sequence_steps_on_schedule(){
+    const int64_t STEP_US = 2000;
+    FakeGpioDriver fake;
+    ssh_channel_struct ch;
+    ch.lines = { "out 4", "seq 4 2000 1 0 0x10 0", "seq 4 200000 1 0 1" };
+    runApp(fake, ch);
+    std::vector<FakeGpioDriver::Op> w = fake.all(FakeGpioDriver::WRITE);
+    TEST_ASSERT_EQUAL_size_t(4, w.size());
+    TEST_ASSERT_TRUE(w[0].setMask == 0 && w[0].clearMask == 0x10);
+    TEST_ASSERT_TRUE(w[2].setMask == 0x10 && w[2].clearMask == 0);
+    for (size_t i = 1; i < w.size(); i++){
+        // write i is due i steps after the sequence started, just before write 0
+        TEST_ASSERT_GREATER_OR_EQUAL((int64_t)i * STEP_US - STEP_US / 2, w[i].atUs - w[0].atUs);
+    }
+    TEST_ASSERT_LESS_THAN(1000000, w[3].atUs - w[0].atUs);
+    TEST_ASSERT_TRUE(ch.out.find("RESULT test=gpio_seq steps=4 step_us=2000 ") != std::string::npos);
+    // The second sequence runs past GPIO_SEQ_MAX_US and is refused.
+    TEST_ASSERT_TRUE(ch.out.find("Usage:") != std::string::npos);
+}
+
+static void test_parse_pins(){
+    uint64_t mask = 0;
+    TEST_ASSERT_TRUE(gpioParsePins("4,5,18-19", mask));
+    TEST_ASSERT_TRUE(mask == ((1ULL << 4) | (1ULL << 5) | (1ULL << 18) | (1ULL << 19)));
+    TEST_ASSERT_TRUE(gpioParsePins("0x30", mask));
+    TEST_ASSERT_TRUE(mask == 0x30);
+    TEST_ASSERT_FALSE(gpioParsePins("5-4", mask));
+    TEST_ASSERT_FALSE(gpioParsePins("40", mask));
+    TEST_ASSERT_FALSE(gpioParsePins("4,x", mask));
+    TEST_ASSERT_FALSE(gpioParsePins("", mask));
+}
+
+int main(int, char**){
+    UNITY_BEGIN();
+    RUN_TEST(test_register_write_order);
+    RUN_TEST(test_register_write_skips_idle_bank);
+    RUN_TEST(test_timed_driver_counts_ops);
+    RUN_TEST(test_app_drives_pin_sets_in_one_write);
+    RUN_TEST(test_sequence_steps_on_schedule);
+    RUN_TEST(test_parse_pins);
+    return UNITY_END();
+}
@@ -0,0 +1,162 @@
+// Host tests for session admission by memory: pio test -e native
+#include <unity.h>
+
+// The native env builds nothing under src/; the unit under test comes in here.
+#include "MemoryBudget.cpp"
+
+static const uint32_t KB = 1024;
+
+// Push every measured session out of the window, leaving the floor.
+static void forgetSessions(){
+    for (int i = 0; i < SSH_BUDGET_WINDOW; i++) MemoryBudget::observeSession(0);
+}
+
+void setUp(){
+    nativeHeapReset(256 * KB, 112 * KB);
+    forgetSessions();
+}
+void tearDown(){}
+
+static void test_levels_follow_allocations(){
+    const uint32_t session = SSH_SESSION_HEAP_COST + SSH_HEAP_RESERVE;
+    nativeHeapReset(session + SSH_HEAP_SHED_MARGIN + 4 * KB, 112 * KB);
+    TEST_ASSERT_EQUAL_UINT(BUDGET_OK, MemoryBudget::assess());
+
+    void* a = heap_caps_malloc(8 * KB, MALLOC_CAP_8BIT);
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_EQUAL_UINT(BUDGET_LOW, MemoryBudget::assess());
+
+    void* b = heap_caps_malloc(SSH_HEAP_SHED_MARGIN, MALLOC_CAP_8BIT);
+    TEST_ASSERT_NOT_NULL(b);
+    TEST_ASSERT_EQUAL_UINT(BUDGET_CRITICAL, MemoryBudget::assess());
+
+    // Shedding gives the memory back and the level recovers.
+    heap_caps_free(b);
+    heap_caps_free(a);
+    TEST_ASSERT_EQUAL_UINT(BUDGET_OK, MemoryBudget::assess());
+}
+
+// Plenty free but no block large enough for key exchange buffers.
+static void test_fragmented_heap_is_critical(){
+    nativeHeapReset(256 * KB, SSH_MIN_LARGEST_BLOCK - 1);
+    TEST_ASSERT_EQUAL_UINT(BUDGET_CRITICAL, MemoryBudget::assess());
+    TEST_ASSERT_FALSE(MemoryBudget::canAfford(SSH_MIN_LARGEST_BLOCK));
+    TEST_ASSERT_TRUE(MemoryBudget::canAfford(4 * KB));
+}
+
+// canAfford() agrees with the allocator and keeps the reserve free.
+static void test_can_afford_keeps_reserve(){
+    nativeHeapReset(64 * KB, 64 * KB);
+    void* held = heap_caps_malloc(20 * KB, MALLOC_CAP_8BIT);
+    TEST_ASSERT_NOT_NULL(held);
+    uint32_t spare = 44 * KB - SSH_HEAP_RESERVE;
+    TEST_ASSERT_TRUE(MemoryBudget::canAfford(spare));
+    TEST_ASSERT_FALSE(MemoryBudget::canAfford(spare + 1));
+    void* fits = heap_caps_malloc(spare, MALLOC_CAP_8BIT);
+    TEST_ASSERT_NOT_NULL(fits);
+    TEST_ASSERT_EQUAL_size_t(SSH_HEAP_RESERVE, heap_caps_get_free_size(MALLOC_CAP_8BIT));
+    TEST_ASSERT_NULL(heap_caps_malloc(SSH_HEAP_RESERVE + 1, MALLOC_CAP_8BIT));
+    heap_caps_free(fits);
+    heap_caps_free(held);
+}
+
+// A key exchange peak freed before the next sample still counts, through
+// the heap's all-time minimum.
+static void test_session_cost_includes_transient_peak(){
+    const size_t resident = 20 * KB, kex = 40 * KB;
+    MemoryBudget::sessionStarted();
+    void* session = heap_caps_malloc(resident, MALLOC_CAP_8BIT);
+    void* scratch = heap_caps_malloc(kex, MALLOC_CAP_8BIT);
+    TEST_ASSERT_NOT_NULL(scratch);
+    heap_caps_free(scratch);
+    MemoryBudget::sample();         // after key exchange, scratch already gone
+    heap_caps_free(session);
+    MemoryBudget::sessionEnded();
+    TEST_ASSERT_EQUAL_UINT32(resident + kex, MemoryBudget::sessionCost());
+}
+
+// Apps sampled while they wait count as well.
+static void test_session_cost_includes_serving(){
+    const size_t resident = 20 * KB, app = 30 * KB;
+    void* earlier = heap_caps_malloc(60 * KB, MALLOC_CAP_8BIT);
+    heap_caps_free(earlier);        // an older, deeper all-time minimum
+    MemoryBudget::sessionStarted();
+    void* session = heap_caps_malloc(resident, MALLOC_CAP_8BIT);
+    MemoryBudget::sample();
+    void* buffers = heap_caps_malloc(app, MALLOC_CAP_8BIT);
+    MemoryBudget::sample();         // as ChannelScheduler::wait() does
+    heap_caps_free(buffers);
+    heap_caps_free(session);
+    MemoryBudget::sessionEnded();
+    TEST_ASSERT_EQUAL_UINT32(resident + app, MemoryBudget::sessionCost());
+}
+
+// One heavy session raises the estimate for SSH_BUDGET_WINDOW sessions, then
+// it falls back; small sessions never take it below the floor.
+static void test_estimate_is_windowed_max(){
+    TEST_ASSERT_EQUAL_UINT32(SSH_SESSION_HEAP_COST, MemoryBudget::sessionCost());
+    MemoryBudget::observeSession(100 * KB);
+    TEST_ASSERT_EQUAL_UINT32(100 * KB, MemoryBudget::sessionCost());
+    for (int i = 0; i < SSH_BUDGET_WINDOW - 1; i++) MemoryBudget::observeSession(SSH_SESSION_HEAP_COST + KB);
+    TEST_ASSERT_EQUAL_UINT32(100 * KB, MemoryBudget::sessionCost());
+    MemoryBudget::observeSession(SSH_SESSION_HEAP_COST + KB);
+    TEST_ASSERT_EQUAL_UINT32(SSH_SESSION_HEAP_COST + KB, MemoryBudget::sessionCost());
+    forgetSessions();
+    MemoryBudget::observeSession(KB);
+    TEST_ASSERT_EQUAL_UINT32(SSH_SESSION_HEAP_COST, MemoryBudget::sessionCost());
+}
+
+// A heavier estimate moves the thresholds with it.
+static void test_estimate_moves_levels(){
+    const uint32_t freeHeap = SSH_SESSION_HEAP_COST + SSH_HEAP_RESERVE + SSH_HEAP_SHED_MARGIN;
+    TEST_ASSERT_EQUAL_UINT(BUDGET_OK, MemoryBudget::assess(freeHeap, 112 * KB));
+    MemoryBudget::observeSession(SSH_SESSION_HEAP_COST + 1);
+    TEST_ASSERT_EQUAL_UINT(BUDGET_LOW, MemoryBudget::assess(freeHeap, 112 * KB));
+    MemoryBudget::observeSession(SSH_SESSION_HEAP_COST + SSH_HEAP_SHED_MARGIN + 1);
+    TEST_ASSERT_EQUAL_UINT(BUDGET_CRITICAL, MemoryBudget::assess(freeHeap, 112 * KB));
+}
+
+static void test_format_reports_estimate(){
+    MemoryBudget::observeSession(50 * KB);
+    char line[128];
+    size_t n = MemoryBudget::format(line, sizeof(line));
+    TEST_ASSERT_EQUAL_size_t(strlen(line), n);
+    TEST_ASSERT_NOT_NULL(strstr(line, "mem_level=ok mem_session_cost=51200 "));
+    char small[16];
+    TEST_ASSERT_EQUAL_size_t(sizeof(small) - 1, MemoryBudget::format(small, sizeof(small)));
+}
+
+// Later handshakes doing the same work no longer set a new all-time
+// minimum; the first one's measured peak stays the estimate's floor. Runs
+// last, since the peak is kept for the life of the process.
+static void test_handshake_peak_is_sticky(){
+    const size_t resident = 20 * KB, kex = 40 * KB;
+    for (int i = 0; i < SSH_BUDGET_WINDOW + 1; i++){
+        MemoryBudget::sessionStarted();
+        void* session = heap_caps_malloc(resident, MALLOC_CAP_8BIT);
+        void* scratch = heap_caps_malloc(kex, MALLOC_CAP_8BIT);
+        TEST_ASSERT_NOT_NULL(scratch);
+        heap_caps_free(scratch);
+        MemoryBudget::handshakeDone();
+        TEST_ASSERT_EQUAL_UINT32(resident + kex, MemoryBudget::handshakePeak());
+        heap_caps_free(session);
+        MemoryBudget::sessionEnded();
+        TEST_ASSERT_EQUAL_UINT32(resident + kex, MemoryBudget::sessionCost());
+    }
+    forgetSessions();
+    TEST_ASSERT_EQUAL_UINT32(resident + kex, MemoryBudget::sessionCost());
+}
+
+int main(int, char**){
+    UNITY_BEGIN();
+    RUN_TEST(test_levels_follow_allocations);
+    RUN_TEST(test_fragmented_heap_is_critical);
+    RUN_TEST(test_can_afford_keeps_reserve);
+    RUN_TEST(test_session_cost_includes_transient_peak);
+    RUN_TEST(test_session_cost_includes_serving);
+    RUN_TEST(test_estimate_is_windowed_max);
+    RUN_TEST(test_estimate_moves_levels);
+    RUN_TEST(test_format_reports_estimate);
+    RUN_TEST(test_handshake_peak_is_sticky);
+    return UNITY_END();
+}
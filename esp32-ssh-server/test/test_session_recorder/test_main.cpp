@@ -0,0 +1,85 @@
+// Host tests for the session recorder's per-channel pause: pio test -e native
+#include <unity.h>
+#include <string>
+
+// The native env builds nothing under src/; the unit under test comes in here.
+#include "SessionRecorder.cpp"
+
+struct ssh_channel_struct {
+    int id;
+};
+
+static ssh_channel_struct shell = { 0 }, rpc = { 1 }, other = { 2 };
+
+void setUp(){ SessionRecorder::enable(4096); }
+void tearDown(){
+    SessionRecorder::disable();
+    SessionRecorder::setPaused(&shell, false);
+    SessionRecorder::setPaused(&rpc, false);
+    SessionRecorder::setPaused(&other, false);
+}
+
+// Recorded events as "<type><data>;" in order.
+static std::string events(){
+    std::string out;
+    uint32_t cursor = 0;
+    SessionRecorder::Event ev;
+    while (SessionRecorder::next(cursor, ev)){
+        std::string data(ev.len, '\0');
+        SessionRecorder::read(ev, 0, &data[0], ev.len);
+        out += ev.type + data + ";";
+    }
+    return out;
+}
+
+// A paused channel is skipped; the other channels and markers still record.
+static void test_pause_skips_only_that_channel(){
+    SessionRecorder::output(&shell, "$ ", 2);
+    SessionRecorder::marker("rpc");
+    SessionRecorder::setPaused(&rpc, true);
+    SessionRecorder::input(&rpc, "\x01\x02", 2);
+    SessionRecorder::input(&shell, "ls", 2);
+    SessionRecorder::output(&rpc, "\x03", 1);
+    SessionRecorder::output(&shell, "a b", 3);
+    SessionRecorder::setPaused(&rpc, false);
+    SessionRecorder::output(&rpc, "back", 4);
+    std::string got = events();
+    TEST_ASSERT_EQUAL_STRING("o$ ;mrpc;ils;oa b;oback;", got.c_str());
+}
+
+// Pausing is per channel, not counted: one resume undoes any number of pauses.
+static void test_pause_is_a_set(){
+    SessionRecorder::setPaused(&shell, true);
+    SessionRecorder::setPaused(&shell, true);
+    SessionRecorder::setPaused(&other, true);
+    TEST_ASSERT_TRUE(SessionRecorder::isPaused(&shell));
+    SessionRecorder::setPaused(&shell, false);
+    TEST_ASSERT_FALSE(SessionRecorder::isPaused(&shell));
+    TEST_ASSERT_TRUE(SessionRecorder::isPaused(&other));
+    SessionRecorder::output(&shell, "x", 1);
+    SessionRecorder::output(&other, "y", 1);
+    std::string got = events();
+    TEST_ASSERT_EQUAL_STRING("ox;", got.c_str());
+}
+
+// More channels than SSH_RECORD_MAX_PAUSED: the extra ones keep recording.
+static void test_pause_table_full(){
+    ssh_channel_struct chans[SSH_RECORD_MAX_PAUSED + 1];
+    for (int i = 0; i <= SSH_RECORD_MAX_PAUSED; i++){
+        chans[i].id = 10 + i;
+        SessionRecorder::setPaused(&chans[i], true);
+    }
+    for (int i = 0; i <= SSH_RECORD_MAX_PAUSED; i++) SessionRecorder::output(&chans[i], "z", 1);
+    std::string got = events();
+    TEST_ASSERT_EQUAL_STRING("oz;", got.c_str());
+    for (int i = 0; i <= SSH_RECORD_MAX_PAUSED; i++) SessionRecorder::setPaused(&chans[i], false);
+    TEST_ASSERT_FALSE(SessionRecorder::isPaused(&chans[0]));
+}
+
+int main(int, char**){
+    UNITY_BEGIN();
+    RUN_TEST(test_pause_skips_only_that_channel);
+    RUN_TEST(test_pause_is_a_set);
+    RUN_TEST(test_pause_table_full);
+    return UNITY_END();
+}
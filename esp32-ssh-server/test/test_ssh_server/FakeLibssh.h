@@ -0,0 +1,111 @@
+#ifndef FAKE_LIBSSH_H
+#define FAKE_LIBSSH_H
+
+#include <libssh/server.h>
+#include <esp_heap_caps.h>
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+// libssh as far as admission goes, over real loopback sockets: the bind
+// listens on an ephemeral port, a session takes FAKE_SESSION_BYTES of the
+// capped heap, accept takes the queued connection and key exchange borrows
+// FAKE_KEX_BYTES of scratch and then fails, so every admitted client ends
+// on the kex-failed path. Nothing past key exchange is ever called.
+static const size_t FAKE_SESSION_BYTES = 8 * 1024;
+static const size_t FAKE_KEX_BYTES = 24 * 1024;
+
+struct ssh_bind_struct {
+    int fd;
+};
+
+struct ssh_session_struct {
+    int fd;
+};
+
+static int fakeSessionsLive = 0;
+
+int ssh_init(void){ return SSH_OK; }
+void libssh_begin(void){}
+
+ssh_session ssh_new(void){
+    void* mem = heap_caps_malloc(FAKE_SESSION_BYTES, MALLOC_CAP_8BIT);
+    if (!mem) return nullptr;
+    ssh_session s = (ssh_session)mem;
+    s->fd = -1;
+    fakeSessionsLive++;
+    return s;
+}
+
+void ssh_disconnect(ssh_session s){
+    if (s->fd >= 0) close(s->fd);
+    s->fd = -1;
+}
+
+void ssh_free(ssh_session s){
+    if (!s) return;
+    ssh_disconnect(s);
+    fakeSessionsLive--;
+    heap_caps_free(s);
+}
+
+int ssh_options_set(ssh_session, enum ssh_options_e, const void*){ return SSH_OK; }
+const char* ssh_get_error(void*){ return "fake libssh"; }
+int ssh_get_fd(ssh_session s){ return s->fd; }
+void ssh_set_counters(ssh_session, ssh_counter, ssh_counter){}
+int ssh_pki_generate(enum ssh_keytypes_e, int, ssh_key* key){ *key = nullptr; return SSH_OK; }
+
+int ssh_handle_key_exchange(ssh_session){
+    void* scratch = heap_caps_malloc(FAKE_KEX_BYTES, MALLOC_CAP_8BIT);
+    heap_caps_free(scratch);
+    return SSH_ERROR;
+}
+
+ssh_bind ssh_bind_new(void){
+    ssh_bind b = new ssh_bind_struct;
+    b->fd = -1;
+    return b;
+}
+
+int ssh_bind_options_set(ssh_bind, enum ssh_bind_options_e, const void*){ return SSH_OK; }
+
+// Port 22 is ignored: the test reads the port back from the listen socket.
+int ssh_bind_listen(ssh_bind b){
+    b->fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (b->fd < 0 || bind(b->fd, (struct sockaddr*)&addr, sizeof(addr)) != 0 || listen(b->fd, 4) != 0) return SSH_ERROR;
+    return SSH_OK;
+}
+
+socket_t ssh_bind_get_fd(ssh_bind b){ return b->fd; }
+
+int ssh_bind_accept(ssh_bind b, ssh_session s){
+    s->fd = accept(b->fd, nullptr, nullptr);
+    return s->fd < 0 ? SSH_ERROR : SSH_OK;
+}
+
+// Past key exchange; unreachable here.
+void ssh_set_auth_methods(ssh_session, int){}
+const char* ssh_get_cipher_out(ssh_session){ return nullptr; }
+const char* ssh_get_hmac_out(ssh_session){ return nullptr; }
+const char* ssh_get_kex_algo(ssh_session){ return nullptr; }
+ssh_message ssh_message_get(ssh_session){ return nullptr; }
+void ssh_message_free(ssh_message){}
+int ssh_message_reply_default(ssh_message){ return SSH_OK; }
+int ssh_message_type(ssh_message){ return 0; }
+int ssh_message_subtype(ssh_message){ return 0; }
+const char* ssh_message_auth_user(ssh_message){ return nullptr; }
+const char* ssh_message_auth_password(ssh_message){ return nullptr; }
+int ssh_message_auth_reply_success(ssh_message, int){ return SSH_OK; }
+int ssh_message_auth_set_methods(ssh_message, int){ return SSH_OK; }
+ssh_channel ssh_message_channel_request_open_reply_accept(ssh_message){ return nullptr; }
+int ssh_message_channel_request_reply_success(ssh_message){ return SSH_OK; }
+const char* ssh_message_channel_request_subsystem(ssh_message){ return nullptr; }
+int ssh_channel_is_open(ssh_channel){ return 0; }
+int ssh_channel_is_eof(ssh_channel){ return 1; }
+void ssh_channel_free(ssh_channel){}
+
+#endif // FAKE_LIBSSH_H
@@ -0,0 +1,61 @@
+#ifndef NATIVE_LIBSSH_SERVER_H
+#define NATIVE_LIBSSH_SERVER_H
+
+// The rest of the libssh API SshServer.cpp calls, with libssh's own names
+// and values; FakeLibssh.h defines it.
+#include <libssh/libssh.h>
+#include <stddef.h>
+
+typedef struct ssh_bind_struct* ssh_bind;
+typedef struct ssh_key_struct* ssh_key;
+typedef int socket_t;
+
+enum ssh_keytypes_e { SSH_KEYTYPE_UNKNOWN = 0, SSH_KEYTYPE_ED25519 = 7 };
+enum ssh_auth_e { SSH_AUTH_SUCCESS = 0, SSH_AUTH_DENIED, SSH_AUTH_PARTIAL, SSH_AUTH_INFO, SSH_AUTH_AGAIN, SSH_AUTH_ERROR = -1 };
+#define SSH_AUTH_METHOD_PASSWORD 0x0002
+
+enum ssh_options_e {
+    SSH_OPTIONS_HOST, SSH_OPTIONS_TIMEOUT = 9, SSH_OPTIONS_COMPRESSION_C_S = 17,
+    SSH_OPTIONS_COMPRESSION_S_C, SSH_OPTIONS_COMPRESSION_LEVEL = 23
+};
+enum ssh_bind_options_e {
+    SSH_BIND_OPTIONS_BINDADDR, SSH_BIND_OPTIONS_BINDPORT, SSH_BIND_OPTIONS_BINDPORT_STR,
+    SSH_BIND_OPTIONS_HOSTKEY, SSH_BIND_OPTIONS_IMPORT_KEY = 10, SSH_BIND_OPTIONS_KEY_EXCHANGE,
+    SSH_BIND_OPTIONS_CIPHERS_C_S, SSH_BIND_OPTIONS_CIPHERS_S_C, SSH_BIND_OPTIONS_HMAC_C_S,
+    SSH_BIND_OPTIONS_HMAC_S_C
+};
+
+struct ssh_counter_struct {
+    uint64_t in_bytes, out_bytes, in_packets, out_packets;
+};
+typedef struct ssh_counter_struct* ssh_counter;
+
+int ssh_init(void);
+ssh_session ssh_new(void);
+void ssh_free(ssh_session session);
+void ssh_disconnect(ssh_session session);
+int ssh_options_set(ssh_session session, enum ssh_options_e type, const void* value);
+const char* ssh_get_error(void* error);
+void ssh_set_counters(ssh_session session, ssh_counter scounter, ssh_counter rcounter);
+int ssh_handle_key_exchange(ssh_session session);
+void ssh_set_auth_methods(ssh_session session, int authMethods);
+const char* ssh_get_cipher_out(ssh_session session);
+const char* ssh_get_hmac_out(ssh_session session);
+const char* ssh_get_kex_algo(ssh_session session);
+int ssh_pki_generate(enum ssh_keytypes_e type, int parameter, ssh_key* pkey);
+
+ssh_bind ssh_bind_new(void);
+int ssh_bind_options_set(ssh_bind sshbind, enum ssh_bind_options_e type, const void* value);
+int ssh_bind_listen(ssh_bind sshbind);
+int ssh_bind_accept(ssh_bind sshbind, ssh_session session);
+socket_t ssh_bind_get_fd(ssh_bind sshbind);
+
+ssh_message ssh_message_get(ssh_session session);
+void ssh_message_free(ssh_message msg);
+int ssh_message_reply_default(ssh_message msg);
+const char* ssh_message_auth_user(ssh_message msg);
+const char* ssh_message_auth_password(ssh_message msg);
+int ssh_message_auth_reply_success(ssh_message msg, int partial);
+int ssh_message_auth_set_methods(ssh_message msg, int methods);
+
+#endif // NATIVE_LIBSSH_SERVER_H
@@ -0,0 +1,7 @@
+#ifndef NATIVE_LIBSSH_ESP32_H
+#define NATIVE_LIBSSH_ESP32_H
+
+// LibSSH-ESP32's platform hook; a no-op on the host.
+void libssh_begin(void);
+
+#endif // NATIVE_LIBSSH_ESP32_H
@@ -0,0 +1,177 @@
+// Host tests for turning clients away on low memory: pio test -e native
+#define SSH_TRACE 0
+#include <unity.h>
+#include <string>
+#include "FakeLibssh.h"
+#include "native_logger.h"
+
+// The native env builds nothing under src/; the units under test come in here.
+#include "SshServer.cpp"
+#include "MemoryBudget.cpp"
+#include "SessionRecorder.cpp"
+#include "AllocTracker.cpp"
+
+// Linked by SshServer.cpp but never reached: every admitted client fails
+// key exchange, so no channel, app or scheduler runs.
+ChannelScheduler* ChannelScheduler::current = nullptr;
+ChannelScheduler::ChannelScheduler(ssh_session, const char*, ChannelMain, void*){}
+void ChannelScheduler::begin(ssh_channel){}
+void ChannelScheduler::finish(){}
+uint8_t ChannelScheduler::live() const { return 0; }
+bool SshLineReader::poll(ssh_channel){ return false; }
+void ssh_write_str(ssh_channel, const char*){}
+void ssh_write_line(ssh_channel, const char*){}
+void ssh_channel_wait(ssh_channel, int){}
+int cmdTokenize(char*, char**, int){ return 0; }
+Blinker ledBlinker;
+bool Blinker::start(float, uint8_t){ return false; }
+void Blinker::set(bool){}
+bool blinkParseArgs(int, char**, BlinkArgs&, char*, size_t){ return false; }
+struct NoGpio : GpioDriver {
+    bool configureOutputs(uint64_t) override { return false; }
+    bool configureInputs(uint64_t, bool) override { return false; }
+    void write(uint64_t, uint64_t) override {}
+    uint64_t read() override { return 0; }
+    uint64_t outputs() override { return 0; }
+};
+static NoGpio noGpio;
+TimedGpioDriver gpioDriver(noGpio);
+bool TimedGpioDriver::configureOutputs(uint64_t){ return false; }
+bool TimedGpioDriver::configureInputs(uint64_t, bool){ return false; }
+void TimedGpioDriver::write(uint64_t, uint64_t){}
+uint64_t TimedGpioDriver::read(){ return 0; }
+bool FreeRtosStatsProvider::sample(SystemSnapshot&){ return false; }
+void runBenchApp(ssh_channel, SshLineReader&, const SshSessionInfo&){}
+void runLogsApp(ssh_channel, SshLineReader&){}
+void runTopApp(ssh_channel, SshLineReader&, SystemStatsProvider&){}
+void runSerialApp(ssh_channel, SshLineReader&){}
+void runGpioApp(ssh_channel, SshLineReader&, TimedGpioDriver&){}
+void runScriptApp(ssh_channel, SshLineReader&){}
+void runRecorderApp(ssh_channel, SshLineReader&){}
+void runHistoryApp(ssh_channel, SshLineReader&){}
+void runRpcSubsystem(ssh_channel, const SshServerStats&){}
+
+// Sessions the server holds the board awake for.
+static int powerSessions = 0;
+void PowerManager::sessionBegin(){ powerSessions++; }
+void PowerManager::sessionEnd(){ powerSessions--; }
+
+static const uint32_t KB = 1024;
+static SshServer server(nullptr);
+static uint16_t port;
+static void* hog;       // the heap some other part of the firmware holds
+
+void setUp(){}
+void tearDown(){}
+
+// A client that connected and sent its version line, queued on the
+// listener before the server looks.
+static int connectClient(){
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    struct sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    TEST_ASSERT_EQUAL_INT(0, connect(fd, (struct sockaddr*)&addr, sizeof(addr)));
+    const char version[] = "SSH-2.0-OpenSSH_9.6\r\n";
+    TEST_ASSERT_EQUAL_INT(sizeof(version) - 1, send(fd, version, sizeof(version) - 1, 0));
+    return fd;
+}
+
+// Everything the server sent until it closed the connection.
+static std::string readToClose(int fd){
+    struct timeval tv = { 2, 0 };
+    setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+    std::string got;
+    char buf[256];
+    ssize_t n;
+    while ((n = recv(fd, buf, sizeof(buf), 0)) > 0) got.append(buf, n);
+    close(fd);
+    return got;
+}
+
+static uint32_t getU32(const std::string& s, size_t at){
+    return (uint32_t)(uint8_t)s[at] << 24 | (uint32_t)(uint8_t)s[at + 1] << 16 |
+           (uint32_t)(uint8_t)s[at + 2] << 8 | (uint8_t)s[at + 3];
+}
+
+// The server's version line, then one unencrypted SSH_MSG_DISCONNECT as a
+// client parses it; returns the description.
+static std::string parseDisconnect(const std::string& got){
+    const std::string version = "SSH-2.0-esp32\r\n";
+    TEST_ASSERT_TRUE(got.compare(0, version.size(), version) == 0);
+    size_t at = version.size();
+    TEST_ASSERT_GREATER_OR_EQUAL(at + 4 + 1 + 1 + 4 + 4, got.size());
+    uint32_t pktLen = getU32(got, at);
+    uint8_t padLen = (uint8_t)got[at + 4];
+    TEST_ASSERT_EQUAL_size_t(at + 4 + pktLen, got.size());
+    TEST_ASSERT_EQUAL_INT(0, (4 + pktLen) % 8);
+    TEST_ASSERT_GREATER_OR_EQUAL(4, padLen);
+    TEST_ASSERT_EQUAL_UINT8(1, (uint8_t)got[at + 5]);                    // SSH_MSG_DISCONNECT
+    TEST_ASSERT_EQUAL_UINT32(7, getU32(got, at + 6));                     // SERVICE_NOT_AVAILABLE
+    uint32_t whyLen = getU32(got, at + 10);
+    TEST_ASSERT_EQUAL_UINT32(pktLen - 1 - padLen - 1 - 4 - 4 - 4, whyLen);
+    return got.substr(at + 14, whyLen);
+}
+
+static bool budgetReports(const char* field){
+    char line[128];
+    MemoryBudget::format(line, sizeof(line));
+    return strstr(line, field) != nullptr;
+}
+
+// With less free than a session plus the reserve, even after shedding the
+// recorder ring and the prewarmed session, two clients in a row get a
+// disconnect with the reason and the listener stays open.
+static void test_low_heap_refuses_clients(){
+    TEST_ASSERT_EQUAL_INT(1, fakeSessionsLive);     // prewarmed by begin()
+    TEST_ASSERT_TRUE(SessionRecorder::enable(4 * KB));
+    size_t keep = SSH_SESSION_HEAP_COST + SSH_HEAP_RESERVE - 1;
+    hog = heap_caps_malloc(heap_caps_get_free_size(MALLOC_CAP_8BIT) + FAKE_SESSION_BYTES - keep, MALLOC_CAP_8BIT);
+    TEST_ASSERT_NOT_NULL(hog);
+
+    for (int i = 0; i < 2; i++){
+        int fd = connectClient();
+        server.handleClient();
+        std::string why = parseDisconnect(readToClose(fd));
+        TEST_ASSERT_TRUE(why.find("Server low on memory") == 0);
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, server.getStats().accepted);
+    TEST_ASSERT_TRUE(budgetReports("mem_level=critical"));
+    TEST_ASSERT_TRUE(budgetReports("mem_shed=2 ssh_refused_lowmem=2"));
+    TEST_ASSERT_FALSE(SessionRecorder::enabled());
+    TEST_ASSERT_EQUAL_INT(0, fakeSessionsLive);
+    TEST_ASSERT_EQUAL_size_t(keep, heap_caps_get_free_size(MALLOC_CAP_8BIT));
+    TEST_ASSERT_EQUAL_INT(0, powerSessions);
+    TEST_ASSERT_TRUE(server.listenFd() >= 0);
+}
+
+// Once the heap is back, the next client is served again (here up to the
+// fake's failing key exchange), recording resumes and a session is
+// prewarmed for the one after.
+static void test_recovered_heap_admits_again(){
+    heap_caps_free(hog);
+    int fd = connectClient();
+    server.handleClient();
+    TEST_ASSERT_EQUAL_size_t(0, readToClose(fd).size());
+    TEST_ASSERT_EQUAL_UINT32(1, server.getStats().accepted);
+    TEST_ASSERT_EQUAL_UINT32(1, server.getStats().kexFailed);
+    TEST_ASSERT_TRUE(budgetReports("ssh_refused_lowmem=2"));
+    TEST_ASSERT_TRUE(SessionRecorder::enabled());
+    TEST_ASSERT_EQUAL_INT(1, fakeSessionsLive);
+    TEST_ASSERT_EQUAL_INT(0, powerSessions);
+}
+
+int main(int, char**){
+    nativeHeapReset(128 * KB, 112 * KB);
+    server.begin();
+    struct sockaddr_in addr;
+    socklen_t len = sizeof(addr);
+    getsockname(server.listenFd(), (struct sockaddr*)&addr, &len);
+    port = ntohs(addr.sin_port);
+
+    UNITY_BEGIN();
+    RUN_TEST(test_low_heap_refuses_clients);
+    RUN_TEST(test_recovered_heap_admits_again);
+    return UNITY_END();
+}
@@ -0,0 +1,50 @@
+#ifndef FAKE_STATS_PROVIDER_H
+#define FAKE_STATS_PROVIDER_H
+
+#include "SystemStats.h"
+#include <stdio.h>
+#include <string.h>
+
+// Stand-in for FreeRTOS run-time stats: fixed tasks, each taking a set share
+// of all cores between two samples. Samples fail once `failFrom` samples
+// have been taken, as with more tasks than STATS_MAX_TASKS.
+class FakeStatsProvider : public SystemStatsProvider {
+public:
+    static const uint32_t TICKS_PER_SAMPLE = 10000;    // per core
+
+    uint32_t samples = 0;
+    uint32_t failFrom = 0xffffffff;
+
+    FakeStatsProvider(){ memset(&state, 0, sizeof(state)); state.nCores = 2; }
+
+    // A task using `permille` of both cores' time.
+    void addTask(const char* name, uint32_t permille, uint8_t priority = 1, int8_t core = -1){
+        TaskSample& t = state.tasks[state.nTasks];
+        snprintf(t.name, sizeof(t.name), "%s", name);
+        t.id = state.nTasks + 1;
+        t.stackFreeMin = 1024 + 64 * state.nTasks;
+        t.priority = priority;
+        t.core = core;
+        t.state = 'B';
+        shares[state.nTasks++] = permille;
+    }
+
+    bool sample(SystemSnapshot& out) override {
+        if (samples++ >= failFrom) return false;
+        state.totalRuntime += TICKS_PER_SAMPLE;
+        for (uint8_t i = 0; i < state.nTasks; i++){
+            state.tasks[i].runtime += TICKS_PER_SAMPLE * state.nCores / 1000 * shares[i];
+        }
+        state.freeHeap = 180000 - 100 * samples;
+        state.minFreeHeap = 150000;
+        state.largestBlock = 110000;
+        out = state;
+        return true;
+    }
+
+private:
+    SystemSnapshot state;
+    uint32_t shares[STATS_MAX_TASKS];
+};
+
+#endif // FAKE_STATS_PROVIDER_H
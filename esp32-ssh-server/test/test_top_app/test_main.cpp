@@ -0,0 +1,122 @@
+// Host tests and render benchmark for the top app: pio test -e native
+#include <unity.h>
+#include <chrono>
+#include <string>
+#include "FakeStatsProvider.h"
+
+// The native env builds nothing under src/; the unit under test comes in here.
+#include "TopApp.cpp"
+
+// The channel is a transcript of what the app wrote; time only passes in
+// waits, so the refresh and retry schedule runs without sleeping.
+struct ssh_channel_struct {
+    std::string out;
+    unsigned long quitAtMs;     // the client types "q" once this is reached
+};
+
+int ssh_channel_is_open(ssh_channel){ return 1; }
+int ssh_channel_is_eof(ssh_channel){ return 0; }
+
+int ssh_write(ssh_channel ch, const void* data, uint32_t len){
+    ch->out.append((const char*)data, len);
+    return (int)len;
+}
+void ssh_write_str(ssh_channel ch, const char* s){ ch->out += s; }
+void ssh_write_line(ssh_channel ch, const char* s){ ch->out += std::string(s) + "\r\n"; }
+void ssh_channel_wait(ssh_channel, int timeoutMs){ nativeAdvanceMs(timeoutMs > 0 ? timeoutMs : 1); }
+
+bool SshLineReader::poll(ssh_channel ch){
+    if (millis() < ch->quitAtMs) return false;
+    strcpy(buf, "q");
+    return true;
+}
+
+void setUp(){}
+void tearDown(){}
+
+static size_t renderPair(FakeStatsProvider& stats){
+    TEST_ASSERT_TRUE(stats.sample(snapA));
+    TEST_ASSERT_TRUE(stats.sample(snapB));
+    return renderFrame(snapA, snapB, TOP_REFRESH_MS, 0, 0, 0);
+}
+
+static void test_frame_lists_busiest_first(){
+    FakeStatsProvider stats;
+    stats.addTask("idle0", 300, 0, 0);
+    stats.addTask("ssh", 450, 5, 1);
+    stats.addTask("log", 25);
+    size_t len = renderPair(stats);
+    std::string f(frame, len);
+    size_t ssh = f.find("ssh "), idle = f.find("idle0 "), log = f.find("log ");
+    TEST_ASSERT_TRUE(ssh != std::string::npos && idle != std::string::npos && log != std::string::npos);
+    TEST_ASSERT_TRUE(ssh < idle && idle < log);
+    TEST_ASSERT_TRUE(f.find("  45.0    5    1") != std::string::npos);
+    TEST_ASSERT_TRUE(f.find("   2.5    1    *") != std::string::npos);
+    TEST_ASSERT_TRUE(f.find("tasks 3") != std::string::npos);
+}
+
+// A full task table still fits the frame buffer, down to the final erase.
+static void test_full_table_fits_frame(){
+    FakeStatsProvider stats;
+    char name[16];
+    for (int i = 0; i < STATS_MAX_TASKS; i++){
+        snprintf(name, sizeof(name), "task_%02d_padded", i);
+        stats.addTask(name, 1000 / STATS_MAX_TASKS);
+    }
+    size_t len = renderPair(stats);
+    TEST_ASSERT_LESS_THAN(sizeof(frame) - 1, len);
+    TEST_ASSERT_EQUAL_MEMORY("\x1b[J", frame + len - 3, 3);
+}
+
+// After a failed sample the app shows why and samples again only every
+// TOP_RETRY_MS, instead of every refresh.
+static void test_failed_sample_backs_off(){
+    FakeStatsProvider stats;
+    stats.addTask("ssh", 100);
+    stats.failFrom = 2;
+    ssh_channel_struct ch;
+    ch.quitAtMs = millis() + 2 * TOP_REFRESH_MS + 2 * TOP_RETRY_MS + TOP_REFRESH_MS / 2;
+    SshLineReader reader;
+    runTopApp(&ch, reader, stats);
+    // first sample, one frame, then failures at refresh 2 and after each retry
+    TEST_ASSERT_EQUAL_UINT32(5, stats.samples);
+    TEST_ASSERT_TRUE(ch.out.find("retry in 5 s") != std::string::npos);
+    TEST_ASSERT_TRUE(ch.out.find("(leaving top)") != std::string::npos);
+}
+
+static void test_first_sample_failing_quits(){
+    FakeStatsProvider stats;
+    stats.failFrom = 0;
+    ssh_channel_struct ch;
+    ch.quitAtMs = 0;
+    SshLineReader reader;
+    runTopApp(&ch, reader, stats);
+    TEST_ASSERT_EQUAL_STRING("top: too many tasks, raise STATS_MAX_TASKS\r\n", ch.out.c_str());
+}
+
+// Not a pass/fail check: render cost of a full table, next to the other RESULT lines.
+static void test_render_benchmark(){
+    const int ITERATIONS = 20000;
+    FakeStatsProvider stats;
+    char name[16];
+    for (int i = 0; i < STATS_MAX_TASKS; i++){
+        snprintf(name, sizeof(name), "task%02d", i);
+        stats.addTask(name, (uint32_t)(i * 7 % 40));
+    }
+    size_t len = renderPair(stats);
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < ITERATIONS; i++) len = renderFrame(snapA, snapB, TOP_REFRESH_MS, 0, 0, len);
+    double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count();
+    printf("RESULT test=top_render tasks=%u bytes=%u us_per_frame=%.2f\n",
+           (unsigned)STATS_MAX_TASKS, (unsigned)len, us / ITERATIONS);
+}
+
+int main(int, char**){
+    UNITY_BEGIN();
+    RUN_TEST(test_frame_lists_busiest_first);
+    RUN_TEST(test_full_table_fits_frame);
+    RUN_TEST(test_failed_sample_backs_off);
+    RUN_TEST(test_first_sample_failing_quits);
+    RUN_TEST(test_render_benchmark);
+    return UNITY_END();
+}
@@ -0,0 +1,204 @@
+// Host tests for the timeline tracer and its Chrome trace dump: pio test -e native
+#define SSH_TRACE 1
+#define SSH_TRACE_EVENTS 64
+#include <unity.h>
+#include <ctype.h>
+#include <string>
+#include <vector>
+
+// The native env builds nothing under src/; the units under test come in here.
+#include "CmdLine.cpp"
+#include "SessionRecorder.cpp"
+#include "Tracer.cpp"
+#include "RecorderApp.cpp"
+
+// The channel is a transcript of what the app wrote; the client types the
+// scripted lines in order, then "q".
+struct ssh_channel_struct {
+    std::string out;
+    std::vector<std::string> lines;
+    size_t next = 0;
+};
+
+int ssh_channel_is_open(ssh_channel){ return 1; }
+int ssh_channel_is_eof(ssh_channel){ return 0; }
+
+int ssh_write(ssh_channel ch, const void* data, uint32_t len){
+    ch->out.append((const char*)data, len);
+    return (int)len;
+}
+void ssh_write_str(ssh_channel ch, const char* s){ ch->out += s; }
+void ssh_write_line(ssh_channel ch, const char* s){ ch->out += std::string(s) + "\r\n"; }
+void ssh_channel_wait(ssh_channel, int){}
+
+bool SshLineReader::poll(ssh_channel ch){
+    const char* line = ch->next < ch->lines.size() ? ch->lines[ch->next].c_str() : "q";
+    ch->next++;
+    snprintf(buf, sizeof(buf), "%s", line);
+    return true;
+}
+
+// Just enough of a JSON parser to say whether a dump is well formed.
+struct JsonCheck {
+    const char* p;
+
+    void ws(){ while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') p++; }
+    bool lit(const char* s){
+        size_t n = strlen(s);
+        if (strncmp(p, s, n)) return false;
+        p += n;
+        return true;
+    }
+    bool string(){
+        if (*p++ != '"') return false;
+        while (*p && *p != '"'){
+            if ((unsigned char)*p < 0x20) return false;
+            if (*p == '\\'){
+                p++;
+                if (*p == 'u'){
+                    for (int i = 1; i <= 4; i++) if (!isxdigit((unsigned char)p[i])) return false;
+                    p += 4;
+                } else if (!strchr("\"\\/bfnrt", *p) || !*p){
+                    return false;
+                }
+            }
+            p++;
+        }
+        return *p++ == '"';
+    }
+    bool number(){
+        const char* start = p;
+        if (*p == '-') p++;
+        while (isdigit((unsigned char)*p) || *p == '.' || *p == 'e' || *p == 'E' || *p == '+' || *p == '-') p++;
+        return p > start && isdigit((unsigned char)p[-1]);
+    }
+    bool value(){
+        ws();
+        if (*p == '{') return members('}', true);
+        if (*p == '[') return members(']', false);
+        if (*p == '"') return string();
+        if (lit("true") || lit("false") || lit("null")) return true;
+        return number();
+    }
+    bool members(char close, bool object){
+        p++;
+        ws();
+        if (*p == close){ p++; return true; }
+        for (;;){
+            if (object){
+                ws();
+                if (!string()) return false;
+                ws();
+                if (*p++ != ':') return false;
+            }
+            if (!value()) return false;
+            ws();
+            if (*p == close){ p++; return true; }
+            if (*p++ != ',') return false;
+        }
+    }
+    static bool parses(const std::string& text){
+        JsonCheck j = { text.c_str() };
+        if (!j.value()) return false;
+        j.ws();
+        return *j.p == '\0';
+    }
+};
+
+static std::string between(const std::string& out, const char* begin, const char* end){
+    size_t a = out.find(std::string(begin) + "\r\n");
+    size_t b = out.find(end);
+    if (a == std::string::npos || b == std::string::npos || b < a) return "";
+    a += strlen(begin) + 2;
+    return out.substr(a, b - a);
+}
+
+static size_t count(const std::string& s, const char* what){
+    size_t n = 0;
+    for (size_t at = s.find(what); at != std::string::npos; at = s.find(what, at + 1)) n++;
+    return n;
+}
+
+static std::string dumpTrace(){
+    ssh_channel_struct ch;
+    ch.lines = { "trace dump" };
+    SshLineReader reader;
+    runRecorderApp(&ch, reader);
+    return between(ch.out, RECORDER_TRACE_BEGIN, RECORDER_TRACE_END);
+}
+
+static TaskHandle_t mainTask;
+
+static void workerTask(void*){
+    {
+        TRACE_SCOPE("work");
+        TRACE_INSTANT("tick", 7);
+    }
+    xTaskNotifyGive(mainTask);
+    vTaskDelete(nullptr);
+}
+
+void setUp(){
+    Tracer::clear();
+    Tracer::setPaused(false);
+}
+void tearDown(){}
+
+// Spans and instants from two tasks come out as Chrome trace JSON, with a
+// named track per task.
+static void test_dump_is_chrome_json(){
+    mainTask = xTaskGetCurrentTaskHandle();
+    TRACE_BEGIN("session");
+    TRACE_INSTANT("ch_read", 3);
+    xTaskCreatePinnedToCore(workerTask, "worker", 4096, nullptr, 1, nullptr, 0);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    TRACE_END("session");
+
+    std::string json = dumpTrace();
+    TEST_ASSERT_TRUE(JsonCheck::parses(json));
+    TEST_ASSERT_EQUAL_size_t(2, count(json, "\"ph\": \"B\""));
+    TEST_ASSERT_EQUAL_size_t(2, count(json, "\"ph\": \"E\""));
+    TEST_ASSERT_TRUE(json.find("\"name\": \"tick\", \"ph\": \"i\"") != std::string::npos);
+    TEST_ASSERT_TRUE(json.find("\"args\": {\"v\": 7}") != std::string::npos);
+    TEST_ASSERT_TRUE(json.find("\"args\": {\"name\": \"main\"}") != std::string::npos);
+    TEST_ASSERT_TRUE(json.find("\"args\": {\"name\": \"worker\"}") != std::string::npos);
+    TEST_ASSERT_TRUE(json.find("\"overwritten\": 0") != std::string::npos);
+    // The dump itself is not traced, and tracing resumes after it.
+    TEST_ASSERT_FALSE(Tracer::isPaused());
+    TEST_ASSERT_EQUAL_UINT32(6, Tracer::stats().recorded);
+}
+
+// A wrapped ring, with ends whose begins were overwritten, still parses.
+static void test_wrapped_ring_still_parses(){
+    for (int i = 0; i < SSH_TRACE_EVENTS + 9; i++){
+        TRACE_SCOPE("loop");
+    }
+    std::string json = dumpTrace();
+    TEST_ASSERT_TRUE(JsonCheck::parses(json));
+    char overwritten[32];
+    snprintf(overwritten, sizeof(overwritten), "\"overwritten\": %u", (unsigned)(SSH_TRACE_EVENTS + 18));
+    TEST_ASSERT_TRUE(json.find(overwritten) != std::string::npos);
+    TEST_ASSERT_EQUAL_size_t(SSH_TRACE_EVENTS, count(json, "\"name\": \"loop\""));
+}
+
+static void test_empty_ring_parses(){
+    std::string json = dumpTrace();
+    TEST_ASSERT_TRUE(JsonCheck::parses(json));
+}
+
+// The checker itself: catches what a broken dump would look like.
+static void test_checker_rejects_bad_json(){
+    TEST_ASSERT_TRUE(JsonCheck::parses("{\"a\": [1, -2.5e3, \"x\\u0001\", true, null]}"));
+    TEST_ASSERT_FALSE(JsonCheck::parses("{\"a\": [1, 2,]}"));
+    TEST_ASSERT_FALSE(JsonCheck::parses("{\"a\": 1"));
+    TEST_ASSERT_FALSE(JsonCheck::parses("{\"a\": \"b\"} x"));
+}
+
+int main(int, char**){
+    UNITY_BEGIN();
+    RUN_TEST(test_dump_is_chrome_json);
+    RUN_TEST(test_wrapped_ring_still_parses);
+    RUN_TEST(test_empty_ring_parses);
+    RUN_TEST(test_checker_rejects_bad_json);
+    return UNITY_END();
+}
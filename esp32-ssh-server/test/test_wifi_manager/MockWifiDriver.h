@@ -0,0 +1,43 @@
+#ifndef MOCK_WIFI_DRIVER_H
+#define MOCK_WIFI_DRIVER_H
+
+#include "WifiManager.h"
+#include <string.h>
+
+// Records what WifiManager asked of the radio and keeps the "NVS" cache in
+// memory, so a test can reboot by constructing a new WifiManager on it.
+class MockWifiDriver : public WifiDriver {
+public:
+    // Last begin(): 0 / nullptr when WifiManager asked for a scan.
+    uint8_t beginChannel = 0xff;
+    const uint8_t* beginBssid = nullptr;
+    uint32_t begins = 0;
+    uint32_t configuredIp = 0xffffffff;     // last configIp(); 0 = DHCP
+    WifiCache stored = {};
+    bool hasCache = false;
+    uint32_t saves = 0, erases = 0;
+
+    void begin(const char*, const char*, uint8_t channel, const uint8_t* bssid) override {
+        beginChannel = channel;
+        beginBssid = bssid;
+        begins++;
+    }
+    void configIp(uint32_t ip, uint32_t, uint32_t, uint32_t) override { configuredIp = ip; }
+    uint32_t dnsIp() override { return 0x08080808; }
+    bool loadCache(WifiCache& cache) override {
+        if (hasCache) cache = stored;
+        return hasCache;
+    }
+    void saveCache(const WifiCache& cache) override {
+        stored = cache;
+        hasCache = true;
+        saves++;
+    }
+    void eraseCache() override {
+        memset(&stored, 0, sizeof(stored));
+        hasCache = false;
+        erases++;
+    }
+};
+
+#endif // MOCK_WIFI_DRIVER_H
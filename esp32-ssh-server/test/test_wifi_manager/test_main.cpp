@@ -0,0 +1,127 @@
+// Host tests for the Wi-Fi rejoin strategy: pio test -e native
+#include <unity.h>
+#include "MockWifiDriver.h"
+#include "native_logger.h"
+
+// The native env builds nothing under src/; the unit under test comes in here.
+#include "WifiManager.cpp"
+
+static const uint8_t AP_A[6] = { 0x24, 0x0a, 0xc4, 0x01, 0x02, 0x03 };
+static const uint8_t AP_B[6] = { 0x24, 0x0a, 0xc4, 0x0a, 0x0b, 0x0c };
+static const uint32_t IP = 0x0a00a8c0, GATEWAY = 0x0100a8c0, NETMASK = 0x00ffffff;
+
+static MockWifiDriver* radio;
+
+void setUp(){ radio = new MockWifiDriver(); }
+void tearDown(){ delete radio; }
+
+// A join that reaches an IPv4 address through `bssid` on `channel`.
+static void joinVia(WifiManager& wifi, const uint8_t* bssid, uint8_t channel){
+    wifi.onConnected(bssid, channel);
+    wifi.onGotIp(IP, GATEWAY, NETMASK);
+}
+
+static void test_first_boot_scans_and_caches(){
+    WifiManager wifi(*radio);
+    wifi.connect("ssid", "pass");
+    TEST_ASSERT_EQUAL(WIFI_FULL_SCAN, wifi.strategy());
+    TEST_ASSERT_EQUAL(0, radio->beginChannel);
+    TEST_ASSERT_NULL(radio->beginBssid);
+    TEST_ASSERT_EQUAL_UINT32(0, radio->configuredIp);
+
+    nativeAdvanceMs(1500);
+    joinVia(wifi, AP_A, 6);
+    TEST_ASSERT_EQUAL_UINT32(1, radio->saves);
+    TEST_ASSERT_EQUAL_MEMORY(AP_A, radio->stored.bssid, 6);
+    TEST_ASSERT_EQUAL(6, radio->stored.channel);
+    TEST_ASSERT_EQUAL_UINT32(WIFI_CACHE_LEASE ? IP : 0, radio->stored.ip);
+    TEST_ASSERT_GREATER_OR_EQUAL(1500, wifi.joinStats(WIFI_FULL_SCAN).lastMs);
+    TEST_ASSERT_EQUAL_UINT32(1, wifi.joinStats(WIFI_FULL_SCAN).joined);
+
+    // A lease renewal on the live link is not a join and writes nothing.
+    wifi.onGotIp(IP, GATEWAY, NETMASK);
+    TEST_ASSERT_EQUAL_UINT32(1, radio->saves);
+}
+
+static void test_cached_rejoin_skips_scan(){
+    { WifiManager boot1(*radio); boot1.connect("ssid", "pass"); joinVia(boot1, AP_A, 6); }
+
+    WifiManager wifi(*radio);
+    wifi.connect("ssid", "pass");
+    TEST_ASSERT_EQUAL(WIFI_CACHED, wifi.strategy());
+    TEST_ASSERT_EQUAL(6, radio->beginChannel);
+    TEST_ASSERT_NOT_NULL(radio->beginBssid);
+    TEST_ASSERT_EQUAL_MEMORY(AP_A, radio->beginBssid, 6);
+    TEST_ASSERT_EQUAL_UINT32(WIFI_CACHE_LEASE ? IP : 0, radio->configuredIp);
+
+    // Same AP and channel again: the flash is left alone.
+    joinVia(wifi, AP_A, 6);
+    TEST_ASSERT_EQUAL_UINT32(1, radio->saves);
+    TEST_ASSERT_EQUAL_UINT32(1, wifi.joinStats(WIFI_CACHED).joined);
+
+    // Losing a live link is not a failed cached join: keep the cache.
+    wifi.onDisconnected(8);
+    TEST_ASSERT_EQUAL_UINT32(0, radio->erases);
+    wifi.connect("ssid", "pass");
+    TEST_ASSERT_EQUAL(WIFI_CACHED, wifi.strategy());
+}
+
+// The AP moved to another BSSID/channel: the cached join fails, the cache is
+// erased (so a reboot does not retry it), the next attempt scans, and the
+// cache is rebuilt from the join that works.
+static void test_stale_cache_falls_back_to_full_scan(){
+    { WifiManager boot1(*radio); boot1.connect("ssid", "pass"); joinVia(boot1, AP_A, 6); }
+
+    WifiManager wifi(*radio);
+    wifi.connect("ssid", "pass");
+    TEST_ASSERT_EQUAL(WIFI_CACHED, wifi.strategy());
+    wifi.onDisconnected(201); // NO_AP_FOUND
+    TEST_ASSERT_EQUAL_UINT32(1, radio->erases);
+    TEST_ASSERT_FALSE(radio->hasCache);
+
+    wifi.connect("ssid", "pass");
+    TEST_ASSERT_EQUAL(WIFI_FULL_SCAN, wifi.strategy());
+    TEST_ASSERT_EQUAL(0, radio->beginChannel);
+    TEST_ASSERT_NULL(radio->beginBssid);
+    TEST_ASSERT_EQUAL_UINT32(0, radio->configuredIp);
+
+    // A failed scan attempt keeps scanning and erases nothing more.
+    wifi.onDisconnected(201);
+    wifi.connect("ssid", "pass");
+    TEST_ASSERT_EQUAL(WIFI_FULL_SCAN, wifi.strategy());
+    TEST_ASSERT_EQUAL_UINT32(1, radio->erases);
+
+    joinVia(wifi, AP_B, 11);
+    TEST_ASSERT_EQUAL_UINT32(2, radio->saves);
+    TEST_ASSERT_EQUAL_MEMORY(AP_B, radio->stored.bssid, 6);
+    TEST_ASSERT_EQUAL(11, radio->stored.channel);
+
+    wifi.onDisconnected(8);
+    wifi.connect("ssid", "pass");
+    TEST_ASSERT_EQUAL(WIFI_CACHED, wifi.strategy());
+    TEST_ASSERT_EQUAL(11, radio->beginChannel);
+    TEST_ASSERT_EQUAL_UINT32(2, wifi.joinStats(WIFI_CACHED).attempts);
+    TEST_ASSERT_EQUAL_UINT32(0, wifi.joinStats(WIFI_CACHED).joined);
+}
+
+static void test_format_fits_buffer(){
+    WifiManager wifi(*radio);
+    wifi.connect("ssid", "pass");
+    joinVia(wifi, AP_A, 6);
+    char out[300];
+    size_t n = wifi.format(out, sizeof(out));
+    TEST_ASSERT_EQUAL_size_t(strlen(out), n);
+    TEST_ASSERT_NOT_NULL(strstr(out, "wifi_scan_attempts=1 wifi_scan_joined=1"));
+    n = wifi.format(out, 40);
+    TEST_ASSERT_LESS_THAN(40, n);
+    TEST_ASSERT_EQUAL_size_t(strlen(out), n);
+}
+
+int main(int, char**){
+    UNITY_BEGIN();
+    RUN_TEST(test_first_boot_scans_and_caches);
+    RUN_TEST(test_cached_rejoin_skips_scan);
+    RUN_TEST(test_stale_cache_falls_back_to_full_scan);
+    RUN_TEST(test_format_fits_buffer);
+    return UNITY_END();
+}
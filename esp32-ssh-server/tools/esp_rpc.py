@@ -0,0 +1,157 @@
+#!/usr/bin/env python3
+"""Client for the device's "esp-rpc" SSH subsystem (src/rpc/RpcServer.h).
+
+Single calls:
+
+    python3 tools/esp_rpc.py 192.168.1.7 call sys_info
+    python3 tools/esp_rpc.py 192.168.1.7 call led_blink 5
+
+Pipelined throughput (keeps --window requests in flight):
+
+    python3 tools/esp_rpc.py 192.168.1.7 bench --count 5000 --window 32
+
+Requires: pip install paramiko
+"""
+import argparse
+import json
+import struct
+import sys
+import time
+
+import paramiko
+
+METHODS = {"ping": 0, "sys_info": 1, "srv_stats": 2, "led_set": 3, "led_blink": 4, "led_get": 5,
+           "gpio_output": 6, "gpio_write": 7, "gpio_read": 8}
+STATUS = {0: "ok", 1: "bad_method", 2: "bad_args", 3: "failed"}
+
+
+class RpcClient:
+    def __init__(self, host, port, user, password, timeout):
+        self.client = paramiko.SSHClient()
+        self.client.set_missing_host_key_policy(paramiko.AutoAddPolicy())
+        self.client.connect(host, port=port, username=user, password=password,
+                            look_for_keys=False, allow_agent=False, timeout=timeout)
+        self.chan = self.client.get_transport().open_session(timeout=timeout)
+        self.chan.settimeout(timeout)
+        self.chan.invoke_subsystem("esp-rpc")
+        self.buf = b""
+        self.next_id = 0
+
+    def close(self):
+        self.client.close()
+
+    def send(self, method, args=b""):
+        rid = self.next_id
+        self.next_id = (self.next_id + 1) & 0xFFFFFFFF
+        self.chan.sendall(struct.pack(">IIB", 5 + len(args), rid, method) + args)
+        return rid
+
+    def recv(self):
+        """Next response as (id, status, body)."""
+        while True:
+            if len(self.buf) >= 4:
+                (n,) = struct.unpack(">I", self.buf[:4])
+                if len(self.buf) >= 4 + n:
+                    rid, status = struct.unpack(">IB", self.buf[4:9])
+                    body = self.buf[9:4 + n]
+                    self.buf = self.buf[4 + n:]
+                    return rid, status, body
+            data = self.chan.recv(65536)
+            if not data:
+                raise EOFError("subsystem channel closed")
+            self.buf += data
+
+    def call(self, method, args=b""):
+        rid = self.send(method, args)
+        got, status, body = self.recv()
+        if got != rid:
+            raise RuntimeError("response id %d, expected %d" % (got, rid))
+        return status, body
+
+
+def decode(name, body):
+    if name == "sys_info":
+        return dict(zip(("uptime_ms", "free_heap", "min_free_heap", "largest_block"),
+                        struct.unpack(">4I", body)))
+    if name == "srv_stats":
+        return dict(zip(("accepted", "accept_failed", "kex_failed", "auth_failed", "dropped", "completed"),
+                        struct.unpack(">6I", body)))
+    if name == "led_blink":
+        return {"hz": struct.unpack(">I", body)[0] / 1000.0}
+    if name == "led_get":
+        on, blinking, mhz = struct.unpack(">BBI", body)
+        return {"on": bool(on), "blinking": bool(blinking), "hz": mhz / 1000.0}
+    if name == "gpio_read":
+        inp, out = struct.unpack(">QQ", body)
+        return {"in": "0x%010x" % inp, "out": "0x%010x" % out}
+    return {"body": body.hex()}
+
+
+def encode(name, args):
+    if name == "led_set":
+        return struct.pack(">B", int(args[0]))
+    if name == "led_blink":
+        return struct.pack(">I", int(float(args[0]) * 1000))
+    if name == "gpio_output":
+        return struct.pack(">Q", int(args[0], 0))
+    if name == "gpio_write":
+        return struct.pack(">QQ", int(args[0], 0), int(args[1], 0))
+    if name == "ping":
+        return " ".join(args).encode()
+    return b""
+
+
+def bench(rpc, count, window):
+    latencies = []
+    sent_at = {}
+    t0 = time.perf_counter()
+    sent = done = 0
+    while done < count:
+        while sent < count and sent - done < window:
+            sent_at[rpc.send(METHODS["ping"], b"x" * 8)] = time.perf_counter()
+            sent += 1
+        rid, status, _ = rpc.recv()
+        if status != 0:
+            raise RuntimeError("ping %d failed: %s" % (rid, STATUS.get(status, status)))
+        latencies.append((time.perf_counter() - sent_at.pop(rid)) * 1000.0)
+        done += 1
+    elapsed = time.perf_counter() - t0
+    latencies.sort()
+    pick = lambda p: round(latencies[min(len(latencies) - 1, int(p / 100.0 * len(latencies)))], 2)
+    return {"test": "rpc_pipeline", "calls": count, "window": window, "seconds": round(elapsed, 3),
+            "calls_per_s": round(count / elapsed, 1), "p50_ms": pick(50), "p99_ms": pick(99)}
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("host")
+    ap.add_argument("--port", type=int, default=22)
+    ap.add_argument("--user", default="cago")
+    ap.add_argument("--password", default="cago1231")
+    ap.add_argument("--timeout", type=float, default=15.0)
+    sub = ap.add_subparsers(dest="cmd", required=True)
+    c = sub.add_parser("call")
+    c.add_argument("method", choices=sorted(METHODS))
+    c.add_argument("args", nargs="*")
+    b = sub.add_parser("bench")
+    b.add_argument("--count", type=int, default=2000)
+    b.add_argument("--window", type=int, default=32)
+    args = ap.parse_args()
+
+    rpc = RpcClient(args.host, args.port, args.user, args.password, args.timeout)
+    try:
+        if args.cmd == "bench":
+            print(json.dumps(bench(rpc, args.count, args.window), sort_keys=True))
+            return 0
+        status, body = rpc.call(METHODS[args.method], encode(args.method, args.args))
+        out = {"method": args.method, "status": STATUS.get(status, status)}
+        if status == 0:
+            out.update(decode(args.method, body))
+        print(json.dumps(out, sort_keys=True))
+        return 0 if status == 0 else 1
+    finally:
+        rpc.close()
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+"""Throughput / integrity check for the "serial" bridge app (menu item 6).
+
+Jumper the bridge UART's TX to RX (GPIO17 -> GPIO16 by default), then:
+
+    python3 tools/serial_loopback.py 192.168.1.7 --baud 921600 --size 1048576
+
+Streams random bytes through SSH -> UART TX -> UART RX -> SSH, verifies the
+echoed stream byte for byte and prints one JSON object with the achieved
+rate and the device's overrun counters. Exits non-zero on any loss or
+corruption.
+
+Requires: pip install paramiko
+"""
+import argparse
+import json
+import os
+import sys
+import threading
+import time
+
+from ssh_bench import BenchSession
+
+ESCAPE = 0x1D  # Ctrl-], ends the bridge
+
+
+def payload(size):
+    data = bytearray(os.urandom(size))
+    for i, b in enumerate(data):
+        if b == ESCAPE:
+            data[i] = ESCAPE + 1
+    return bytes(data)
+
+
+def run(args):
+    s = BenchSession(args.host, args.port, args.user, args.password, args.timeout)
+    try:
+        s.send_line("6")
+        s.read_until(b"]: ")
+        s.send_line(str(args.baud))
+        s.read_until(b"Ctrl-] to return.\r\n")
+
+        data = payload(args.size)
+        received = bytearray(s.buf)
+        s.buf = b""
+        t0 = time.perf_counter()
+
+        def writer():
+            for off in range(0, len(data), 4096):
+                s.chan.sendall(data[off:off + 4096])
+
+        th = threading.Thread(target=writer, daemon=True)
+        th.start()
+        while len(received) < len(data):
+            chunk = s.chan.recv(65536)
+            if not chunk:
+                raise EOFError("channel closed after %d bytes" % len(received))
+            received += chunk
+        elapsed = time.perf_counter() - t0
+        th.join()
+
+        s.chan.sendall(bytes([ESCAPE]))
+        s.buf = bytes(received[len(data):])
+        result = s.result("serial")
+    except Exception:
+        s.close()
+        raise
+    s.close()
+
+    echoed = bytes(received[:len(data)])
+    first_bad = next((i for i, (a, b) in enumerate(zip(data, echoed)) if a != b), None)
+    result.update({
+        "bytes": len(data),
+        "seconds": round(elapsed, 3),
+        "bytes_per_s": round(len(data) / elapsed),
+        "line_rate_bytes_per_s": args.baud // 10,
+        "intact": first_bad is None,
+    })
+    if first_bad is not None:
+        result["first_mismatch"] = first_bad
+    print(json.dumps(result, sort_keys=True))
+    drops = sum(int(result.get(k, 0)) for k in ("fifo_ovf", "buf_full", "line_err"))
+    return 0 if first_bad is None and drops == 0 else 1
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("host")
+    ap.add_argument("--port", type=int, default=22)
+    ap.add_argument("--user", default="cago")
+    ap.add_argument("--password", default="cago1231")
+    ap.add_argument("--baud", type=int, default=921600)
+    ap.add_argument("--size", type=int, default=256 * 1024, help="bytes to loop back")
+    ap.add_argument("--timeout", type=float, default=30.0)
+    return run(ap.parse_args())
+
+
+if __name__ == "__main__":
+    sys.exit(main())
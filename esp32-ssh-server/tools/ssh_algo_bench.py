@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+"""Per-algorithm handshake and throughput matrix against the bench app.
+
+Runs the OpenSSH client once per cipher/KEX candidate (paramiko lacks
+chacha20-poly1305 and AES-GCM), drives menu item 3 over stdin, and prints
+one JSON object per candidate plus a summary table on stderr:
+
+    SSHPASS=cago1231 python3 tools/ssh_algo_bench.py 192.168.1.7 --size 262144
+
+Requires: ssh, sshpass
+"""
+import argparse
+import itertools
+import json
+import os
+import subprocess
+import sys
+import time
+
+CIPHERS = [
+    ("chacha20-poly1305@openssh.com", None),
+    ("aes128-gcm@openssh.com", None),
+    ("aes128-ctr", "hmac-sha2-256"),
+]
+KEXES = ["curve25519-sha256", "ecdh-sha2-nistp256"]
+
+
+def parse_results(text):
+    out = {}
+    for line in text.splitlines():
+        idx = line.find("RESULT test=")
+        if idx < 0:
+            continue
+        fields = {}
+        for tok in line[idx + len("RESULT "):].split():
+            k, sep, v = tok.partition("=")
+            if sep:
+                fields[k] = v
+        out[fields.get("test", "?")] = fields
+    return out
+
+
+def run_candidate(args, cipher, mac, kex):
+    cmd = ["sshpass", "-e", "ssh", "-T",
+           "-p", str(args.port),
+           "-o", "StrictHostKeyChecking=no",
+           "-o", "UserKnownHostsFile=/dev/null",
+           "-o", "PreferredAuthentications=password",
+           "-o", "PubkeyAuthentication=no",
+           "-o", "KexAlgorithms=" + kex,
+           "-c", cipher]
+    if mac:
+        cmd += ["-m", mac]
+    cmd.append("%s@%s" % (args.user, args.host))
+    script = "3\rinfo\rdown %d\rq\rquit\r" % args.size
+    env = dict(os.environ)
+    env.setdefault("SSHPASS", args.password)
+    t0 = time.perf_counter()
+    proc = subprocess.run(cmd, input=script.encode(), capture_output=True,
+                          env=env, timeout=args.timeout)
+    wall_ms = (time.perf_counter() - t0) * 1000.0
+    res = parse_results(proc.stdout.decode(errors="replace"))
+    row = {"cipher": cipher, "mac": mac or "(aead)", "kex": kex,
+           "client_wall_ms": round(wall_ms, 1), "rc": proc.returncode}
+    info, down = res.get("info"), res.get("down")
+    if info:
+        row["handshake_us"] = int(info.get("handshake_us", 0))
+    if down:
+        row["down_MBps"] = float(down.get("MBps", 0))
+        row["down_cpu_us"] = int(down.get("cpu_us", 0))
+        row["negotiated_cipher"] = down.get("cipher_out")
+    if not info or not down:
+        row["error"] = proc.stderr.decode(errors="replace").strip().splitlines()[-1:] or "no RESULT"
+    return row
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("host")
+    ap.add_argument("--port", type=int, default=22)
+    ap.add_argument("--user", default="cago")
+    ap.add_argument("--password", default="cago1231")
+    ap.add_argument("--size", type=int, default=256 * 1024)
+    ap.add_argument("--timeout", type=float, default=120.0)
+    args = ap.parse_args()
+
+    rows = []
+    for (cipher, mac), kex in itertools.product(CIPHERS, KEXES):
+        row = run_candidate(args, cipher, mac, kex)
+        rows.append(row)
+        print(json.dumps(row, sort_keys=True), flush=True)
+
+    ok = [r for r in rows if "error" not in r]
+    print("\n%-32s %-20s %12s %10s" % ("cipher", "kex", "handshake_ms", "down_MB/s"), file=sys.stderr)
+    for r in sorted(ok, key=lambda r: -r["down_MBps"]):
+        print("%-32s %-20s %12.1f %10.3f" % (r["cipher"], r["kex"],
+              r["handshake_us"] / 1000.0, r["down_MBps"]), file=sys.stderr)
+    return 0 if ok else 1
+
+
+if __name__ == "__main__":
+    sys.exit(main())
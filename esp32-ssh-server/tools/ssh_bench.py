@@ -0,0 +1,171 @@
+#!/usr/bin/env python3
+"""Host-side driver for the on-device "bench" app (menu item 3).
+
+Connects with paramiko, runs info / down / up / ping and prints one JSON
+object per result on stdout, e.g.
+
+    python3 tools/ssh_bench.py 192.168.1.7 --size 1048576 --pings 50 --label revB
+
+Requires: pip install paramiko
+"""
+import argparse
+import json
+import sys
+import time
+
+import paramiko
+
+PROMPT = b"> "
+
+
+class BenchSession:
+    def __init__(self, host, port, user, password, timeout, compress=False):
+        self.client = paramiko.SSHClient()
+        self.client.set_missing_host_key_policy(paramiko.AutoAddPolicy())
+        t0 = time.perf_counter()
+        self.client.connect(host, port=port, username=user, password=password,
+                            look_for_keys=False, allow_agent=False, timeout=timeout,
+                            compress=compress)
+        self.connect_ms = (time.perf_counter() - t0) * 1000.0
+        self.chan = self.client.invoke_shell()
+        self.chan.settimeout(timeout)
+        self.buf = b""
+        self.read_until(PROMPT)
+
+    def close(self):
+        self.client.close()
+
+    def send_line(self, line):
+        self.chan.sendall(line.encode() + b"\r")
+
+    def read_until(self, marker):
+        while marker not in self.buf:
+            data = self.chan.recv(65536)
+            if not data:
+                raise EOFError("channel closed waiting for %r" % marker)
+            self.buf += data
+        head, _, self.buf = self.buf.partition(marker)
+        return head
+
+    def result(self, test):
+        """Wait for the RESULT line of `test` and the following prompt."""
+        self.read_until(b"RESULT test=" + test.encode() + b" ")
+        line = self.read_until(b"\r\n").decode(errors="replace")
+        self.read_until(PROMPT)
+        out = {"test": test}
+        for tok in line.split():
+            k, sep, v = tok.partition("=")
+            if sep:
+                out[k] = v
+        return out
+
+    def negotiated(self):
+        t = self.client.get_transport()
+        return {
+            "client_cipher": t.remote_cipher,
+            "client_mac": t.remote_mac,
+        }
+
+
+def keystroke_latency(s, count):
+    """Client-observed keystroke-to-echo time in the echo app (menu item 1)."""
+    s.send_line("1")
+    s.read_until(PROMPT)
+    samples = []
+    for i in range(count):
+        key = b"abcdefghijklmnopqrstuvwxyz"[i % 26:i % 26 + 1]
+        t0 = time.perf_counter()
+        s.chan.sendall(key)
+        s.read_until(key)
+        samples.append((time.perf_counter() - t0) * 1000.0)
+    s.send_line("")
+    s.read_until(PROMPT)
+    s.send_line("q")
+    s.read_until(PROMPT)
+    samples.sort()
+    pick = lambda p: round(samples[min(len(samples) - 1, int(p / 100.0 * len(samples)))], 2)
+    return {"test": "keystroke", "n": len(samples), "p50_ms": pick(50),
+            "p90_ms": pick(90), "p99_ms": pick(99), "max_ms": round(samples[-1], 2)}
+
+
+def run(args):
+    s = BenchSession(args.host, args.port, args.user, args.password, args.timeout,
+                     args.compress)
+    results = []
+    try:
+        s.send_line("3")
+        s.read_until(PROMPT)
+
+        s.send_line("info")
+        info = s.result("info")
+        info["client_connect_ms"] = round(s.connect_ms, 1)
+        info.update(s.negotiated())
+        results.append(info)
+
+        for _ in range(args.repeat):
+            s.send_line("down %d" % args.size)
+            results.append(s.result("down"))
+
+            s.send_line("up %d" % args.size)
+            s.read_until(b"READY\r\n")
+            payload = b"u" * 4096
+            left = args.size
+            while left > 0:
+                n = min(left, len(payload))
+                s.chan.sendall(payload[:n])
+                left -= n
+            results.append(s.result("up"))
+
+            s.send_line("ping %d" % args.pings)
+            s.read_until(b"READY\r\n")
+            answered = 0
+            while answered < args.pings:
+                data = s.buf or s.chan.recv(4096)
+                s.buf = b""
+                if not data:
+                    raise EOFError("channel closed during ping")
+                n = min(data.count(b"p"), args.pings - answered)
+                if n:
+                    s.chan.sendall(b"x" * n)
+                    answered += n
+            results.append(s.result("ping"))
+
+        s.send_line("lat")
+        s.read_until(b"RESULT test=lat ")
+        results.append(dict(test="server_echo_latency",
+                            summary=s.read_until(b"\r\n").decode(errors="replace")))
+        s.read_until(PROMPT)
+        s.send_line("q")
+        s.read_until(PROMPT)
+
+        if args.keys:
+            results.append(keystroke_latency(s, args.keys))
+    finally:
+        s.close()
+
+    for r in results:
+        r["label"] = args.label
+        r["host"] = args.host
+        print(json.dumps(r, sort_keys=True))
+    return 0
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("host")
+    ap.add_argument("--port", type=int, default=22)
+    ap.add_argument("--user", default="cago")
+    ap.add_argument("--password", default="cago1231")
+    ap.add_argument("--size", type=int, default=256 * 1024, help="bytes per transfer")
+    ap.add_argument("--pings", type=int, default=50)
+    ap.add_argument("--repeat", type=int, default=1)
+    ap.add_argument("--keys", type=int, default=50, help="keystroke echo samples (0 to skip)")
+    ap.add_argument("--label", default="", help="free-form tag, e.g. board revision")
+    ap.add_argument("--timeout", type=float, default=15.0)
+    ap.add_argument("--compress", action="store_true",
+                    help="offer zlib@openssh.com (device must be built with SSH_COMPRESSION=1 and have PSRAM)")
+    return run(ap.parse_args())
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,267 @@
+#!/usr/bin/env python3
+"""SSH benchmarks through a local impairment proxy (latency, jitter, loss, bandwidth).
+
+Starts a TCP proxy on localhost in front of the device and runs handshake,
+keystroke echo (menu 1) and bulk down/up (menu 3) through it under each
+network condition, then prints one results table, e.g.
+
+    python3 tools/ssh_impair.py 192.168.1.7
+    python3 tools/ssh_impair.py 192.168.1.7 --conditions clean,lossy --size 131072 --json
+    python3 tools/ssh_impair.py 192.168.1.7 --condition mine:30:10:2:1000
+
+A condition is name:latency_ms:jitter_ms:loss_pct:kbit (one-way latency,
+applied in each direction; kbit 0 = uncapped). The proxy carries a TCP
+stream, so it cannot drop bytes: a "lost" segment is held back for --rto ms
+instead, which is what the receiver sees while the sender retransmits.
+Segments are never reordered. Run the same matrix before and after a
+server change; the proxy's own overhead shows in the "clean" row.
+
+Requires: pip install paramiko
+"""
+import argparse
+import json
+import queue
+import random
+import socket
+import sys
+import threading
+import time
+
+from ssh_bench import PROMPT, BenchSession, keystroke_latency
+
+# name: (one-way latency ms, jitter ms, loss %, kbit/s or 0)
+PRESETS = {
+    "clean": (0, 0, 0.0, 0),
+    "wifi_ok": (5, 3, 0.5, 0),
+    "busy": (25, 15, 1.0, 4000),
+    "lossy": (20, 10, 5.0, 1000),
+    "far": (150, 30, 1.0, 512),
+}
+SEGMENT = 1460
+
+
+class Condition:
+    def __init__(self, name, latency_ms, jitter_ms, loss_pct, kbit):
+        self.name = name
+        self.latency = latency_ms / 1000.0
+        self.jitter = jitter_ms / 1000.0
+        self.loss = loss_pct / 100.0
+        self.bps = kbit * 1000.0 / 8.0  # bytes per second, 0 = uncapped
+        self.spec = "%g/%g/%g/%g" % (latency_ms, jitter_ms, loss_pct, kbit)
+
+    @staticmethod
+    def parse(text):
+        if text in PRESETS:
+            return Condition(text, *PRESETS[text])
+        parts = text.split(":")
+        if len(parts) != 5:
+            raise argparse.ArgumentTypeError("expected a preset or name:latency:jitter:loss:kbit, got %r" % text)
+        return Condition(parts[0], *(float(p) for p in parts[1:]))
+
+
+class Pipe:
+    """One direction of a proxied connection: delay line plus rate limiter."""
+
+    def __init__(self, src, dst, cond, rto, rng, counters):
+        self.src, self.dst, self.cond, self.rto, self.rng = src, dst, cond, rto, rng
+        self.counters = counters
+        self.queue = queue.Queue()
+        self.last_release = 0.0
+        self.wire_free = 0.0
+
+    def start(self):
+        threading.Thread(target=self.reader, daemon=True).start()
+        threading.Thread(target=self.writer, daemon=True).start()
+
+    def reader(self):
+        try:
+            while True:
+                data = self.src.recv(65536)
+                if not data:
+                    break
+                now = time.monotonic()
+                for off in range(0, len(data), SEGMENT):
+                    seg = data[off:off + SEGMENT]
+                    delay = self.cond.latency + self.rng.uniform(-self.cond.jitter, self.cond.jitter)
+                    if self.cond.loss and self.rng.random() < self.cond.loss:
+                        delay += self.rto
+                        self.counters["lost"] += 1
+                    # TCP delivers in order: a segment never overtakes the one before it.
+                    release = max(now + max(delay, 0.0), self.last_release)
+                    self.last_release = release
+                    self.queue.put((release, seg))
+                    self.counters["segments"] += 1
+        except OSError:
+            pass
+        self.queue.put((0.0, None))
+
+    def writer(self):
+        try:
+            while True:
+                release, seg = self.queue.get()
+                if seg is None:
+                    break
+                now = time.monotonic()
+                if self.cond.bps:
+                    start = max(release, self.wire_free)
+                    self.wire_free = start + len(seg) / self.cond.bps
+                    release = self.wire_free
+                if release > now:
+                    time.sleep(release - now)
+                self.dst.sendall(seg)
+        except OSError:
+            pass
+        try:
+            self.dst.shutdown(socket.SHUT_WR)
+        except OSError:
+            pass
+
+
+class ImpairProxy:
+    def __init__(self, target, cond, rto, seed):
+        self.target = target
+        self.cond = cond
+        self.rto = rto
+        self.rng = random.Random(seed)
+        self.counters = {"segments": 0, "lost": 0}
+        self.listener = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+        self.listener.setsockopt(socket.SOL_SOCKET, socket.SO_REUSEADDR, 1)
+        self.listener.bind(("127.0.0.1", 0))
+        self.listener.listen(8)
+        self.port = self.listener.getsockname()[1]
+        threading.Thread(target=self.accept_loop, daemon=True).start()
+
+    def accept_loop(self):
+        while True:
+            try:
+                client, _ = self.listener.accept()
+            except OSError:
+                return
+            try:
+                upstream = socket.create_connection(self.target, timeout=10)
+            except OSError:
+                client.close()
+                continue
+            upstream.settimeout(None)
+            for s in (client, upstream):
+                s.setsockopt(socket.IPPROTO_TCP, socket.TCP_NODELAY, 1)
+            Pipe(client, upstream, self.cond, self.rto, self.rng, self.counters).start()
+            Pipe(upstream, client, self.cond, self.rto, self.rng, self.counters).start()
+
+    def close(self):
+        self.listener.close()
+
+
+def percentile(sorted_vals, p):
+    if not sorted_vals:
+        return None
+    return round(sorted_vals[min(len(sorted_vals) - 1, int(p / 100.0 * len(sorted_vals)))], 1)
+
+
+def bulk(s, direction, size):
+    """Client-observed MB/s for one bench down/up transfer."""
+    t0 = time.perf_counter()
+    s.send_line("%s %d" % (direction, size))
+    if direction == "up":
+        s.read_until(b"READY\r\n")
+        payload = b"u" * 4096
+        left = size
+        while left > 0:
+            n = min(left, len(payload))
+            s.chan.sendall(payload[:n])
+            left -= n
+    s.result(direction)
+    return size / (time.perf_counter() - t0) / 1e6
+
+
+def run_condition(args, cond):
+    proxy = ImpairProxy((args.host, args.port), cond, args.rto / 1000.0, args.seed)
+    row = {"condition": cond.name, "spec": cond.spec, "errors": 0}
+    handshakes = []
+    try:
+        for _ in range(args.handshakes):
+            try:
+                s = BenchSession("127.0.0.1", proxy.port, args.user, args.password, args.timeout)
+                handshakes.append(s.connect_ms)
+                s.close()
+            except Exception as e:
+                row["errors"] += 1
+                print("%s: handshake: %s: %s" % (cond.name, type(e).__name__, e), file=sys.stderr)
+        handshakes.sort()
+        row["handshake_p50_ms"] = percentile(handshakes, 50)
+        row["handshake_max_ms"] = round(handshakes[-1], 1) if handshakes else None
+
+        s = BenchSession("127.0.0.1", proxy.port, args.user, args.password, args.timeout)
+        try:
+            if args.keys:
+                keys = keystroke_latency(s, args.keys)
+                row["echo_p50_ms"] = keys["p50_ms"]
+                row["echo_p99_ms"] = keys["p99_ms"]
+            if args.size:
+                s.send_line("3")
+                s.read_until(PROMPT)
+                row["down_MBps"] = round(bulk(s, "down", args.size), 3)
+                row["up_MBps"] = round(bulk(s, "up", args.size), 3)
+                s.send_line("q")
+                s.read_until(PROMPT)
+        finally:
+            s.close()
+    except Exception as e:
+        row["errors"] += 1
+        print("%s: %s: %s" % (cond.name, type(e).__name__, e), file=sys.stderr)
+    finally:
+        proxy.close()
+    row["segments"] = proxy.counters["segments"]
+    row["held_back"] = proxy.counters["lost"]
+    return row
+
+
+COLUMNS = ["condition", "spec", "handshake_p50_ms", "handshake_max_ms", "echo_p50_ms", "echo_p99_ms",
+           "down_MBps", "up_MBps", "held_back", "errors"]
+
+
+def print_table(rows):
+    cells = [[str(r.get(c, "-") if r.get(c) is not None else "-") for c in COLUMNS] for r in rows]
+    widths = [max(len(c), *(len(row[i]) for row in cells)) for i, c in enumerate(COLUMNS)]
+    print("  ".join(c.ljust(w) for c, w in zip(COLUMNS, widths)))
+    for row in cells:
+        print("  ".join(v.ljust(w) for v, w in zip(row, widths)))
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("host")
+    ap.add_argument("--port", type=int, default=22)
+    ap.add_argument("--user", default="cago")
+    ap.add_argument("--password", default="cago1231")
+    ap.add_argument("--conditions", default=",".join(PRESETS),
+                    help="comma-separated presets (%s)" % ", ".join(PRESETS))
+    ap.add_argument("--condition", action="append", type=Condition.parse, default=[],
+                    help="extra name:latency_ms:jitter_ms:loss_pct:kbit, repeatable")
+    ap.add_argument("--handshakes", type=int, default=3, help="connections timed per condition")
+    ap.add_argument("--keys", type=int, default=30, help="keystroke echo samples (0 to skip)")
+    ap.add_argument("--size", type=int, default=64 * 1024, help="bulk bytes each way (0 to skip)")
+    ap.add_argument("--rto", type=float, default=200.0, help="hold-back for a lost segment, ms")
+    ap.add_argument("--seed", type=int, default=1, help="loss/jitter RNG seed")
+    ap.add_argument("--timeout", type=float, default=60.0)
+    ap.add_argument("--json", action="store_true", help="one JSON object per condition instead of a table")
+    args = ap.parse_args()
+
+    try:
+        conds = [Condition.parse(n) for n in args.conditions.split(",") if n] + args.condition
+    except (argparse.ArgumentTypeError, ValueError) as e:
+        ap.error(str(e))
+    rows = []
+    for cond in conds:
+        print("running %s (%s)..." % (cond.name, cond.spec), file=sys.stderr)
+        rows.append(run_condition(args, cond))
+        if args.json:
+            print(json.dumps(rows[-1], sort_keys=True))
+            sys.stdout.flush()
+    if not args.json:
+        print_table(rows)
+    return 1 if any(r["errors"] for r in rows) else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,228 @@
+#!/usr/bin/env python3
+"""Concurrent connection churn / soak test for the SSH server.
+
+N worker threads loop over a weighted mix of client scenarios for a fixed
+duration, while a sampler polls the diag port (8080) for heap and server
+counters. Prints a JSON summary (connections/s, handshake percentiles,
+error breakdown, heap series) and exits non-zero if idle free heap after the
+run is lower than before by more than --leak-tolerance bytes.
+
+    python3 tools/ssh_load.py 192.168.1.7 --clients 4 --duration 600
+
+Scenarios exercise every early-return path in SshServer::handleClient:
+  full            auth, shell, echo app round trip, quit
+  bad_auth        wrong password
+  drop_after_auth authenticate, then close without opening a channel
+  drop_after_open open a session channel, close before requesting a shell
+  silent          TCP connect and say nothing (handshake timeout path)
+
+Requires: pip install paramiko
+"""
+import argparse
+import collections
+import json
+import random
+import socket
+import sys
+import threading
+import time
+
+import paramiko
+
+SCENARIOS = {
+    "full": 6,
+    "bad_auth": 2,
+    "drop_after_auth": 1,
+    "drop_after_open": 1,
+    "silent": 0,
+}
+
+
+class Stats:
+    def __init__(self):
+        self.lock = threading.Lock()
+        self.handshake_ms = []
+        self.ok = collections.Counter()
+        self.errors = collections.Counter()
+
+    def record(self, scenario, handshake_ms, error):
+        with self.lock:
+            if handshake_ms is not None:
+                self.handshake_ms.append(handshake_ms)
+            if error:
+                self.errors["%s:%s" % (scenario, error)] += 1
+            else:
+                self.ok[scenario] += 1
+
+
+def read_until(chan, marker, timeout):
+    buf = b""
+    deadline = time.monotonic() + timeout
+    while marker not in buf:
+        if time.monotonic() > deadline:
+            raise socket.timeout("waiting for %r" % marker)
+        data = chan.recv(4096)
+        if not data:
+            raise EOFError("closed waiting for %r" % marker)
+        buf += data
+    return buf
+
+
+def run_scenario(args, scenario):
+    """Returns (handshake_ms or None, error string or None)."""
+    if scenario == "silent":
+        s = socket.create_connection((args.host, args.port), timeout=args.timeout)
+        time.sleep(args.silent_hold)
+        s.close()
+        return None, None
+
+    t0 = time.perf_counter()
+    sock = socket.create_connection((args.host, args.port), timeout=args.timeout)
+    t = paramiko.Transport(sock)
+    try:
+        t.banner_timeout = args.timeout
+        t.start_client(timeout=args.timeout)
+        password = args.password if scenario != "bad_auth" else args.password + "x"
+        try:
+            t.auth_password(args.user, password)
+        except paramiko.AuthenticationException:
+            return None, None if scenario == "bad_auth" else "auth_rejected"
+        if scenario == "bad_auth":
+            return None, "bad_password_accepted"
+        handshake_ms = (time.perf_counter() - t0) * 1000.0
+        if scenario == "drop_after_auth":
+            return handshake_ms, None
+
+        chan = t.open_session(timeout=args.timeout)
+        if scenario == "drop_after_open":
+            chan.close()
+            return handshake_ms, None
+
+        chan.settimeout(args.timeout)
+        chan.get_pty()
+        chan.invoke_shell()
+        read_until(chan, b"> ", args.timeout)
+        chan.sendall(b"1\r")
+        read_until(chan, b"> ", args.timeout)
+        token = ("load%06d" % random.randrange(10 ** 6)).encode()
+        chan.sendall(token + b"\r")
+        read_until(chan, token + b"\r\n", args.timeout)
+        chan.sendall(b"q\r")
+        read_until(chan, b"> ", args.timeout)
+        chan.sendall(b"quit\r")
+        read_until(chan, b"Goodbye.", args.timeout)
+        chan.close()
+        return handshake_ms, None
+    finally:
+        t.close()
+
+
+def worker(args, stats, stop):
+    names = list(SCENARIOS)
+    weights = [SCENARIOS[n] for n in names]
+    while not stop.is_set():
+        scenario = random.choices(names, weights)[0]
+        try:
+            hs, err = run_scenario(args, scenario)
+        except (socket.timeout, TimeoutError):
+            hs, err = None, "timeout"
+        except (EOFError, ConnectionError, paramiko.SSHException, OSError) as e:
+            hs, err = None, type(e).__name__
+        stats.record(scenario, hs, err)
+
+
+def diag_sample(host):
+    """Parse key=value pairs from one diag port reply."""
+    with socket.create_connection((host, 8080), timeout=5) as s:
+        data = b""
+        while True:
+            chunk = s.recv(1024)
+            if not chunk:
+                break
+            data += chunk
+    out = {}
+    for tok in data.decode(errors="replace").split():
+        k, sep, v = tok.partition("=")
+        if sep and v.replace(".", "", 1).isdigit():
+            out[k] = float(v) if "." in v else int(v)
+    return out
+
+
+def sampler(args, series, stop, t0):
+    while not stop.wait(args.sample):
+        try:
+            d = diag_sample(args.host)
+            d["t"] = round(time.monotonic() - t0, 1)
+            series.append(d)
+        except OSError:
+            series.append({"t": round(time.monotonic() - t0, 1), "error": "diag_unreachable"})
+
+
+def percentile(sorted_vals, p):
+    if not sorted_vals:
+        return None
+    k = min(len(sorted_vals) - 1, int(round(p / 100.0 * (len(sorted_vals) - 1))))
+    return round(sorted_vals[k], 1)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("host")
+    ap.add_argument("--port", type=int, default=22)
+    ap.add_argument("--user", default="cago")
+    ap.add_argument("--password", default="cago1231")
+    ap.add_argument("--clients", type=int, default=4)
+    ap.add_argument("--duration", type=float, default=60.0, help="seconds")
+    ap.add_argument("--timeout", type=float, default=30.0)
+    ap.add_argument("--sample", type=float, default=5.0, help="diag sampling period, s")
+    ap.add_argument("--silent", type=int, default=0, help="weight of the 'silent' scenario")
+    ap.add_argument("--silent-hold", type=float, default=20.0)
+    ap.add_argument("--settle", type=float, default=3.0, help="idle wait before the final heap sample")
+    ap.add_argument("--leak-tolerance", type=int, default=2048, help="bytes")
+    args = ap.parse_args()
+    SCENARIOS["silent"] = args.silent
+
+    baseline = diag_sample(args.host)
+    stats = Stats()
+    series = []
+    stop = threading.Event()
+    t0 = time.monotonic()
+    threads = [threading.Thread(target=worker, args=(args, stats, stop), daemon=True)
+               for _ in range(args.clients)]
+    threads.append(threading.Thread(target=sampler, args=(args, series, stop, t0), daemon=True))
+    for th in threads:
+        th.start()
+    time.sleep(args.duration)
+    stop.set()
+    for th in threads:
+        th.join(args.timeout + args.silent_hold)
+    elapsed = time.monotonic() - t0
+    time.sleep(args.settle)
+    final = diag_sample(args.host)
+
+    hs = sorted(stats.handshake_ms)
+    attempts = sum(stats.ok.values()) + sum(stats.errors.values())
+    heap_delta = final.get("free_heap", 0) - baseline.get("free_heap", 0)
+    summary = {
+        "clients": args.clients,
+        "elapsed_s": round(elapsed, 1),
+        "attempts": attempts,
+        "connections_per_s": round(attempts / elapsed, 2) if elapsed else 0,
+        "ok": dict(stats.ok),
+        "errors": dict(stats.errors),
+        "handshake_ms": {"n": len(hs), "p50": percentile(hs, 50), "p90": percentile(hs, 90),
+                         "p99": percentile(hs, 99), "max": round(hs[-1], 1) if hs else None},
+        "server_before": baseline,
+        "server_after": final,
+        "free_heap_delta": heap_delta,
+        "heap_series": series,
+    }
+    print(json.dumps(summary, indent=2, sort_keys=True))
+    if heap_delta < -args.leak_tolerance:
+        print("LEAK? idle free heap dropped by %d bytes" % -heap_delta, file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,107 @@
+#!/usr/bin/env python3
+"""Several session channels over one SSH connection (one handshake).
+
+Opens --channels shell channels on a single transport, runs the echo app
+(menu item 1) on all of them at once and prints one JSON object with the
+handshake time and per-channel round-trip percentiles, e.g.
+
+    python3 tools/ssh_mux.py 192.168.1.7 --channels 3 --lines 50
+
+The device serves up to SSH_MAX_CHANNELS channels per connection.
+
+Requires: pip install paramiko
+"""
+import argparse
+import json
+import socket
+import sys
+import threading
+import time
+
+import paramiko
+
+PROMPT = b"> "
+
+
+def read_until(chan, buf, marker):
+    while marker not in buf:
+        data = chan.recv(4096)
+        if not data:
+            raise EOFError("channel closed waiting for %r" % marker)
+        buf += data
+    head, _, rest = buf.partition(marker)
+    return head, rest
+
+
+def echo_channel(transport, idx, args, out):
+    t0 = time.perf_counter()
+    chan = transport.open_session(timeout=args.timeout)
+    chan.settimeout(args.timeout)
+    chan.get_pty()
+    chan.invoke_shell()
+    buf = b""
+    _, buf = read_until(chan, buf, PROMPT)
+    open_ms = (time.perf_counter() - t0) * 1000.0
+    chan.sendall(b"1\r")
+    _, buf = read_until(chan, buf, PROMPT)
+    samples = []
+    for i in range(args.lines):
+        token = ("ch%d-%04d" % (idx, i)).encode()
+        t = time.perf_counter()
+        chan.sendall(token + b"\r")
+        _, buf = read_until(chan, buf, token + b"\r\n" + token + b"\r\n")
+        samples.append((time.perf_counter() - t) * 1000.0)
+    chan.sendall(b"q\r")
+    _, buf = read_until(chan, buf, PROMPT)
+    chan.sendall(b"quit\r")
+    read_until(chan, buf, b"Goodbye.")
+    chan.close()
+    samples.sort()
+    pick = lambda p: round(samples[min(len(samples) - 1, int(p / 100.0 * len(samples)))], 2)
+    out[idx] = {"channel": idx, "open_ms": round(open_ms, 1), "n": len(samples),
+                "p50_ms": pick(50), "p90_ms": pick(90), "max_ms": round(samples[-1], 2)}
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("host")
+    ap.add_argument("--port", type=int, default=22)
+    ap.add_argument("--user", default="cago")
+    ap.add_argument("--password", default="cago1231")
+    ap.add_argument("--channels", type=int, default=3)
+    ap.add_argument("--lines", type=int, default=50, help="echo round trips per channel")
+    ap.add_argument("--timeout", type=float, default=15.0)
+    args = ap.parse_args()
+
+    t0 = time.perf_counter()
+    sock = socket.create_connection((args.host, args.port), timeout=args.timeout)
+    transport = paramiko.Transport(sock)
+    transport.start_client(timeout=args.timeout)
+    transport.auth_password(args.user, args.password)
+    handshake_ms = (time.perf_counter() - t0) * 1000.0
+
+    results = [None] * args.channels
+    errors = []
+
+    def run(i):
+        try:
+            echo_channel(transport, i, args, results)
+        except Exception as e:  # report, keep the other channels going
+            errors.append("ch%d: %s: %s" % (i, type(e).__name__, e))
+
+    t1 = time.perf_counter()
+    threads = [threading.Thread(target=run, args=(i,)) for i in range(args.channels)]
+    for th in threads:
+        th.start()
+    for th in threads:
+        th.join()
+    wall_ms = (time.perf_counter() - t1) * 1000.0
+    transport.close()
+
+    print(json.dumps({"handshake_ms": round(handshake_ms, 1), "channels_wall_ms": round(wall_ms, 1),
+                      "channels": [r for r in results if r], "errors": errors}, indent=2))
+    return 1 if errors else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
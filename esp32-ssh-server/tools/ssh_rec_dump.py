@@ -0,0 +1,63 @@
+#!/usr/bin/env python3
+"""Save the device's session recording (menu item 9) as an asciinema cast.
+
+    python3 tools/ssh_rec_dump.py 192.168.1.7 -o session.cast
+    asciinema play session.cast
+
+The ring only holds what was recorded while it was on ("on" in the rec app,
+or a build with -DSSH_RECORD_AT_BOOT=1). Includes this session's own menu
+navigation up to the dump command.
+
+Requires: pip install paramiko
+"""
+import argparse
+import json
+import sys
+
+from ssh_bench import PROMPT, BenchSession
+
+BEGIN = b"--- BEGIN CAST ---\r\n"
+END = b"--- END CAST ---\r\n"
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("host")
+    ap.add_argument("--port", type=int, default=22)
+    ap.add_argument("--user", default="cago")
+    ap.add_argument("--password", default="cago1231")
+    ap.add_argument("--timeout", type=float, default=15.0)
+    ap.add_argument("-o", "--output", default="-", help="cast file (default stdout)")
+    ap.add_argument("--status", action="store_true", help="print the recorder RESULT line to stderr")
+    args = ap.parse_args()
+
+    s = BenchSession(args.host, args.port, args.user, args.password, args.timeout)
+    try:
+        s.send_line("9")
+        s.read_until(PROMPT)
+        s.send_line("dump")
+        s.read_until(BEGIN)
+        body = s.read_until(END)
+        s.read_until(PROMPT)
+        if args.status:
+            s.send_line("status")
+            print(json.dumps(s.result("recorder"), sort_keys=True), file=sys.stderr)
+        s.send_line("q")
+        s.read_until(PROMPT)
+    finally:
+        s.close()
+
+    lines = body.decode(errors="replace").split("\r\n")
+    cast = "\n".join(l for l in lines if l) + "\n"
+    events = max(0, cast.count("\n") - 1)
+    if args.output == "-":
+        sys.stdout.write(cast)
+    else:
+        with open(args.output, "w") as f:
+            f.write(cast)
+        print("%d events -> %s" % (events, args.output), file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
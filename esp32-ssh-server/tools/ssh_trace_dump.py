@@ -0,0 +1,66 @@
+#!/usr/bin/env python3
+"""Save the device's timeline trace (menu item 9, "trace dump") as Chrome trace JSON.
+
+    python3 tools/ssh_trace_dump.py 192.168.1.7 -o trace.json
+
+Open trace.json in https://ui.perfetto.dev or chrome://tracing. Each FreeRTOS
+task is a track; ssh_accept/kex/auth/channel/serve spans, ch_wait/ch_write,
+Wi-Fi/IP events and STATE_* transitions are recorded. --clear empties the
+ring first and waits --settle seconds, to capture just what follows.
+
+Requires: pip install paramiko
+"""
+import argparse
+import json
+import sys
+import time
+
+from ssh_bench import PROMPT, BenchSession
+
+BEGIN = b"--- BEGIN TRACE ---\r\n"
+END = b"--- END TRACE ---\r\n"
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("host")
+    ap.add_argument("--port", type=int, default=22)
+    ap.add_argument("--user", default="cago")
+    ap.add_argument("--password", default="cago1231")
+    ap.add_argument("--timeout", type=float, default=15.0)
+    ap.add_argument("-o", "--output", default="-", help="trace file (default stdout)")
+    ap.add_argument("--clear", action="store_true", help="clear the ring, then wait --settle seconds")
+    ap.add_argument("--settle", type=float, default=10.0)
+    args = ap.parse_args()
+
+    s = BenchSession(args.host, args.port, args.user, args.password, args.timeout)
+    try:
+        s.send_line("9")
+        s.read_until(PROMPT)
+        if args.clear:
+            s.send_line("trace clear")
+            s.read_until(PROMPT)
+            time.sleep(args.settle)
+        s.send_line("trace dump")
+        s.read_until(BEGIN)
+        body = s.read_until(END)
+        s.read_until(PROMPT)
+        s.send_line("q")
+        s.read_until(PROMPT)
+    finally:
+        s.close()
+
+    trace = json.loads(body.decode(errors="replace"))
+    events = sum(1 for e in trace["traceEvents"] if e["ph"] != "M")
+    text = json.dumps(trace) + "\n"
+    if args.output == "-":
+        sys.stdout.write(text)
+    else:
+        with open(args.output, "w") as f:
+            f.write(text)
+        print("%d events -> %s" % (events, args.output), file=sys.stderr)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())